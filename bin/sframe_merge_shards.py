@@ -0,0 +1,168 @@
+#!/usr/bin/env python
+# $Id$
+#***************************************************************************
+#* @Project: SFrame - ROOT-based analysis framework for ATLAS
+#* @Package: Core
+#*
+#* @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+#* @author David Berge      <David.Berge@cern.ch>          - CERN
+#* @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+#* @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - CERN/Debrecen
+#*
+#***************************************************************************
+#
+# This script can be used to merge the outputs of the jobs that processed
+# separate shards of the same input data. (Using the Shard="k/N" attribute
+# of InputData, or the --shard command line option of sframe_main.) The
+# shard output files are called like:
+#
+#   <cycle>.<type>.<version><postfix>.shard<k>of<N>.root
+#
+# All the shards of an output are merged into the file that a job processing
+# all of the input would've produced. The index files of the unmerged ntuples
+# of the shards are concatenated as well.
+#
+
+# Import the needed modules:
+import sys
+import os
+import re
+import optparse
+
+# The pattern of the shard output file names:
+SHARD_PATTERN = re.compile( r"^(.*)\.shard(\d+)of(\d+)\.root$" )
+
+# Extension of the ntuple index files (SFrame::NTupleIndexExtension):
+NTUPLE_INDEX_EXTENSION = ".ntuples"
+
+##
+# Collect the shard output files into groups belonging to the same output
+#
+# @param fileNames The file names given on the command line
+# @returns A dictionary of the output names, each holding the number of
+#          shards, and a dictionary of the shard indices and file names
+def collectShards( fileNames ):
+
+    result = {}
+    for fileName in fileNames:
+        match = SHARD_PATTERN.match( fileName )
+        if not match:
+            print( "WARNING: Not a shard output file: %s" % fileName )
+            continue
+        output = match.group( 1 ) + ".root"
+        index = int( match.group( 2 ) )
+        count = int( match.group( 3 ) )
+        if not output in result:
+            result[ output ] = ( count, {} )
+        if result[ output ][ 0 ] != count:
+            print( "ERROR: Inconsistent shard counts for output: %s" % output )
+            return None
+        result[ output ][ 1 ][ index ] = fileName
+        pass
+
+    return result
+
+##
+# Concatenate the ntuple index files of the shards
+#
+# The entries of the index files are understood relative to the directory
+# of the index files, so the merged index has to be written into the same
+# directory as the shard index files.
+#
+# @param output The name of the merged output file
+# @param shardFiles The names of the shard output files
+def mergeNTupleIndices( output, shardFiles ):
+
+    indexName = output[ :-5 ] + NTUPLE_INDEX_EXTENSION
+    lines = []
+    for shardFile in shardFiles:
+        shardIndex = shardFile[ :-5 ] + NTUPLE_INDEX_EXTENSION
+        if not os.path.exists( shardIndex ):
+            continue
+        ifile = open( shardIndex, "r" )
+        lines += [ line for line in ifile.readlines() if line.strip() ]
+        ifile.close()
+        pass
+
+    if not len( lines ):
+        return
+    ofile = open( indexName, "w" )
+    ofile.writelines( lines )
+    ofile.close()
+    print( "Ntuple index of %i file(s) written to: %s" %
+           ( len( lines ), indexName ) )
+
+    return
+
+##
+# The C(++) style main function
+#
+# @returns <code>0</code> if everything went fine, something else otherwise
+def main():
+
+    descr = "This script merges the outputs of the jobs processing separate " \
+            "shards of the same input data"
+    vers  = "$Revision$"
+    parser = optparse.OptionParser( description = descr, version = vers,
+                                    usage = "%prog [options] <shard files>" )
+    parser.add_option( "-f", "--force", dest="force",
+                       action="store_true", default=False,
+                       help="Merge the outputs even if some shards are missing" )
+
+    ( options, fileNames ) = parser.parse_args()
+    if not len( fileNames ):
+        parser.print_help()
+        return 255
+
+    # Collect the shard files:
+    outputs = collectShards( fileNames )
+    if outputs is None:
+        return 255
+
+    # We only need ROOT for the merging itself:
+    import ROOT
+    ROOT.gROOT.SetBatch()
+    ROOT.gErrorIgnoreLevel = ROOT.kError
+
+    # Merge the outputs one by one:
+    result = 0
+    for output in sorted( outputs.keys() ):
+        ( count, shards ) = outputs[ output ]
+        missing = [ i for i in range( count ) if not i in shards ]
+        if len( missing ):
+            print( "%s: Missing shard(s) %s of %i for output: %s" %
+                   ( "WARNING" if options.force else "ERROR",
+                     ", ".join( [ str( i ) for i in missing ] ), count,
+                     output ) )
+            if not options.force:
+                result = 255
+                continue
+            pass
+
+        shardFiles = [ shards[ i ] for i in sorted( shards.keys() ) ]
+        print( "Merging %i shard(s) into: %s" % ( len( shardFiles ), output ) )
+        merger = ROOT.TFileMerger( False )
+        if not merger.OutputFile( output, "RECREATE" ):
+            print( "ERROR: Couldn't create output file: %s" % output )
+            result = 255
+            continue
+        for shardFile in shardFiles:
+            if not merger.AddFile( shardFile ):
+                print( "ERROR: Couldn't open shard file: %s" % shardFile )
+                result = 255
+                pass
+            pass
+        if not merger.Merge():
+            print( "ERROR: Failed to merge the shards of: %s" % output )
+            result = 255
+            continue
+
+        mergeNTupleIndices( output, shardFiles )
+        pass
+
+    # Return with the collected status:
+    return result
+
+# Execute the main function:
+if __name__ == "__main__":
+    sys.exit( main() )
@@ -0,0 +1,139 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ * Small benchmark comparing the cost of filling histograms booked inside
+ * the event loop with SCycleBaseHist::Book, with the BOOK_CACHED macro, and
+ * through pointers cached by hand.
+ *
+ ***************************************************************************/
+
+// System include(s):
+#include <cstdlib>
+
+// ROOT include(s):
+#include <TH1.h>
+#include <TSelectorList.h>
+#include <TStopwatch.h>
+
+// Local include(s):
+#include "../include/SCycleBase.h"
+#include "../include/SLogger.h"
+
+// Global logging object
+static SLogger m_logger( "sframe_bench_booking" );
+
+/**
+ * Minimal cycle, used only to have access to the histogramming functions.
+ * The "events" are generated by the Run...(...) functions themselves.
+ */
+class BookingBench : public SCycleBase {
+
+public:
+   /// Fill the histograms booked with Book(...) in every event
+   void RunBook( Int_t nEvents ) {
+      for( Int_t i = 0; i < nEvents; ++i ) {
+         const Double_t x = i % 100;
+         Book( TH1F( "h1", "Histogram 1", 100, 0.0, 100.0 ), "bench" )
+            ->Fill( x );
+         Book( TH1F( "h2", "Histogram 2", 100, 0.0, 100.0 ), "bench" )
+            ->Fill( x );
+         Book( TH1F( "h3", "Histogram 3", 100, 0.0, 100.0 ), "bench" )
+            ->Fill( x );
+      }
+   }
+   /// Fill the histograms booked with BOOK_CACHED(...) in every event
+   void RunCached( Int_t nEvents ) {
+      for( Int_t i = 0; i < nEvents; ++i ) {
+         const Double_t x = i % 100;
+         BOOK_CACHED( TH1F( "h1", "Histogram 1", 100, 0.0, 100.0 ), "bench" )
+            ->Fill( x );
+         BOOK_CACHED( TH1F( "h2", "Histogram 2", 100, 0.0, 100.0 ), "bench" )
+            ->Fill( x );
+         BOOK_CACHED( TH1F( "h3", "Histogram 3", 100, 0.0, 100.0 ), "bench" )
+            ->Fill( x );
+      }
+   }
+   /// Fill the histograms through pointers cached by hand
+   void RunPointer( Int_t nEvents ) {
+      TH1* h1 = Book( TH1F( "h1", "Histogram 1", 100, 0.0, 100.0 ), "bench" );
+      TH1* h2 = Book( TH1F( "h2", "Histogram 2", 100, 0.0, 100.0 ), "bench" );
+      TH1* h3 = Book( TH1F( "h3", "Histogram 3", 100, 0.0, 100.0 ), "bench" );
+      for( Int_t i = 0; i < nEvents; ++i ) {
+         const Double_t x = i % 100;
+         h1->Fill( x );
+         h2->Fill( x );
+         h3->Fill( x );
+      }
+   }
+
+   // The functions that have to be implemented for a cycle:
+   virtual void BeginCycle() {}
+   virtual void EndCycle() {}
+   virtual void BeginInputData( const SInputData& ) {}
+   virtual void EndInputData( const SInputData& ) {}
+   virtual void BeginInputFile( const SInputData& ) {}
+   virtual void ExecuteEvent( const SInputData&, Double_t ) {}
+
+}; // class BookingBench
+
+namespace {
+
+   /// Print the result of one measurement
+   void Report( const char* name, TStopwatch& timer, Int_t nEvents ) {
+
+      m_logger << ALWAYS << name << ": "
+               << ( timer.CpuTime() * 1e9 / nEvents / 3 ) << " ns/fill"
+               << SLogger::endmsg;
+      return;
+   }
+
+} // private namespace
+
+int main( int argc, char** argv ) {
+
+   // The number of events to simulate:
+   const Int_t nEvents = ( argc > 1 ? std::atoi( argv[ 1 ] ) : 1000000 );
+   if( nEvents < 1 ) {
+      m_logger << ALWAYS << "Usage: " << argv[ 0 ] << " [events]"
+               << SLogger::endmsg;
+      return 1;
+   }
+   m_logger << ALWAYS << "Filling 3 histograms in " << nEvents << " events"
+            << SLogger::endmsg;
+
+   TStopwatch timer;
+   BookingBench bench;
+
+   // Each measurement uses a fresh output list, so the objects are booked
+   // once in each of them:
+   TSelectorList output1;
+   bench.SetHistOutput( &output1 );
+   timer.Start();
+   bench.RunBook( nEvents );
+   timer.Stop();
+   Report( "Book(...)", timer, nEvents );
+
+   TSelectorList output2;
+   bench.SetHistOutput( &output2 );
+   timer.Start();
+   bench.RunCached( nEvents );
+   timer.Stop();
+   Report( "BOOK_CACHED(...)", timer, nEvents );
+
+   TSelectorList output3;
+   bench.SetHistOutput( &output3 );
+   timer.Start();
+   bench.RunPointer( nEvents );
+   timer.Stop();
+   Report( "Cached pointer", timer, nEvents );
+
+   // Return gracefully:
+   return 0;
+}
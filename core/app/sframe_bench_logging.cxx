@@ -0,0 +1,102 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ * Small benchmark measuring the cost of a log statement that doesn't print
+ * anything, with and without the SLOG macro. Compile it with
+ * "make bench SFRAME_LOG_FLOOR=3" (for instance) to see the cost of a
+ * statement removed at compile time.
+ *
+ ***************************************************************************/
+
+// System include(s):
+#include <cstdlib>
+
+// ROOT include(s):
+#include <TStopwatch.h>
+
+// Local include(s):
+#include "../include/SLogger.h"
+#include "../include/SLogWriter.h"
+
+// Global logging object
+static SLogger m_logger( "sframe_bench_logging" );
+
+namespace {
+
+   /// Number of times that the "expensive" function was called
+   int s_calls = 0;
+
+   /// Function standing in for an expensive calculation in a message
+   int Expensive() {
+
+      ++s_calls;
+      return s_calls;
+   }
+
+   /// Print the result of one measurement
+   void Report( const char* name, TStopwatch& timer, int nCalls ) {
+
+      m_logger << ALWAYS << name << ": " << ( timer.RealTime() * 1e9 / nCalls )
+               << " ns/statement, message built " << s_calls << " times"
+               << SLogger::endmsg;
+      s_calls = 0;
+
+      return;
+   }
+
+} // private namespace
+
+int main( int argc, char** argv ) {
+
+   // The number of log statements to time:
+   const int nCalls = ( argc > 1 ? std::atoi( argv[ 1 ] ) : 10000000 );
+   if( nCalls < 1 ) {
+      m_logger << ALWAYS << "Usage: " << argv[ 0 ] << " [statements]"
+               << SLogger::endmsg;
+      return 1;
+   }
+
+   // Only print messages of INFO level and above, so the DEBUG messages of
+   // the benchmark are all discarded:
+   SLogWriter::Instance()->SetMinType( INFO );
+   m_logger << ALWAYS << "Timing " << nCalls << " DEBUG statements, with "
+            << "SLOGGER_MIN_TYPE = " << SLOGGER_MIN_TYPE << SLogger::endmsg;
+
+   TStopwatch timer;
+
+   // The old way of writing a message:
+   timer.Start();
+   for( int i = 0; i < nCalls; ++i ) {
+      m_logger << DEBUG << "Value: " << Expensive() << " in iteration " << i
+               << SLogger::endmsg;
+   }
+   timer.Stop();
+   Report( "Plain SLogger", timer, nCalls );
+
+   // The same message through the SLOG macro:
+   timer.Start();
+   for( int i = 0; i < nCalls; ++i ) {
+      SLOG( ::DEBUG ) << "Value: " << Expensive() << " in iteration " << i
+                      << SLogger::endmsg;
+   }
+   timer.Stop();
+   Report( "SLOG macro", timer, nCalls );
+
+   // The same through the REPORT_VERBOSE macro:
+   timer.Start();
+   for( int i = 0; i < nCalls; ++i ) {
+      REPORT_VERBOSE( "Value: " << Expensive() << " in iteration " << i );
+   }
+   timer.Stop();
+   Report( "REPORT_VERBOSE macro", timer, nCalls );
+
+   // Return gracefully:
+   return 0;
+}
@@ -15,8 +15,12 @@
  *
  ***************************************************************************/
 
+// System include(s):
+#include <cstdio>
+
 // STL include(s):
 #include <string>
+#include <vector>
 #include <iostream>
 
 // ROOT include(s):
@@ -36,15 +40,41 @@ void usage( char** argv );
 
 int main( int argc, char** argv ) {
 
-   // Check if the application received the expected single configuration file
+   // Check if the application received at least one configuration file
    // name:
-   if( ( argc != 2 ) || ( argc == 2 && std::string( argv[ 1 ] ) == "-h" ) ) {
+   if( ( argc < 2 ) || ( std::string( argv[ 1 ] ) == "-h" ) ) {
       usage( argv );
       return 1;
    }
 
-   // A convenience variable:
-   const std::string filename = argv[ 1 ];
+   // The configuration files of the jobs to run, whether their cached
+   // configuration should be ignored, and which shard of the input data
+   // should be processed:
+   std::vector< std::string > filenames;
+   bool reparse = false;
+   int shardIndex = 0, shardCount = 1;
+   for( int i = 1; i < argc; ++i ) {
+      const std::string arg( argv[ i ] );
+      if( ( arg == "-r" ) || ( arg == "--reparse" ) ) {
+         reparse = true;
+      } else if( ( arg == "-s" ) || ( arg == "--shard" ) ) {
+         if( ( ++i >= argc ) ||
+             ( sscanf( argv[ i ], "%d/%d", &shardIndex, &shardCount ) != 2 ) ||
+             ( shardCount < 1 ) || ( shardIndex < 0 ) ||
+             ( shardIndex >= shardCount ) ) {
+            REPORT_FATAL( "The shard has to be specified as \"index/count\", "
+                          "with 0 <= index < count" );
+            usage( argv );
+            return 1;
+         }
+      } else {
+         filenames.push_back( arg );
+      }
+   }
+   if( filenames.empty() ) {
+      usage( argv );
+      return 1;
+   }
 
    // Set ROOT into batch mode. This is how PROOF knows not to create
    // graphical windows showing the progress of the event processing.
@@ -57,9 +87,17 @@ int main( int argc, char** argv ) {
 
    try { // This is where I catch anything not handled internally...
 
-      SCycleController my_analysis( filename );
-      my_analysis.Initialize();
-      my_analysis.ExecuteAllCycles();
+      // Run the jobs one after the other. The PROOF connection(s) are kept
+      // open after the successful jobs, so the later jobs don't have to wait
+      // for PROOF to start up again.
+      for( size_t i = 0; i < filenames.size(); ++i ) {
+         SCycleController my_analysis( filenames[ i ] );
+         my_analysis.SetForceReparse( reparse );
+         my_analysis.SetShard( shardIndex, shardCount );
+         my_analysis.Initialize();
+         my_analysis.ExecuteAllCycles();
+         my_analysis.SetKeepProof( i + 1 < filenames.size() );
+      }
 
    } catch( const SError& error ) {
       REPORT_FATAL( "SError exception caught" );
@@ -92,8 +130,19 @@ void usage( char** argv ) {
    m_logger << INFO << SLogger::endmsg;
    m_logger << INFO << "Main executable to run an SFrame-based cycle analysis."
             << SLogger::endmsg;
-   m_logger << INFO << "\n\tUsage: " << argv[ 0 ] << " \'xml filename\'"
-            << std::endl << SLogger::endmsg;
+   m_logger << INFO << "\n\tUsage: " << argv[ 0 ] << " [-r] [-s k/N] "
+            << "\'xml filename\' [\'xml filename\' ...]" << std::endl
+            << SLogger::endmsg;
+   m_logger << INFO << "Multiple configurations are executed one after the "
+            << "other, using the same PROOF session(s)." << SLogger::endmsg;
+   m_logger << INFO << "The parsed configurations are cached. Use -r (or "
+            << "--reparse) to read the XML file(s) again regardless."
+            << SLogger::endmsg;
+   m_logger << INFO << "Use -s k/N (or --shard k/N) to process only the k-th "
+            << "(0 <= k < N) of N equal shards of all the input data."
+            << SLogger::endmsg;
+   m_logger << INFO << "The outputs of the shards can be merged with "
+            << "sframe_merge_shards.py." << SLogger::endmsg;
 
    return;
 }
@@ -14,9 +14,13 @@
 #ifndef SFRAME_CORE_ISCycleBaseHist_H
 #define SFRAME_CORE_ISCycleBaseHist_H
 
+// ROOT include(s):
+#include <Rtypes.h>
+
 // Forward declaration(s):
 class TSelectorList;
 class TDirectory;
+class SMemoryAccounting;
 
 /**
  *   @short Interface providing histogramming capabilities
@@ -39,6 +43,8 @@ public:
    virtual void SetHistOutput( TSelectorList* output ) = 0;
    /// Get the PROOF output list
    virtual TSelectorList* GetHistOutput() const = 0;
+   /// Get a counter that changes each time the output list is (re-)set
+   virtual ULong_t GetHistOutputGeneration() const = 0;
 
 protected:
    /// Set the current input file
@@ -48,6 +54,8 @@ protected:
 
    /// Write the objects meant to be merged using the output file
    virtual void WriteHistObjects() = 0;
+   /// Account for the memory used by the output objects
+   virtual void AccountHistMemory( SMemoryAccounting& acc ) const = 0;
 
 }; // class ISCycleBaseHist
 
@@ -28,7 +28,9 @@ class TTree;
 class TList;
 class TSelectorList;
 class TDirectory;
+class SMemoryAccounting;
 class SInputData;
+class SBranchUsage;
 
 /**
  *   @short Interface providing ntuple handling capabilities
@@ -70,14 +72,30 @@ protected:
    virtual void SaveOutputTrees() = 0;
    /// Load the input trees
    virtual void LoadInputTrees( const SInputData& id, TTree* main_tree,
-                                TDirectory*& inputFile ) = 0;
+                                TDirectory*& inputFile, Bool_t shared ) = 0;
+   /// Use the output trees of another cycle as input trees
+   virtual void
+   ConnectPipelineTrees( const SInputData& id,
+                         const std::vector< TTree* >& trees ) = 0;
    /// Read in the event from the "normal" trees
    virtual void GetEvent( Long64_t entry ) = 0;
+   /// Copy the variables read by the other cycles of a shared event loop
+   virtual void CopySharedVariables() = 0;
    /// Calculate the weight of the current event
    virtual Double_t CalculateWeight( const SInputData& inputData,
                                      Long64_t entry ) const = 0;
    /// Forget about the internally cached TTree pointers
    virtual void ClearCachedTrees() = 0;
+   /// Account for the memory used by the TTree buffers
+   virtual void AccountNTupleMemory( SMemoryAccounting& acc ) const = 0;
+   /// Set the object collecting the usage of the input branches
+   virtual void SetBranchUsage( SBranchUsage* usage ) = 0;
+   /// Connect the input branches copied into the output trees
+   virtual void ConnectCopiedBranches( Bool_t exclusive ) = 0;
+   /// Read the input branches copied into an output tree
+   virtual Bool_t CopyInputBranches( TTree* tree, Long64_t entry ) = 0;
+   /// Write the events held back for fast cloning
+   virtual void FlushCopiedEvents() = 0;
 
 }; // class ISCycleBaseNTuple
 
@@ -0,0 +1,102 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_CORE_SBranchUsage_H
+#define SFRAME_CORE_SBranchUsage_H
+
+// STL include(s):
+#include <vector>
+#include <string>
+#include <utility>
+
+// ROOT include(s):
+#include <TNamed.h>
+
+// Local include(s):
+#include "../include/SLogger.h"
+
+// Forward declaration(s):
+class TCollection;
+class TTree;
+
+/**
+ *   @short Object collecting which input branches were read by a cycle
+ *
+ *          Input ntuples often have hundreds of branches, of which a cycle
+ *          only reads a handful. The framework only reads the branches that
+ *          the cycle connected to with ConnectVariable(...), and this object
+ *          collects how much data was read from each of them, and how big
+ *          the branches are that were not read at all.
+ *
+ *          The objects are created on the workers, and are merged like
+ *          SCycleStatistics objects. The controller uses the merged object
+ *          to print a report, and to write the minimal list of branches
+ *          needed by the cycle. (See the BranchUsage and BranchList cycle
+ *          options.)
+ *
+ * @version $Revision$
+ */
+class SBranchUsage : public TNamed {
+
+public:
+   /// Type of the branch lists
+   typedef std::vector< std::pair< std::string, std::string > > list_type;
+
+   /// Constructor with a name
+   SBranchUsage( const char* name = "" );
+
+   /// Remember the branches of an input tree
+   void AddTree( const char* treeName, TTree* tree );
+   /// Add the data read from one connected branch
+   void AddRead( const char* treeName, const char* branchName,
+                 Long64_t entries, Long64_t bytes, Long64_t zipBytes );
+
+   /// Get the branches that were connected by the cycle
+   void GetConnectedBranches( list_type& branches ) const;
+   /// Print the usage of the branches
+   void PrintReport( SMsgType type, const list_type& branchList ) const;
+   /// Write the list of connected branches into a text file
+   Bool_t WriteBranchList( const TString& fileName ) const;
+
+   /// Read a list of branches from a text file
+   static Bool_t ReadBranchList( const TString& fileName,
+                                 list_type& branches );
+
+   /// Function merging the information from the worker nodes
+   Int_t Merge( TCollection* coll );
+
+private:
+   /// Get the index of a branch, creating a new entry if necessary
+   size_t Index( const std::string& treeName, const std::string& branchName );
+
+   std::vector< std::string > m_trees; ///< Names of the trees
+   std::vector< std::string > m_branches; ///< Names of the branches
+   /// Compressed size of the branches in all the seen input files
+   std::vector< Long64_t > m_diskBytes;
+   /// Number of input files in which the branches were connected
+   std::vector< Long64_t > m_connections;
+   std::vector< Long64_t > m_entries; ///< Entries read from the branches
+   std::vector< Long64_t > m_bytes; ///< Uncompressed bytes read
+   /// Estimated compressed bytes read from the branches
+   std::vector< Long64_t > m_zipBytes;
+
+   /// Message logger object
+   mutable SLogger m_logger; //!
+
+#ifndef DOXYGEN_IGNORE
+   ClassDef( SBranchUsage, 1 )
+#endif // DOXYGEN_IGNORE
+
+}; // class SBranchUsage
+
+#endif // SFRAME_CORE_SBranchUsage_H
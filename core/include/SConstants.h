@@ -31,12 +31,20 @@ namespace SFrame {
    static const char* CurrentInputDataName = "CurrentInputData";
    /// Name of the SCycleStatistics when sending it back from the PROOF workers
    static const char* RunStatisticsName    = "RunStatistics";
+   /// Name of the SBranchUsage object sent back from the PROOF workers
+   static const char* BranchUsageName      = "BranchUsage";
+   /// Name of the SEventList object sent back from the PROOF workers
+   static const char* EventListName        = "EventList";
+   /// Name of the SCycleProgress object sent as feedback from the PROOF workers
+   static const char* CycleProgressName    = "CycleProgress";
    /// Name of the TNamed object given to the cycle to get the output file name
    static const char* ProofOutputName      = "PROOF_OUTPUTFILE";
    /// Directory pattern for creating a temporary local directory
    static const char* ProofOutputDirName   = "jobTempOutput_XXXXXX";
    /// Name of the temporary local file created in LOCAL mode for output ntuples
    static const char* ProofOutputFileName  = "SFramePROOFTempOutput.root";
+   /// Extension of the index files listing the unmerged output ntuple files
+   static const char* NTupleIndexExtension = ".ntuples";
 
 } // namespace SFrame
 
@@ -16,21 +16,27 @@
 
 // STL include(s):
 #include <vector>
+#include <string>
 
 // ROOT include(s):
 #include <TSelector.h>
 #include <TString.h>
+#include <TStopwatch.h>
 
 // Local include(s):
 #include "ISCycleBaseConfig.h"
 #include "ISCycleBaseHist.h"
 #include "ISCycleBaseNTuple.h"
 #include "SCycleBaseBase.h"
+#include "SProgressMonitor.h"
 
 // Forward declaration(s):
 class TTree;
 class SInputData;
 class TList;
+class SCycleProgress;
+class SEventList;
+class TEntryList;
 
 /**
  *   @short The SCycleBase constituent responsible for running the cycle
@@ -145,11 +151,34 @@ public:
    virtual void EndMasterInputData( const SInputData& ) {}
    //@}
 
+   /// Set a cycle to process the events of this cycle in the same event loop
+   void SetPipelineSink( SCycleBaseExec* sink, Bool_t keepOutput );
+   /// Add a cycle to process the input events in the same event loop
+   void AddSharedScan( SCycleBaseExec* cycle );
+   /// Remove all cycles processing the input events in the same event loop
+   void ClearSharedScan();
+
+protected:
+   /// Record that the current event passed a named selection
+   void RecordSelection( const char* name );
+
 private:
    /// Function for reading the cycle configuration on the worker nodes
    void ReadConfig();
    /// Dummy override for the function defined in TObject
    virtual void ExecuteEvent( Int_t event, Int_t px, Int_t py );
+   /// Function starting the metrics collection for a new input file
+   void BeginFileMetrics();
+   /// Function recording the metrics collected for the current input file
+   void EndFileMetrics();
+   /// Function publishing the progress of the event processing
+   void UpdateProgress();
+   /// Function checking that the worker stays within its memory budget
+   void CheckMemoryBudget();
+   /// Function reading the cached event lists used by the cycle
+   void ReadEventLists();
+   /// Function setting up the event lists for a new input file
+   void BeginFileEventLists();
 
    /// The number of already processed events
    Long64_t m_nProcessedEvents;
@@ -164,6 +193,52 @@ private:
    /// List of all the event-level output TTree-s
    std::vector< TTree* > m_outputTrees;
 
+   /// @name Variables used in pipelining two cycles
+   //@{
+   SCycleBaseExec* m_pipelineSink; ///< Cycle processing the events of this one
+   SCycleBaseExec* m_pipelineSource; ///< Cycle providing the events
+   Bool_t          m_pipelineKeep; ///< Fill the output trees in a pipeline
+   Long64_t        m_pipelineEntry; ///< Entry number given to the sink cycle
+   //@}
+
+   /// @name Variables used in sharing the event loop between cycles
+   //@{
+   /// Cycles processing the input events of this cycle as well
+   std::vector< SCycleBaseExec* > m_sharedScan;
+   SCycleBaseExec* m_scanLeader; ///< Cycle running the shared event loop
+   //@}
+
+   /// @name Variables used in handling the lists of selected events
+   //@{
+   SEventList* m_eventRecord; ///< Events recorded in the output list
+   SEventList* m_eventCache; ///< Event lists read from the cache file
+   TEntryList* m_eventSelection; ///< Events to process from the current file
+   //@}
+
+   /// @name Variables used in collecting the job metrics
+   //@{
+   TStopwatch m_workerTimer; ///< Timer for the whole event loop
+   TStopwatch m_fileTimer;   ///< Timer for the current input file
+   TString    m_fileName;    ///< Name of the current input file
+   Long64_t   m_fileProcessedEvents; ///< Processed events before the file
+   Long64_t   m_fileSkippedEvents;   ///< Skipped events before the file
+   Long64_t   m_fileBytesRead;       ///< Bytes read before the file
+   Int_t      m_fileReadCalls;       ///< Read calls before the file
+   Long64_t   m_startBytesRead;      ///< Bytes read before the event loop
+   Long64_t   m_startBytesWritten;   ///< Bytes written before the event loop
+   Int_t      m_startReadCalls;      ///< Read calls before the event loop
+   /// Metrics records collected for the input files
+   std::vector< std::string > m_fileRecords;
+   //@}
+
+   /// @name Variables used in reporting the progress of the processing
+   //@{
+   SCycleProgress*  m_progress; ///< Progress object in the output list
+   SProgressMonitor m_progressMonitor; ///< Progress printer in LOCAL mode
+   Double_t         m_progressStart; ///< Start time of the event loop
+   Double_t         m_lastProgress; ///< Time of the last progress update
+   //@}
+
 #ifndef DOXYGEN_IGNORE
    ClassDef( SCycleBaseExec, 0 )
 #endif // DOXYGEN_IGNORE
@@ -17,6 +17,8 @@
 // STL include(s):
 #include <map>
 #include <string>
+#include <vector>
+#include <utility>
 
 // ROOT include(s):
 #include <TObject.h>
@@ -33,6 +35,7 @@
 class TDirectory;
 class TH1;
 class TSelectorList;
+class SMemoryAccounting;
 
 /**
  *   @short Histogramming part of SCycleBase
@@ -58,6 +61,8 @@ public:
    virtual void SetHistOutput( TSelectorList* output );
    /// Check which list should be used for the histogramming output
    virtual TSelectorList* GetHistOutput() const;
+   /// Get a counter that changes each time the output list is (re-)set
+   virtual ULong_t GetHistOutputGeneration() const;
 
    /// Function placing a ROOT object in the output file
    template< class T > T* Book( const T& histo,
@@ -79,6 +84,15 @@ public:
    /// Function searching for 1-dimensional histograms in the output file
    TH1* Hist( const char* name, const char* dir = 0 );
 
+   /// Function looking up the object booked from a call site (BOOK_CACHED)
+   TObject* FindBookedAt( const char* site );
+   /// Get the object found by the last FindBookedAt(...) call
+   TObject* GetBookedObject() const { return m_bookedObject; }
+   /// Function booking the object not found by FindBookedAt (BOOK_CACHED)
+   template< class T > T* BookMissing( const T& histo,
+                                       const char* directory = 0,
+                                       Bool_t inFile = kFALSE );
+
 protected:
    /// Set the current input file
    virtual void SetHistInputFile( TDirectory* file );
@@ -87,19 +101,32 @@ protected:
 
    /// Write the objects meant to be merged using the output file
    virtual void WriteHistObjects();
+   /// Account for the memory used by the output objects
+   virtual void AccountHistMemory( SMemoryAccounting& acc ) const;
 
 private:
    /// Function creating a temporary directory in memory
    TDirectory* GetTempDir() const;
+   /// Function forgetting about the objects booked by BOOK_CACHED
+   void ForgetBookedObjects();
 
 #ifndef __MAKECINT__
    /// Map used by the Hist function
    std::map< std::pair< std::string, std::string >, TH1* > m_histoMap;
+   /// Objects booked by BOOK_CACHED, in the order of their first booking
+   std::vector< std::pair< const char*, TObject* > > m_bookedObjects;
+   /// Index of the objects in m_bookedObjects, by their call sites
+   std::map< const char*, size_t > m_bookedIndex;
+   /// Index of the BOOK_CACHED object expected to be asked for next
+   size_t m_bookedNext;
    /// List of objects to be merged using the output file
    TList m_fileOutput;
 #endif // __MAKECINT__
 
    TSelectorList* m_proofOutput; ///< PROOF output list
+   ULong_t m_outputGeneration; ///< Counter incremented for each new output
+   TObject* m_bookedObject; ///< Object found by the last FindBookedAt call
+   const char* m_bookedSite; ///< Call site given to the last FindBookedAt
    TDirectory* m_inputFile; ///< Currently open input file
 
 #ifndef DOXYGEN_IGNORE
@@ -108,6 +135,59 @@ private:
 
 }; // class SCycleBaseHist
 
+#ifndef __CINT__
+
+namespace SFrame {
+
+   /// Helper function used by BOOK_CACHED to figure out the booked type
+   template< class T >
+   T* BookType( const T&, const char* = 0, Bool_t = kFALSE ) { return 0; }
+   /// Helper function used by BOOK_CACHED to cast to the booked type
+   template< class T >
+   T* BookCast( TObject* obj, T* ) { return static_cast< T* >( obj ); }
+
+} // namespace SFrame
+
+/// Helper macros for turning the line number into a string
+#define SFRAME_BOOK_STR2( X ) #X
+#define SFRAME_BOOK_STR( X ) SFRAME_BOOK_STR2( X )
+
+/// Unique identifier of a BOOK_CACHED call site
+#ifdef __COUNTER__
+#   define SFRAME_BOOK_SITE                                             \
+   __FILE__ ":" SFRAME_BOOK_STR( __LINE__ ) ":" SFRAME_BOOK_STR( __COUNTER__ )
+#else
+#   define SFRAME_BOOK_SITE __FILE__ ":" SFRAME_BOOK_STR( __LINE__ )
+#endif // __COUNTER__
+
+/**
+ * Booking an object with SCycleBaseHist::Book inside the event loop is
+ * expensive, as the temporary object given to the function has to be
+ * constructed and destructed in every call, even though the function
+ * returns the already booked object after the first call. This macro can be
+ * used instead, with the same arguments as SCycleBaseHist::Book:
+ *
+ * <code>
+ *   BOOK_CACHED( TH1F( "El_p_T", "Electron p_{T}", 100, 0.0, 150000.0 ),
+ *                "obj_test" )->Fill( el.Pt(), weight );
+ * </code>
+ *
+ * The object is only constructed the first time that the call site is
+ * reached with a new output list. After that the macro costs about as much
+ * as using a cached pointer.
+ *
+ * @warning The object is identified by the location of the macro in the
+ *          source code, and not by its name. So one call site must always
+ *          book the same object.
+ */
+#define BOOK_CACHED( ... )                                              \
+   ( FindBookedAt( SFRAME_BOOK_SITE ) ?                                 \
+     SFrame::BookCast( GetBookedObject(),                               \
+                       true ? 0 : SFrame::BookType( __VA_ARGS__ ) ) :   \
+     BookMissing( __VA_ARGS__ ) )
+
+#endif // __CINT__
+
 // Don't include the templated function(s) when we're generating
 // a dictionary:
 #ifndef __CINT__
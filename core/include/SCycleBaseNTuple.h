@@ -19,6 +19,7 @@
 #include <map>
 #include <string>
 #include <list>
+#include <typeinfo>
 
 // Local include(s):
 #include "ISCycleBaseConfig.h"
@@ -30,7 +31,12 @@
 class TTree;
 class TFile;
 class TBranch;
+class TLeaf;
+class TClass;
 class SInputData;
+class STree;
+class SMemoryAccounting;
+class SBranchUsage;
 
 /**
  *   @short NTuple handling part of SCycleBase
@@ -112,14 +118,29 @@ protected:
    void SaveOutputTrees();
    /// Load the input trees
    void LoadInputTrees( const SInputData& id, TTree* main_tree,
-                        TDirectory*& inputFile );
+                        TDirectory*& inputFile, Bool_t shared );
+   /// Use the output trees of another cycle as input trees
+   void ConnectPipelineTrees( const SInputData& id,
+                              const std::vector< TTree* >& trees );
    /// Read in the event from the "normal" trees
    void GetEvent( Long64_t entry );
+   /// Copy the variables read by the other cycles of a shared event loop
+   void CopySharedVariables();
    /// Calculate the weight of the current event
    Double_t CalculateWeight( const SInputData& inputData,
                              Long64_t entry ) const;
    /// Forget about the internally cached TTree pointers
    void ClearCachedTrees();
+   /// Account for the memory used by the TTree buffers
+   void AccountNTupleMemory( SMemoryAccounting& acc ) const;
+   /// Set the object collecting the usage of the input branches
+   void SetBranchUsage( SBranchUsage* usage );
+   /// Connect the input branches copied into the output trees
+   void ConnectCopiedBranches( Bool_t exclusive );
+   /// Read the input branches copied into an output tree
+   Bool_t CopyInputBranches( TTree* tree, Long64_t entry );
+   /// Write the events held back for fast cloning
+   void FlushCopiedEvents();
 
 private:
    /// Function translating a "typeid type" into a ROOT type character
@@ -128,8 +149,26 @@ private:
    static const char* TypeidType( const char* root_type );
    /// Function registering an input branch for use during the event loop
    void RegisterInputBranch( TBranch* br );
+   /// Function disabling the input branches not needed by the cycle
+   void PruneInputTree( TTree* tree, const SInputData& id ) const;
+   /// Function opening the file of an input tree not in the input files
+   TDirectory* OpenTreeFile( const TString& fileName );
+   /// Function setting up an input tree aligned to the events by an index
+   void SetupIndexedTree( TTree* tree, const STree& stree, Bool_t shared );
+   /// Function recording the data read from the input branches
+   void FlushBranchUsage();
+   /// Function connecting a primitive variable to an upstream cycle's one
+   void ConnectSharedVariable( TBranch* br, void* variable,
+                               const char* type_name, size_t size );
+   /// Function accessing an object written by an upstream cycle
+   void* GetSharedObject( TBranch* br, const std::type_info& ti ) const;
+   /// Function connecting an object to a copy of another cycle's object
+   void ConnectSharedObject( TBranch* br, void* object,
+                             void ( *copy )( void*, const void* ) );
    /// Function deleting the object created on the heap by ROOT
    void DeleteInputVariables();
+   /// Function forgetting about the branches copied into the output trees
+   void ClearTreeCopies();
    /// Function creating a sub-directory inside an existing directory
    TDirectory* MakeSubDirectory( const TString& path,
                                  TDirectory* dir ) const;
@@ -139,10 +178,96 @@ private:
    //
    /// List of input TTree pointers
    std::vector< TTree* >   m_inputTrees;
+   /// Input trees with one entry per event (the first one is the main tree)
+   std::vector< TTree* >   m_eventTrees;
    /// Vector of input branch pointers registered for the current cycle
    std::vector< TBranch* > m_inputBranches;
+   /// Flags showing which input branches belong to index-aligned trees
+   std::vector< Bool_t >   m_indexedBranches;
+   /// Files opened for the input trees not in the input files
+   std::vector< TFile* >   m_treeFiles;
    /// Pointers storing the input objects created by ConnectVariable(...)
    std::list< TObject* >   m_inputVarPointers;
+   /// Object collecting the usage of the input branches (if requested)
+   SBranchUsage* m_branchUsage;
+   /// Number of entries read from the input branches in the current file
+   Long64_t m_branchUsageEntries;
+#ifndef __MAKECINT__
+   /// Data read from one of the registered input branches
+   struct BranchRead {
+      std::string tree; ///< Name of the tree holding the branch
+      std::string branch; ///< Name of the branch
+      Double_t zipRatio; ///< Compressed/uncompressed size of the branch
+      Long64_t bytes; ///< Uncompressed bytes read from the branch
+   };
+   /// Data read from the input branches, in the order of m_inputBranches
+   std::vector< BranchRead > m_branchReads;
+#endif // __MAKECINT__
+
+   /// Flag showing that the input trees belong to an upstream cycle
+   Bool_t m_pipelined;
+   /// Flag showing that the input trees are read by other cycles as well
+   Bool_t m_sharedInput;
+#ifndef __MAKECINT__
+   /// Description of a variable read by another cycle
+   struct SharedVariable {
+      const void* source; ///< Address of the other cycle's variable
+      void* target; ///< Address of the variable of this cycle
+      size_t size; ///< Size of the variable in bytes
+      /// Function copying an object (null for primitive variables)
+      void ( *copy )( void* target, const void* source );
+   };
+   /// Variables copied from other cycles in every event
+   std::vector< SharedVariable > m_sharedVars;
+
+   /// Description of an input tree aligned to the events by an index
+   struct IndexedTree {
+      TTree* tree; ///< The input tree
+      TLeaf* majorLeaf; ///< Leaf of the major key in the main tree
+      TLeaf* minorLeaf; ///< Leaf of the minor key in the main tree
+      Long64_t major; ///< Major key of the current entry
+      Long64_t minor; ///< Minor key of the current entry
+      Long64_t entry; ///< The current entry of the tree
+      /// Indices of the registered input branches of the tree
+      std::vector< size_t > branches;
+   };
+   /// Input trees aligned to the events by an index
+   std::vector< IndexedTree > m_indexedTrees;
+
+   /// Function reading the entry of an index-aligned tree for an event
+   void LoadIndexedTree( IndexedTree& itree, Long64_t entry );
+
+   /// Description of an input branch copied into an output tree
+   struct CopiedBranch {
+      TBranch* input; ///< The branch in the current input tree
+      TBranch* output; ///< The branch in the output tree
+      Bool_t read; ///< The branch is not read by the cycle itself
+      std::vector< char > buffer; ///< Buffer created for a primitive branch
+      void* object; ///< Object created for an object branch
+      TClass* objectClass; ///< Type of the created object
+   };
+   /// Description of an output tree receiving copied input branches
+   struct TreeCopy {
+      TTree* output; ///< The output tree
+      TString source; ///< Name of the input tree to copy from
+      std::vector< TString > patterns; ///< Patterns of the copied branches
+      TTree* input; ///< The input tree in the current file
+      std::list< CopiedBranch > branches; ///< The copied branches
+      Bool_t deferred; ///< The events are held back for fast cloning
+      Long64_t firstEntry; ///< First entry held back
+      Long64_t nEntries; ///< Number of entries held back
+   };
+   /// Output trees that receive copied input branches
+   std::list< TreeCopy > m_treeCopies;
+
+   /// Function copying one input branch into an output tree
+   void ConnectCopiedBranch( TreeCopy& copy, TBranch* br,
+                             const std::list< CopiedBranch >& previous );
+   /// Function writing the events held back for one output tree
+   void FlushTreeCopy( TreeCopy& copy );
+   /// Function fast cloning a full input tree into an output tree
+   void FastCloneTreeCopy( TreeCopy& copy );
+#endif // __MAKECINT__
 
    TFile* m_outputFile; ///< Pointer to the active temporary output file
 
@@ -53,15 +53,18 @@ public:
    /// Run mode enumeration
    /**
     * This enumeration defines how the analysis cycle can be run. At the
-    * moment local running and running the cycle on a PROOF cluster are
-    * possible.
+    * moment local running, running the cycle in multiple forked local
+    * processes, and running the cycle on a PROOF cluster are possible.
     */
    enum RunMode {
       LOCAL, ///< Run the analysis cycle locally
-      PROOF  ///< Run the analysis cycle on a PROOF cluster
+      PROOF, ///< Run the analysis cycle on a PROOF cluster
+      FORK   ///< Run the analysis cycle in forked local worker processes
    };
    /// Definition of the type of the properties
    typedef std::vector< std::pair< std::string, std::string > > property_type;
+   /// Definition of the type of the (tree name, branch name) list
+   typedef std::vector< std::pair< std::string, std::string > > branch_type;
    /// Definition of the type of the input data
    typedef std::vector< SInputData > id_type;
 
@@ -147,10 +150,85 @@ public:
    /// Get whether the PROOF nodes are allowed to read each other's files
    Bool_t GetProcessOnlyLocal() const;
 
+   /// Set the time between two progress reports (in seconds)
+   void SetProgressInterval( Double_t interval );
+   /// Get the time between two progress reports (in seconds)
+   Double_t GetProgressInterval() const;
+
+   /// Set the maximal resident memory allowed for a worker (in MB)
+   void SetMemoryBudget( Long64_t budget );
+   /// Get the maximal resident memory allowed for a worker (in MB)
+   Long64_t GetMemoryBudget() const;
+
+   /// Set whether the processing should be checkpointed
+   void SetCheckpoint( Bool_t flag );
+   /// Get whether the processing should be checkpointed
+   Bool_t GetCheckpoint() const;
+
+   /// Set the maximal number of events between two checkpoints
+   void SetCheckpointEvents( Long64_t events );
+   /// Get the maximal number of events between two checkpoints
+   Long64_t GetCheckpointEvents() const;
+
+   /// Set whether the output ntuples should be merged into the output file
+   void SetMergeNTuples( Bool_t flag );
+   /// Get whether the output ntuples should be merged into the output file
+   Bool_t GetMergeNTuples() const;
+
+   /// Set whether the cycle should read the events of the previous cycle
+   void SetPipeline( Bool_t flag );
+   /// Get whether the cycle should read the events of the previous cycle
+   Bool_t GetPipeline() const;
+
+   /// Set whether the ntuples of the previous cycle should still be written
+   void SetKeepIntermediate( Bool_t flag );
+   /// Get whether the ntuples of the previous cycle should still be written
+   Bool_t GetKeepIntermediate() const;
+
+   /// Set whether the cycle should share the event loop of the previous one
+   void SetSharedScan( Bool_t flag );
+   /// Get whether the cycle should share the event loop of the previous one
+   Bool_t GetSharedScan() const;
+
+   /// Set whether the output should be written in a background process
+   void SetBackgroundMerge( Bool_t flag );
+   /// Get whether the output should be written in a background process
+   Bool_t GetBackgroundMerge() const;
+
+   /// Set the file to write the list of connected branches into
+   void SetBranchUsage( const TString& fileName );
+   /// Get the file to write the list of connected branches into
+   const TString& GetBranchUsage() const;
+
+   /// Set the file that the list of branches to read was taken from
+   void SetBranchListFile( const TString& fileName );
+   /// Get the file that the list of branches to read was taken from
+   const TString& GetBranchListFile() const;
+   /// Set the list of branches to read from the input trees
+   void SetBranchList( const branch_type& branches );
+   /// Get the list of branches to read from the input trees
+   const branch_type& GetBranchList() const;
+
+   /// Set the file caching the lists of selected events
+   void SetEventListFile( const TString& fileName );
+   /// Get the file caching the lists of selected events
+   const TString& GetEventListFile() const;
+   /// Set the name of the selection whose cached event list should be used
+   void SetUseEventList( const TString& selection );
+   /// Get the name of the selection whose cached event list should be used
+   const TString& GetUseEventList() const;
+
+   /// Remember an additional file that the configuration was read from
+   void AddConfigFile( const TString& fileName );
+   /// Get the additional files that the configuration was read from
+   const std::vector< TString >& GetConfigFiles() const;
+
    /// Print the configuration to the screen
    void PrintConfig() const;
    /// Re-arrange the input data objects
    void ArrangeInputData();
+   /// Process only one shard of all the input data objects
+   void SetShard( Int_t index, Int_t count );
    /// Fill the input data objects with information from the files
    void ValidateInput();
 
@@ -182,9 +260,39 @@ private:
    Int_t         m_cacheLearnEntries;
    /// Flag for only processing local files on the PROOF workers
    Bool_t        m_processOnlyLocal;
+   /// Time between two progress reports in seconds
+   Double_t      m_progressInterval;
+   /// Maximal resident memory allowed for a worker in MB
+   Long64_t      m_memoryBudget;
+   /// Flag for checkpointing the processing after each input file
+   Bool_t        m_checkpoint;
+   /// Maximal number of events between two checkpoints
+   Long64_t      m_checkpointEvents;
+   /// Flag for merging the output ntuples into the output file
+   Bool_t        m_mergeNTuples;
+   /// Flag for reading the events of the previous cycle in memory
+   Bool_t        m_pipeline;
+   /// Flag for writing the ntuples of the previous cycle in a pipeline
+   Bool_t        m_keepIntermediate;
+   /// Flag for reading the input together with the previous cycle
+   Bool_t        m_sharedScan;
+   /// Flag for writing the output in a background process
+   Bool_t        m_backgroundMerge;
+   /// File to write the list of connected branches into
+   TString       m_branchUsage;
+   /// File that the list of branches to read was taken from
+   TString       m_branchListFile;
+   /// The list of branches to read from the input trees
+   branch_type   m_branchList;
+   /// File caching the lists of selected events
+   TString       m_eventListFile;
+   /// Name of the selection whose cached event list should be used
+   TString       m_useEventList;
+   /// Files besides the XML file that the configuration was read from
+   std::vector< TString > m_configFiles; //!
 
 #ifndef DOXYGEN_IGNORE
-   ClassDef( SCycleConfig, 1 )
+   ClassDef( SCycleConfig, 10 )
 #endif // DOXYGEN_IGNORE
 
 }; // class SCycleConfig
@@ -16,6 +16,7 @@
 
 // STL include(s):
 #include <vector>
+#include <string>
 
 // ROOT include(s):
 #include "TString.h"
@@ -26,6 +27,8 @@
 
 // Forward declaration(s):
 class TProof;
+class TChain;
+class TList;
 class ISCycleBase;
 
 /**
@@ -72,6 +75,15 @@ public:
    /// Get the index of the current cycle
    UInt_t GetCurCycle() { return m_curCycle; }
 
+   /// Keep the PROOF connection(s) open after the controller is deleted
+   void SetKeepProof( Bool_t keep ) { m_keepProof = keep; }
+   /// Read the XML configuration even if it's cached
+   void SetForceReparse( Bool_t force ) { m_forceReparse = force; }
+   /// Process only one shard of the input data of all the cycles
+   void SetShard( Int_t index, Int_t count ) {
+      m_shardIndex = index; m_shardCount = count;
+   }
+
 private:
    /// Delete all analysis cycle objects from memory
    void DeleteAllAnalysisCycles();
@@ -79,10 +91,37 @@ private:
    void InitProof( const TString& server, Int_t nodes);
    /// "Historic" function, closing the current PROOF connection
    void ShutDownProof();
+   /// Function reading the job configuration from the XML file
+   Bool_t ReadConfigXML( std::string& jobName, TList& actions );
+   /// Function setting up the job from the configuration cache
+   Bool_t ReadConfigCache( std::string& jobName );
+   /// Function repeating the steps recorded in the configuration cache
+   Bool_t ReplayConfigCache( const TList& actions, const TList& cycles,
+                             std::string& jobName );
+   /// Function writing the configuration cache of the job
+   void WriteConfigCache( const TList& actions ) const;
    /// Function creating/updating the output file of the last cycle
    void WriteCycleOutput( TList* olist, const TString& filename,
                           const TString& config,
-                          Bool_t update ) const;
+                          Bool_t update,
+                          const ISCycleBase* cycle = 0 ) const;
+   /// Function writing records into the job metrics file
+   void WriteMetrics( const std::vector< std::string >& records,
+                      Bool_t truncate = kFALSE ) const;
+   /// Function reading the checkpoint of an interrupted cycle
+   Bool_t ReadCheckpoint( const TString& fileName, Int_t& inputData,
+                          Long64_t& entries ) const;
+   /// Function recording how far the processing of a cycle got
+   void WriteCheckpoint( const TString& fileName, Int_t inputData,
+                         Long64_t entries ) const;
+   /// Function running a cycle in forked worker processes
+   Bool_t ExecuteForked( ISCycleBase* cycle, TChain& chain, Long64_t first,
+                         Long64_t nentries, Int_t nWorkers ) const;
+   /// Function executed by the forked worker processes
+   Int_t ExecuteForkWorker( ISCycleBase* cycle, TChain& chain, Int_t worker,
+                            int socket ) const;
+   /// Function merging the output of a forked worker
+   void MergeForkOutput( TList* output, TList* workerOutput ) const;
 
    /// vector holding all analysis cycles to be executed
    std::vector< ISCycleBase* > m_analysisCycles;
@@ -93,8 +132,15 @@ private:
    /// Status flag showing if the object is initialized
    Bool_t  m_isInitialized;
    TString m_xmlConfigFile; ///< Name of the configuration file read
+   TString m_metricsFile; ///< Name of the job metrics file (if any)
+   /// Flag for reading the XML file even if the configuration is cached
+   Bool_t m_forceReparse;
+   Int_t m_shardIndex; ///< Index of the input shard to process
+   Int_t m_shardCount; ///< Number of shards to split the input data into
 
    TProof* m_proof; ///< Pointer to the currently used PROOF object
+   /// Flag for keeping the PROOF connection(s) open for a following job
+   Bool_t m_keepProof;
 
    mutable SLogger m_logger; ///< Message logger object
 
@@ -0,0 +1,79 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_CORE_SCycleProgress_H
+#define SFRAME_CORE_SCycleProgress_H
+
+// STL include(s):
+#include <vector>
+#include <string>
+
+// ROOT include(s):
+#include <TNamed.h>
+
+// Forward declaration(s):
+class TCollection;
+
+/**
+ *   @short Object describing the progress of the event processing
+ *
+ *          The workers update one such object in their output list at regular
+ *          time intervals. When running on PROOF, the objects are sent to the
+ *          client as "feedback" objects while the processing is still going
+ *          on. PROOF merges the objects of the workers before sending them,
+ *          so the object keeps the progress information of each worker
+ *          separately.
+ *
+ *          The information is evaluated by SProgressMonitor.
+ *
+ * @version $Revision$
+ */
+class SCycleProgress : public TNamed {
+
+public:
+   /// Constructor with a name
+   SCycleProgress( const char* name = "" );
+
+   /// Update the progress of one worker
+   void Update( const std::string& worker, Long64_t events,
+                Double_t time );
+
+   /// Get the number of workers known to the object
+   size_t GetNWorkers() const;
+   /// Get the name of one of the workers
+   const std::string& GetWorker( size_t i ) const;
+   /// Get the number of events processed by one of the workers
+   Long64_t GetEvents( size_t i ) const;
+   /// Get the time since one of the workers started processing (in seconds)
+   Double_t GetTime( size_t i ) const;
+   /// Get the processing rate of one of the workers (in Hz)
+   Double_t GetRate( size_t i ) const;
+
+   /// Get the number of events processed by all the workers
+   Long64_t GetTotalEvents() const;
+
+   /// Merge the progress information of other workers into this object
+   Int_t Merge( TCollection* coll );
+
+private:
+   std::vector< std::string > m_workers; ///< Names of the workers
+   std::vector< Long64_t > m_events; ///< Events processed by the workers
+   std::vector< Double_t > m_times; ///< Time spent by the workers
+
+#ifndef DOXYGEN_IGNORE
+   ClassDef( SCycleProgress, 1 )
+#endif // DOXYGEN_IGNORE
+
+}; // class SCycleProgress
+
+#endif // SFRAME_CORE_SCycleProgress_H
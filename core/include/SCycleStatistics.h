@@ -14,6 +14,10 @@
 #ifndef SFRAME_CORE_SCycleStatistics_H
 #define SFRAME_CORE_SCycleStatistics_H
 
+// STL include(s):
+#include <vector>
+#include <string>
+
 // ROOT include(s):
 #include <TNamed.h>
 
@@ -34,6 +38,10 @@ class TCollection;
  *          This class is used by the framework internally to send statistics
  *          information from the workers to the master node.
  *
+ *          Besides the event counts, the object also collects the resource
+ *          usage of the workers, and the per-worker/per-file records of the
+ *          job metrics file. (See SMetricsRecord.)
+ *
  * @version $Revision$
  */
 class SCycleStatistics : public TNamed {
@@ -53,6 +61,36 @@ public:
    /// Set the number of skipped events
    void SetSkippedEvents( Long64_t events );
 
+   /// Get the real time spent in the event loop (summed over workers)
+   Double_t GetRealTime() const;
+   /// Set the real time spent in the event loop
+   void SetRealTime( Double_t time );
+
+   /// Get the CPU time spent in the event loop (summed over workers)
+   Double_t GetCpuTime() const;
+   /// Set the CPU time spent in the event loop
+   void SetCpuTime( Double_t time );
+
+   /// Get the number of bytes read from the input files
+   Long64_t GetBytesRead() const;
+   /// Set the number of bytes read from the input files
+   void SetBytesRead( Long64_t bytes );
+
+   /// Get the number of bytes written to the output files
+   Long64_t GetBytesWritten() const;
+   /// Set the number of bytes written to the output files
+   void SetBytesWritten( Long64_t bytes );
+
+   /// Get the largest peak memory usage of the workers (in kB)
+   Long64_t GetPeakRSS() const;
+   /// Set the peak memory usage of the worker (in kB)
+   void SetPeakRSS( Long64_t rss );
+
+   /// Get the metrics records collected on the workers
+   const std::vector< std::string >& GetRecords() const;
+   /// Add a metrics record
+   void AddRecord( const std::string& record );
+
    /// Function merging the information from the worker nodes
    Int_t Merge( TCollection* coll );
    /// Write the object in the current output directory (const version)
@@ -65,12 +103,19 @@ public:
 private:
    Long64_t m_processedEvents; ///< The number of processed events
    Long64_t m_skippedEvents;   ///< The number of skipped events
+   Double_t m_realTime;        ///< Real time spent in the event loop
+   Double_t m_cpuTime;         ///< CPU time spent in the event loop
+   Long64_t m_bytesRead;       ///< Bytes read from the input files
+   Long64_t m_bytesWritten;    ///< Bytes written to the output files
+   Long64_t m_peakRSS;         ///< Largest peak memory usage of the workers
+   /// Metrics records collected on the workers
+   std::vector< std::string > m_records;
 
    /// Message logger object
    mutable SLogger m_logger; //!
 
 #ifndef DOXYGEN_IGNORE
-   ClassDef( SCycleStatistics, 1 )
+   ClassDef( SCycleStatistics, 2 )
 #endif // DOXYGEN_IGNORE
 
 }; // class SCycleStatistics
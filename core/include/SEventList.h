@@ -0,0 +1,106 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_CORE_SEventList_H
+#define SFRAME_CORE_SEventList_H
+
+// STL include(s):
+#include <vector>
+#include <string>
+#include <map>
+
+// ROOT include(s):
+#include <TNamed.h>
+#include <TList.h>
+
+// Local include(s):
+#include "../include/SLogger.h"
+
+// Forward declaration(s):
+class TCollection;
+class TEntryList;
+class SCycleConfig;
+
+/**
+ *   @short Object collecting the events passing the selections of a cycle
+ *
+ *          Re-running an analysis on the same input often means running the
+ *          same (expensive) preselection again and again. The cycle can
+ *          record the events passing a named selection with
+ *          SCycleBaseExec::RecordSelection(...), and this object collects
+ *          these events into one TEntryList per selection and input file.
+ *
+ *          The objects are created on the workers, and are merged like
+ *          SBranchUsage objects. The controller stores the lists of the
+ *          completely processed input files in the file given with the
+ *          EventListFile cycle option, under a key specific to the cycle
+ *          configuration. Later jobs can then only read the events of a
+ *          selection using the UseEventList option.
+ *
+ * @version $Revision$
+ */
+class SEventList : public TNamed {
+
+public:
+   /// Constructor with a name
+   SEventList( const char* name = "" );
+
+   /// Start recording the events of a new input file
+   void BeginFile( const char* fileId, Long64_t entries );
+   /// Count a processed event of the current input file
+   void AddProcessed() { if( m_current >= 0 ) ++m_processed[ m_current ]; }
+   /// Record that an entry of the current input file passed a selection
+   void AddEntry( const char* selection, Long64_t entry );
+
+   /// Get the events of an input file that passed a selection
+   TEntryList* GetList( const char* selection, const char* fileId ) const;
+   /// Number of input files with events stored in the object
+   size_t GetNFiles() const { return m_fileIds.size(); }
+
+   /// Store the lists of the completely processed files of a recording
+   void Update( const SEventList& recorded );
+
+   /// Name of the object belonging to a cycle configuration
+   static TString CacheKey( const SCycleConfig& config );
+
+   /// Function merging the information from the worker nodes
+   Int_t Merge( TCollection* coll );
+
+private:
+   /// Get the index of an input file, creating a new entry if necessary
+   size_t Index( const std::string& fileId, Long64_t entries );
+   /// Find the list of a selection for an input file
+   TEntryList* FindList( const char* selection, const char* fileId ) const;
+
+   /// Names of the selections recorded for the input files
+   std::vector< std::string > m_selections;
+   std::vector< std::string > m_fileIds; ///< Identifiers of the input files
+   std::vector< Long64_t > m_entries; ///< Number of entries in the files
+   std::vector< Long64_t > m_processed; ///< Number of processed entries
+   TList m_lists; ///< The entry lists of the selections and files
+
+   /// Index of the input file currently being processed
+   Int_t m_current; //!
+   /// The entry lists of the current input file
+   std::map< std::string, TEntryList* > m_currentLists; //!
+
+   /// Message logger object
+   mutable SLogger m_logger; //!
+
+#ifndef DOXYGEN_IGNORE
+   ClassDef( SEventList, 1 )
+#endif // DOXYGEN_IGNORE
+
+}; // class SEventList
+
+#endif // SFRAME_CORE_SEventList_H
@@ -37,7 +37,13 @@
 #pragma link C++ class SCycleConfig+;
 #pragma link C++ class SCycleOutput+;
 #pragma link C++ class SCycleStatistics+;
+#pragma link C++ class SBranchUsage+;
+#pragma link C++ class SEventList+;
 #pragma link C++ class SOutputFile+;
+#pragma link C++ class SCycleProgress+;
+
+// The class receiving the progress feedback on the client:
+#pragma link C++ class SProgressMonitor;
 
 // The base classes:
 #pragma link C++ class ISCycleBaseConfig+;
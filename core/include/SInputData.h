@@ -153,7 +153,8 @@ class STree : public TObject {
 public:
    /// Constructor with a tree name
    STree( const TString& name = "", Int_t typ = 0 )
-      : treeName( name ), type( typ ) {}
+      : treeName( name ), type( typ ), copyBranches( "" ), copyFrom( "" ),
+        fileName( "" ), indexMajor( "" ), indexMinor( "" ) {}
 
    /// Assignment operator
    STree& operator=  ( const STree& parent );
@@ -183,8 +184,42 @@ public:
     */
    Int_t type;
 
+   /// Input branches to copy into an output tree
+   /**
+    * An output tree can list input branches (with wildcards, separated by
+    * spaces or commas) that the framework should copy into it for all the
+    * accepted events, without the user having to connect to and declare
+    * them one by one.
+    */
+   TString copyBranches;
+   /// Name of the input tree to copy the branches from
+   /**
+    * When not specified, the branches are copied from the first regular
+    * input tree.
+    */
+   TString copyFrom;
+
+   /// File holding an input tree, if it's not in the input files
+   /**
+    * Input trees with derived variables can be kept in a separate file,
+    * instead of rewriting the whole input ntuple with them. Such trees have
+    * to be aligned to the events using an index.
+    */
+   TString fileName;
+   /// Major key of the index aligning an input tree to the events
+   /**
+    * When specified, the input tree doesn't need to have one entry per
+    * event. For each event the entry with the same major (and minor) key as
+    * the event is read from the tree. The keys are the values of the
+    * branches with the same name in the main input tree. (Like the run and
+    * event numbers.)
+    */
+   TString indexMajor;
+   /// Minor key of the index aligning an input tree to the events
+   TString indexMinor;
+
 #ifndef DOXYGEN_IGNORE
-   ClassDef( STree, 1 )
+   ClassDef( STree, 3 )
 #endif // DOXYGEN_IGNORE
 
 }; // class STree
@@ -218,6 +253,13 @@ public:
    /// Set the number of events to skip at the beginning of the input data
    void SetNEventsSkip  ( Long64_t nevents )       { m_neventsskip = nevents; }
 
+   /// Set which shard of the input data should be processed
+   void SetShard( Int_t index, Int_t count );
+   /// Get the index of the shard of the input data that is processed
+   Int_t GetShardIndex() const                     { return m_shardIndex; }
+   /// Get the number of shards that the input data is split into
+   Int_t GetShardCount() const                     { return m_shardCount; }
+
    /// Set whether the file properties can be cached
    void SetCacheable( Bool_t flag = kTRUE )        { m_cacheable = flag; }
    /// Get whether the file properties can be caches
@@ -292,6 +334,10 @@ public:
    Long64_t GetNEventsMax() const  { return m_neventsmax; }
    /// Get the number of events to skip at the beginning of the input data
    Long64_t GetNEventsSkip() const { return m_neventsskip; }
+   /// Get the number of events to skip, taking the shard into account
+   Long64_t GetShardNEventsSkip() const;
+   /// Get the maximal number of events to process from the shard
+   Long64_t GetShardNEventsMax() const;
 
    /// Assignment operator
    SInputData& operator=  ( const SInputData& parent );
@@ -315,6 +361,10 @@ private:
    Bool_t LoadInfoOnFile( SFile* file, TFileCollection* filecoll );
    /// Function accessing the metadata about a given input file
    TFileInfo* AccessFileInfo( SFile* file, TFileCollection* filecoll );
+   /// Function calculating the range of events belonging to the shard
+   void CalculateShardRange();
+   /// Function calculating the first event of a shard
+   Long64_t ShardBoundary( Long64_t first, Long64_t last, Int_t index ) const;
    /// Function creating a new dataset object for this input data object
    TDSet* MakeDataSet() const;
    /// Function trying to access the dataset object in a given directory
@@ -332,6 +382,10 @@ private:
    Long64_t m_eventsTotal; ///< The total number of events in the input
    Long64_t m_neventsmax; ///< The maximum number of events to process
    Long64_t m_neventsskip; ///< The number of events to skip
+   Int_t m_shardIndex; ///< Index of the shard to process
+   Int_t m_shardCount; ///< Number of shards that the input is split into
+   Long64_t m_shardSkip; ///< The number of events to skip for the shard
+   Long64_t m_shardMax; ///< The number of events to process for the shard
    Bool_t m_cacheable; ///< Flag showing whether to cache the ID info
    Bool_t m_skipValid; ///< Flag showing whether to skip the ID validation
    /// Flag showing whether to skip the file lookup during dataset validation
@@ -343,7 +397,7 @@ private:
    mutable SLogger m_logger; //! Transient logger object
 
 #ifndef DOXYGEN_IGNORE
-   ClassDef( SInputData, 1 )
+   ClassDef( SInputData, 2 )
 #endif // DOXYGEN_IGNORE
 
 }; // class SInputData
@@ -16,17 +16,29 @@
 
 // STL include(s):
 #include <string>
-#include <map>
 
 // Local include(s):
 #include "SMsgType.h"
 
+// Forward declaration(s):
+class SLogWriterQueue;
+
 /**
  *   @short Message writing class
  *
  *          Singleton class for actually writing the formatted
  *          messages to the console.
  *
+ *          By default the messages are not written to the console by the
+ *          thread creating them. They are put into a lock-free queue
+ *          instead, from which a background thread writes them out in
+ *          batches. This way the code producing the messages never has to
+ *          wait for the console/logfile. The queue is flushed explicitly
+ *          when an ERROR, FATAL or ALWAYS message is received, when Flush()
+ *          is called, when the process receives a crash or termination
+ *          signal, and at the end of the process. The background writer is
+ *          only available when the code is compiled as C++11.
+ *
  *          Right now it only writes messages to the terminal, but
  *          one possibility would be to write messages to a file
  *          for batch running later on. (Just an idea...)
@@ -36,6 +48,9 @@
  */
 class SLogWriter {
 
+   /// The background writer needs to access the formatting function
+   friend class SLogWriterQueue;
+
 public:
    /// Function for accessing the single object
    static SLogWriter* Instance();
@@ -44,27 +59,70 @@ public:
 
    /// Function writing a message to the output
    void Write( SMsgType type, const std::string& line ) const;
+   /// Wait until all the queued messages are written to the output
+   void Flush() const;
 
    /// Set the message type above which messages are printed
    void SetMinType( SMsgType type );
    /// Get the message type above which messages are printed
    SMsgType GetMinType() const;
 
+   /// Turn the asynchronous writing of the messages on or off
+   void SetAsync( bool async );
+   /// Check whether the messages are written asynchronously
+   bool GetAsync() const;
+
 protected:
    /// Protected default constructor
    SLogWriter();
 
 private:
+   /// Append a formatted message line to a buffer
+   void Format( std::string& buffer, SMsgType type,
+                const std::string& line ) const;
+   /// Stop the background writer, writing out all queued messages
+   static void StopQueue();
+   /// Function called at the exit of the process
+   static void AtExit();
+   /// Function called in the parent process before a fork
+   static void AtForkPrepare();
+   /// Function called in the parent process after a fork
+   static void AtForkParent();
+   /// Function called in the child process after a fork
+   static void AtForkChild();
+   /// Install the signal handlers writing out the queued messages
+   static void InstallSignalHandlers();
+   /// Function called when the process receives a crash/termination signal
+   static void AtSignal( int sig );
+
+   /// Number of possible message types (including the unused 0 value)
+   static const int NUMBER_OF_TYPES = ALWAYS + 1;
+
    /// Single instance, used in the singleton implementation
    static SLogWriter* m_instance;
 
    /// Message type -> type name association
-   std::map< SMsgType, std::string > m_typeMap;
+   std::string m_typeNames[ NUMBER_OF_TYPES ];
    /// Message type -> message color association
-   std::map< SMsgType, std::string > m_colorMap;
+   std::string m_colors[ NUMBER_OF_TYPES ];
    /// Minimum type of messages that are still printed
-   SMsgType                          m_minType;
+   SMsgType    m_minType;
+   /// Flag showing whether the output goes to a terminal
+   bool        m_isTerminal;
+   /// Flag showing whether the messages should be written asynchronously
+   bool        m_async;
 
 }; // class SLogWriter
 
+/**
+ * This function is called for every message (part), so it's declared
+ * inline to make it as cheap as possible.
+ *
+ * @see SLogWriter::SetMinType
+ */
+inline SMsgType SLogWriter::GetMinType() const {
+
+   return m_minType;
+}
+
 #endif // SFRAME_CORE_SLogWriter_H
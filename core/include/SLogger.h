@@ -60,6 +60,9 @@ public:
    /// Get the source string of the logger
    const char* GetSource() const;
 
+   /// Check whether messages of a given type would be printed
+   bool IsActive( SMsgType type ) const;
+
    /// Copy operator
    SLogger& operator= ( const SLogger& parent );
 
@@ -113,6 +116,19 @@ private:
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
 
+/**
+ * This function can be used to avoid constructing expensive messages that
+ * would not be printed anyway. It's used by the SLOG and REPORT_* macros.
+ *
+ * @param type The message type to check
+ * @returns <code>true</code> if messages of this type are printed at the
+ *          moment, <code>false</code> otherwise
+ */
+inline bool SLogger::IsActive( SMsgType type ) const {
+
+   return ( type >= m_logWriter->GetMinType() );
+}
+
 /**
  * This operator handles all stream modifiers that have been written
  * to work on SLogger objects specifically. Right now there is basically
@@ -163,6 +179,47 @@ inline SLogger& SLogger::operator<< ( SMsgType type ) {
    return *this;
 }
 
+/// Compile-time floor for the message types printed by the logging macros
+/**
+ * Messages with a type below this value, printed using the SLOG and REPORT_*
+ * macros, are removed from the code completely by the compiler. By default
+ * all messages are kept. Production builds can remove the VERBOSE messages
+ * (for instance) by compiling the code with <code>-DSLOGGER_MIN_TYPE=2</code>.
+ * (See the SFRAME_LOG_FLOOR variable in Makefile.common.)
+ */
+#ifndef SLOGGER_MIN_TYPE
+#   define SLOGGER_MIN_TYPE 1
+#endif // SLOGGER_MIN_TYPE
+
+/// Macro checking whether a message of a given type should be constructed
+/**
+ * The first part of the check is evaluated by the compiler, the second part
+ * only costs a comparison of two integers at runtime.
+ */
+#define SLOGGER_ENABLED( TYPE ) \
+   ( ( ( TYPE ) >= SLOGGER_MIN_TYPE ) && m_logger.IsActive( TYPE ) )
+
+/// Convenience macro for printing messages only when they would be shown
+/**
+ * Writing
+ *
+ * <code>
+ *   m_logger << DEBUG << "Some " << Expensive() << " message" << SLogger::endmsg;
+ * </code>
+ *
+ * evaluates all the parts of the message (including the call to Expensive()),
+ * even if DEBUG messages are not printed. The same message written as
+ *
+ * <code>
+ *   SLOG( DEBUG ) << "Some " << Expensive() << " message" << SLogger::endmsg;
+ * </code>
+ *
+ * is only constructed if it will actually be printed. The macro uses the
+ * object called <code>m_logger</code>, just like the REPORT_* macros.
+ */
+#define SLOG( TYPE )                                                  \
+   if( ! SLOGGER_ENABLED( TYPE ) ) {} else m_logger << TYPE
+
 // This is a GCC extension for getting the name of the current function.
 #if defined( __GNUC__ )
 #   define SLOGGER_FNAME __PRETTY_FUNCTION__
@@ -195,9 +252,13 @@ inline SLogger& SLogger::operator<< ( SMsgType type ) {
  *   REPORT_VERBOSE( "This is a verbose message with a number: " << number );
  * </code>
  */
-#define REPORT_VERBOSE( MESSAGE )                             \
-   m_logger << ::VERBOSE << SLOGGER_REPORT_PREFIX << MESSAGE; \
-   m_logger << SLogger::endmsg
+#define REPORT_VERBOSE( MESSAGE )                                     \
+   do {                                                               \
+      if( SLOGGER_ENABLED( ::VERBOSE ) ) {                            \
+         m_logger << ::VERBOSE << SLOGGER_REPORT_PREFIX << MESSAGE;   \
+         m_logger << SLogger::endmsg;                                 \
+      }                                                               \
+   } while( 0 )
 
 /// Convenience macro for reporting ERROR messages in the code
 /**
@@ -210,9 +271,13 @@ inline SLogger& SLogger::operator<< ( SMsgType type ) {
  *   REPORT_ERROR( "A serious error message" );
  * </code>
  */
-#define REPORT_ERROR( MESSAGE )                             \
-   m_logger << ::ERROR << SLOGGER_REPORT_PREFIX << MESSAGE; \
-   m_logger << SLogger::endmsg
+#define REPORT_ERROR( MESSAGE )                                       \
+   do {                                                               \
+      if( SLOGGER_ENABLED( ::ERROR ) ) {                              \
+         m_logger << ::ERROR << SLOGGER_REPORT_PREFIX << MESSAGE;     \
+         m_logger << SLogger::endmsg;                                 \
+      }                                                               \
+   } while( 0 )
 
 /// Convenience macro for reporting FATAL messages in the code
 /**
@@ -225,8 +290,12 @@ inline SLogger& SLogger::operator<< ( SMsgType type ) {
  *   REPORT_FATAL( "A very serious error message" );
  * </code>
  */
-#define REPORT_FATAL( MESSAGE )                             \
-   m_logger << ::FATAL << SLOGGER_REPORT_PREFIX << MESSAGE; \
-   m_logger << SLogger::endmsg
+#define REPORT_FATAL( MESSAGE )                                       \
+   do {                                                               \
+      if( SLOGGER_ENABLED( ::FATAL ) ) {                              \
+         m_logger << ::FATAL << SLOGGER_REPORT_PREFIX << MESSAGE;     \
+         m_logger << SLogger::endmsg;                                 \
+      }                                                               \
+   } while( 0 )
 
 #endif // SFRAME_CORE_SLogger_H
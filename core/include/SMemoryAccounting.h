@@ -0,0 +1,97 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_CORE_SMemoryAccounting_H
+#define SFRAME_CORE_SMemoryAccounting_H
+
+// STL include(s):
+#include <vector>
+#include <string>
+
+// ROOT include(s):
+#include <Rtypes.h>
+
+// Local include(s):
+#include "SLogger.h"
+
+// Forward declaration(s):
+class TObject;
+class TTree;
+class TBranch;
+
+/**
+ *   @short Class estimating the memory used by the objects of a cycle
+ *
+ *          When many workers run on the same machine, it can easily happen
+ *          that the output objects and the TTree buffers of the cycles use up
+ *          all the memory of the machine. This class is used to collect an
+ *          estimate of how much memory the individual output objects, output
+ *          TTree buffers and input branch buffers use, so the biggest
+ *          consumers can be identified.
+ *
+ *          The sizes are only estimates. For histograms the size of the bin
+ *          arrays is calculated, for other objects the size of their
+ *          serialised form, and for TTrees the size of their basket buffers.
+ *
+ * @version $Revision$
+ */
+class SMemoryAccounting {
+
+public:
+   /// Default constructor
+   SMemoryAccounting();
+
+   /// Add the size of one object
+   void Add( const char* category, const char* name, Long64_t bytes );
+   /// Add the size of an output object
+   void AddObject( const char* category, const char* name,
+                   const TObject* obj );
+   /// Add the size of the basket buffers of a TTree
+   void AddTree( const char* category, TTree* tree );
+   /// Add the size of the basket buffers of a branch
+   void AddBranch( const char* category, TBranch* branch );
+
+   /// Get the number of accounted objects
+   size_t GetN() const;
+   /// Get the summed size of all the accounted objects (in bytes)
+   Long64_t GetTotal() const;
+
+   /// Print the biggest memory consumers
+   void Print( SMsgType type, size_t n = 10 ) const;
+
+   /// Estimate the memory used by an object
+   static Long64_t ObjectSize( const TObject* obj );
+   /// Estimate the memory used by the basket buffers of a TTree
+   static Long64_t TreeSize( TTree* tree );
+   /// Estimate the memory used by the basket buffers of a branch
+   static Long64_t BranchSize( TBranch* branch );
+   /// Get the current resident memory usage of the process (in kB)
+   static Long64_t GetResidentMemory();
+
+private:
+   /// Description of one accounted object
+   struct Entry {
+      std::string category; ///< The type of the object
+      std::string name; ///< The name of the object
+      Long64_t bytes; ///< Estimated size of the object
+   };
+
+   /// The accounted objects
+   std::vector< Entry > m_entries;
+
+   /// Message logger object
+   mutable SLogger m_logger;
+
+}; // class SMemoryAccounting
+
+#endif // SFRAME_CORE_SMemoryAccounting_H
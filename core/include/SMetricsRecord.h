@@ -0,0 +1,73 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_CORE_SMetricsRecord_H
+#define SFRAME_CORE_SMetricsRecord_H
+
+// STL include(s):
+#include <string>
+
+// ROOT include(s):
+#include <Rtypes.h>
+
+/**
+ *   @short Helper class for building one record of the job metrics file
+ *
+ *          SFrame can write machine-readable metrics about the processing
+ *          into a file specified with the MetricsFile attribute of the
+ *          JobConfiguration node. The file is written in the "newline
+ *          delimited JSON" format, each line being a single JSON object.
+ *          This class is used to assemble such a line.
+ *
+ *          <code>
+ *            SMetricsRecord record( "file" );
+ *            record.Add( "name", fileName );
+ *            record.Add( "events_processed", nevents );
+ *            const std::string& line = record.GetJSON();
+ *          </code>
+ *
+ * @version $Revision$
+ */
+class SMetricsRecord {
+
+public:
+   /// Constructor specifying the type of the record
+   SMetricsRecord( const char* type );
+
+   /// Add a string property to the record
+   void Add( const char* key, const char* value );
+   /// Add a string property to the record
+   void Add( const char* key, const std::string& value );
+   /// Add an integer property to the record
+   void Add( const char* key, Long64_t value );
+   /// Add a floating point property to the record
+   void Add( const char* key, Double_t value );
+
+   /// Get the record as a single line JSON object
+   std::string GetJSON() const;
+
+   /// Get the peak resident memory usage of the current process (in kB)
+   static Long64_t GetPeakRSS();
+
+private:
+   /// Start a new property with the specified key
+   void AddKey( const char* key );
+   /// Append an escaped JSON string to the record
+   void AddString( const char* value );
+
+   /// The properties of the record, without the closing brace
+   std::string m_json;
+
+}; // class SMetricsRecord
+
+#endif // SFRAME_CORE_SMetricsRecord_H
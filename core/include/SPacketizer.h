@@ -0,0 +1,115 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_CORE_SPacketizer_H
+#define SFRAME_CORE_SPacketizer_H
+
+// STL include(s):
+#include <vector>
+
+// ROOT include(s):
+#include <Rtypes.h>
+
+// Local include(s):
+#include "SLogger.h"
+
+// Forward declaration(s):
+class TChain;
+
+/**
+ *   @short Class distributing the entries of a chain between local workers
+ *
+ *          When processing the entries of a chain with multiple local worker
+ *          processes, splitting the entries statically between the workers
+ *          leaves most of them idle at the end of the job, as the input files
+ *          can be very different in size and in processing cost. This class
+ *          hands out the entries in small packets instead, on request.
+ *
+ *          The boundaries of the packets are always aligned to the cluster
+ *          (basket) boundaries of the input trees, so that no basket has to
+ *          be read by more than one worker. The input files are initially
+ *          divided between the workers, so each worker keeps reading the same
+ *          files. A worker running out of its own files steals the second
+ *          half of the largest remaining file of another worker.
+ *
+ *          The size of the packets is adjusted based on the processing rate
+ *          measured for each worker, such that one packet would take
+ *          about the configured packet time to process. Towards the end of
+ *          the job the packets become smaller, so that all workers finish at
+ *          about the same time.
+ *
+ * @version $Revision$
+ */
+class SPacketizer {
+
+public:
+   /// Constructor with the number of workers and the target packet time
+   SPacketizer( Int_t nWorkers, Double_t packetTime = 2.0 );
+
+   /// Description of a range of entries handed out to a worker
+   struct Packet {
+      Long64_t first; ///< First entry of the packet in the chain
+      Long64_t entries; ///< Number of entries in the packet
+   };
+
+   /// Set up the packetizer for processing a range of entries of a chain
+   Bool_t Initialize( TChain& chain, Long64_t first, Long64_t nentries );
+
+   /// Get the next packet to be processed by a worker
+   Bool_t Next( Int_t worker, Packet& packet );
+   /// Report how long it took a worker to process its last packet
+   void Report( Int_t worker, Long64_t entries, Double_t realTime );
+
+   /// Get the number of workers
+   Int_t GetNWorkers() const;
+   /// Get the total number of entries to be processed
+   Long64_t GetTotalEntries() const;
+   /// Get the number of entries not handed out yet
+   Long64_t GetRemainingEntries() const;
+   /// Get the number of packets handed out to a worker
+   Int_t GetPackets( Int_t worker ) const;
+   /// Get the number of times a worker had to steal work from another one
+   Int_t GetSteals( Int_t worker ) const;
+   /// Get the measured processing rate of a worker (in Hz)
+   Double_t GetRate( Int_t worker ) const;
+
+private:
+   /// A contiguous range of entries (usually one input file) of a worker
+   struct Unit {
+      Long64_t next; ///< The first entry not yet handed out
+      Long64_t end; ///< The end of the range of entries
+      Int_t owner; ///< The worker processing the range
+   };
+
+   /// Select the unit from which a worker should get its next packet
+   Unit* SelectUnit( Int_t worker );
+   /// Get the cluster boundary closest to an entry, inside a range
+   Long64_t Boundary( Long64_t entry, Long64_t begin, Long64_t end ) const;
+
+   Int_t m_nWorkers; ///< Number of workers
+   Double_t m_packetTime; ///< Target processing time of one packet
+   /// Cluster boundaries of the input trees (as chain entries)
+   std::vector< Long64_t > m_boundaries;
+   std::vector< Unit > m_units; ///< The ranges of entries to process
+   Long64_t m_total; ///< Total number of entries to process
+   Long64_t m_remaining; ///< Number of entries not handed out yet
+   std::vector< Int_t > m_packets; ///< Packets given to the workers
+   std::vector< Int_t > m_steals; ///< Number of steals by the workers
+   std::vector< Double_t > m_rates; ///< Processing rates of the workers
+
+   /// Message logger object
+   mutable SLogger m_logger;
+
+}; // class SPacketizer
+
+#endif // SFRAME_CORE_SPacketizer_H
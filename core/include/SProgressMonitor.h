@@ -0,0 +1,84 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_CORE_SProgressMonitor_H
+#define SFRAME_CORE_SProgressMonitor_H
+
+// ROOT include(s):
+#include <Rtypes.h>
+
+// Local include(s):
+#include "SLogger.h"
+
+// Forward declaration(s):
+class TList;
+class TProof;
+class SCycleProgress;
+
+/**
+ *   @short Class printing the progress of the event processing
+ *
+ *          The class receives SCycleProgress objects from the workers, and
+ *          prints at regular time intervals the overall number of processed
+ *          events, the processing rate, and the estimated time until the
+ *          processing finishes. Workers that process events much slower than
+ *          the others are reported as well.
+ *
+ *          In LOCAL mode the cycle itself feeds its progress to such an
+ *          object, while on PROOF the object receives the "feedback" objects
+ *          sent by the workers, through TProof's Feedback(TList*) signal.
+ *
+ * @version $Revision$
+ */
+class SProgressMonitor {
+
+public:
+   /// Constructor with the reporting interval
+   SProgressMonitor( Double_t interval = 10.0 );
+   /// Destructor
+   ~SProgressMonitor();
+
+   /// Set the minimum time between two reports (in seconds)
+   void SetInterval( Double_t interval );
+   /// Start monitoring a new event loop
+   void Start( Long64_t totalEvents );
+   /// Receive the feedback objects from PROOF
+   void Connect( TProof* proof );
+   /// Stop receiving the feedback objects from PROOF
+   void Disconnect();
+
+   /// Report the progress, if enough time passed since the last report
+   void Update( const SCycleProgress& progress, Bool_t force = kFALSE );
+   /// Function receiving the feedback objects from PROOF
+   void Feedback( TList* objects );
+
+   /// Get the current time in seconds
+   static Double_t Now();
+
+private:
+   Double_t m_interval; ///< Minimum time between two reports
+   Long64_t m_totalEvents; ///< Total number of events to process
+   Double_t m_startTime; ///< Time when the event loop started
+   Double_t m_lastReport; ///< Time of the last report
+   TProof*  m_proof; ///< The PROOF session sending the feedback
+
+   /// Message logger object
+   mutable SLogger m_logger;
+
+#ifndef DOXYGEN_IGNORE
+   ClassDef( SProgressMonitor, 0 )
+#endif // DOXYGEN_IGNORE
+
+}; // class SProgressMonitor
+
+#endif // SFRAME_CORE_SProgressMonitor_H
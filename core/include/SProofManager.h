@@ -16,6 +16,7 @@
 
 // STL include(s):
 #include <map>
+#include <string>
 
 // ROOT include(s):
 #include <TString.h>
@@ -41,6 +42,12 @@ class TProof;
  *          remembers which connections are already open, and it also deletes
  *          them when instructed (or when deleted).
  *
+ *          The class also remembers (in a small file in the user's home
+ *          directory) the checksums of the PAR packages that were enabled
+ *          on the PROOF servers. Since the servers keep the packages in
+ *          their sandboxes between sessions, an unchanged package doesn't
+ *          need to be uploaded again by the next job.
+ *
  * @version $Revision$
  */
 class SProofManager {
@@ -64,6 +71,12 @@ public:
    /// Set a given PROOF server to "configured" state
    void SetConfigured( const TString& url, const TString& param = "",
                        Bool_t state = kTRUE );
+   /// Set all PROOF servers to "not configured" state
+   void ResetConfigured();
+   /// Check if a package was already enabled on a server by an earlier job
+   Bool_t IsPackageEnabled( const TString& url, const TString& package );
+   /// Remember that a package was enabled on a server
+   void SetPackageEnabled( const TString& url, const TString& package );
    /// Function deleting all the open PROOF connections
    void Cleanup();
 
@@ -72,9 +85,19 @@ private:
    SProofManager();
    /// Function printing the logs of all the workers from all the connections
    void PrintWorkerLogs() const;
+   /// Get the name of the file holding the package checksums
+   static TString PackageCacheFile();
+   /// Read the package checksums from the cache file
+   void ReadPackageCache();
+   /// Calculate the checksum of a package file
+   static std::string PackageChecksum( const TString& package );
 
    /// Internal cache of the open connections
    ConnMap_t m_connections;
+   /// Checksums of the packages enabled on the servers
+   std::map< std::string, std::string > m_packages;
+   /// Flag showing whether the package checksums were read already
+   Bool_t m_packagesRead;
 
    /// Singleron instance of the object
    static SProofManager* m_instance;
@@ -0,0 +1,348 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+// STL include(s):
+#include <algorithm>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+
+// ROOT include(s):
+#include <TCollection.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TObjArray.h>
+#include <TSystem.h>
+
+// Local include(s):
+#include "../include/SBranchUsage.h"
+
+#ifndef DOXYGEN_IGNORE
+ClassImp( SBranchUsage )
+#endif // DOXYGEN_IGNORE
+
+namespace {
+
+   /// Helper class for ordering the branches by some property
+   class BiggerValue {
+   public:
+      /// Constructor with the values to order by
+      BiggerValue( const std::vector< Long64_t >& values )
+         : m_values( values ) {}
+      /// Operator comparing the values of two branches
+      bool operator()( size_t i1, size_t i2 ) const {
+         return ( m_values[ i1 ] > m_values[ i2 ] );
+      }
+   private:
+      const std::vector< Long64_t >& m_values; ///< The values to order by
+   }; // class BiggerValue
+
+   /// Helper function checking if a branch is part of a list
+   bool IsListed( const SBranchUsage::list_type& branches,
+                  const std::string& treeName,
+                  const std::string& branchName ) {
+
+      return ( std::find( branches.begin(), branches.end(),
+                          std::make_pair( treeName, branchName ) ) !=
+               branches.end() );
+   }
+
+} // private namespace
+
+/**
+ * @param name The name of the object
+ */
+SBranchUsage::SBranchUsage( const char* name )
+   : TNamed( name, "SFrame branch usage" ), m_trees(), m_branches(),
+     m_diskBytes(), m_connections(), m_entries(), m_bytes(), m_zipBytes(),
+     m_logger( "SBranchUsage" ) {
+
+}
+
+/**
+ * The function is called for each input tree of each new input file, to
+ * record the size of all the branches of the tree. This is used to show how
+ * much data the cycle didn't have to read.
+ *
+ * @param treeName The name of the tree in the configuration
+ * @param tree The input tree from the current input file
+ */
+void SBranchUsage::AddTree( const char* treeName, TTree* tree ) {
+
+   if( ! tree ) return;
+
+   TObjArray* branches = tree->GetListOfBranches();
+   for( Int_t i = 0; i < branches->GetEntriesFast(); ++i ) {
+      TBranch* br = dynamic_cast< TBranch* >( branches->At( i ) );
+      if( ! br ) continue;
+      const size_t index = Index( treeName, br->GetName() );
+      m_diskBytes[ index ] += br->GetZipBytes( "*" );
+   }
+
+   return;
+}
+
+/**
+ * The function is called for each connected branch when the processing of
+ * an input file finishes. Branches that are read by another cycle in the
+ * same event loop are recorded with zero entries.
+ *
+ * @param treeName The name of the tree in the configuration
+ * @param branchName The name of the connected branch
+ * @param entries The number of entries read from the branch
+ * @param bytes The number of uncompressed bytes read from the branch
+ * @param zipBytes The estimated number of compressed bytes read
+ */
+void SBranchUsage::AddRead( const char* treeName, const char* branchName,
+                            Long64_t entries, Long64_t bytes,
+                            Long64_t zipBytes ) {
+
+   const size_t index = Index( treeName, branchName );
+   m_connections[ index ] += 1;
+   m_entries[ index ] += entries;
+   m_bytes[ index ] += bytes;
+   m_zipBytes[ index ] += zipBytes;
+
+   return;
+}
+
+/**
+ * @param branches The (tree name, branch name) pairs of all the branches
+ *                 that the cycle connected to (output)
+ */
+void SBranchUsage::GetConnectedBranches( list_type& branches ) const {
+
+   branches.clear();
+   for( size_t i = 0; i < m_branches.size(); ++i ) {
+      if( m_connections[ i ] ) {
+         branches.push_back( std::make_pair( m_trees[ i ], m_branches[ i ] ) );
+      }
+   }
+
+   return;
+}
+
+/**
+ * The report lists the connected branches in the order of the amount of data
+ * read from them, the biggest branches that were not read, and compares the
+ * connected branches to the branch list that the cycle was configured with.
+ * (If any.) Listed branches that the cycle didn't connect to could be
+ * removed from the list, and connected branches missing from the list make
+ * the list out of date.
+ *
+ * @param type The message level to print the report with
+ * @param branchList The branch list that the cycle was configured with
+ */
+void SBranchUsage::PrintReport( SMsgType type,
+                                const list_type& branchList ) const {
+
+   // Sort the branches into connected and not connected ones:
+   std::vector< size_t > connected, unread;
+   Long64_t totalBytes = 0, totalZipBytes = 0, unreadBytes = 0;
+   for( size_t i = 0; i < m_branches.size(); ++i ) {
+      if( m_connections[ i ] ) {
+         connected.push_back( i );
+         totalBytes += m_bytes[ i ];
+         totalZipBytes += m_zipBytes[ i ];
+      } else {
+         unread.push_back( i );
+         unreadBytes += m_diskBytes[ i ];
+      }
+   }
+   std::sort( connected.begin(), connected.end(), BiggerValue( m_bytes ) );
+   std::sort( unread.begin(), unread.end(), BiggerValue( m_diskBytes ) );
+
+   m_logger.setf( std::ios::fixed );
+   m_logger << type << "Read " << std::setprecision( 2 )
+            << ( totalBytes / 1048576.0 ) << " MB (~"
+            << ( totalZipBytes / 1048576.0 ) << " MB compressed) from "
+            << connected.size() << " connected branch(es):"
+            << SLogger::endmsg;
+   for( size_t i = 0; i < connected.size(); ++i ) {
+      const size_t index = connected[ i ];
+      m_logger << type << std::setw( 10 ) << std::setprecision( 2 )
+               << ( m_bytes[ index ] / 1048576.0 ) << " MB "
+               << std::setw( 12 ) << m_entries[ index ] << " entries  "
+               << m_trees[ index ] << "/" << m_branches[ index ];
+      if( ! m_entries[ index ] ) {
+         m_logger << " (read by another cycle)";
+      }
+      m_logger << SLogger::endmsg;
+   }
+
+   m_logger << type << "Not read: " << unread.size() << " branch(es) of "
+            << std::setprecision( 2 ) << ( unreadBytes / 1048576.0 )
+            << " MB (compressed), the biggest ones being:" << SLogger::endmsg;
+   for( size_t i = 0; ( i < 10 ) && ( i < unread.size() ); ++i ) {
+      const size_t index = unread[ i ];
+      m_logger << type << std::setw( 10 ) << std::setprecision( 2 )
+               << ( m_diskBytes[ index ] / 1048576.0 ) << " MB  "
+               << m_trees[ index ] << "/" << m_branches[ index ]
+               << SLogger::endmsg;
+   }
+
+   // Compare the connections to the configured branch list:
+   if( branchList.empty() ) return;
+   list_type::const_iterator itr = branchList.begin();
+   list_type::const_iterator end = branchList.end();
+   for( ; itr != end; ++itr ) {
+      bool used = false;
+      for( size_t i = 0; i < connected.size(); ++i ) {
+         if( ( m_trees[ connected[ i ] ] == itr->first ) &&
+             ( m_branches[ connected[ i ] ] == itr->second ) ) {
+            used = true;
+            break;
+         }
+      }
+      if( ! used ) {
+         m_logger << type << "Listed branch never connected: " << itr->first
+                  << "/" << itr->second << SLogger::endmsg;
+      }
+   }
+   for( size_t i = 0; i < connected.size(); ++i ) {
+      const size_t index = connected[ i ];
+      if( ! IsListed( branchList, m_trees[ index ], m_branches[ index ] ) ) {
+         m_logger << WARNING << "Connected branch missing from the branch "
+                  << "list: " << m_trees[ index ] << "/" << m_branches[ index ]
+                  << SLogger::endmsg;
+      }
+   }
+
+   return;
+}
+
+/**
+ * The file holds one "tree name, branch name" pair per line. It can be given
+ * to the cycle with the BranchList option in later jobs, to only read the
+ * listed branches.
+ *
+ * @param fileName The name of the file to write
+ * @returns <code>kTRUE</code> if the file was written successfully,
+ *          <code>kFALSE</code> otherwise
+ */
+Bool_t SBranchUsage::WriteBranchList( const TString& fileName ) const {
+
+   TString path( fileName );
+   gSystem->ExpandPathName( path );
+   std::ofstream out( path.Data(), std::ios::trunc );
+   if( ! out.is_open() ) {
+      REPORT_ERROR( "Couldn't write branch list file: " << path );
+      return kFALSE;
+   }
+
+   list_type branches;
+   GetConnectedBranches( branches );
+   out << "# Branches connected by cycle: " << GetTitle() << std::endl;
+   out << "# <tree name> <branch name>" << std::endl;
+   list_type::const_iterator itr = branches.begin();
+   list_type::const_iterator end = branches.end();
+   for( ; itr != end; ++itr ) {
+      out << itr->first << " " << itr->second << std::endl;
+   }
+
+   m_logger << INFO << "List of " << branches.size() << " connected "
+            << "branch(es) written to: " << path << SLogger::endmsg;
+   return kTRUE;
+}
+
+/**
+ * Empty lines, and lines starting with '#' are ignored in the file.
+ *
+ * @param fileName The name of the file to read
+ * @param branches The (tree name, branch name) pairs read from the file
+ *                 (output)
+ * @returns <code>kTRUE</code> if the file could be read,
+ *          <code>kFALSE</code> otherwise
+ */
+Bool_t SBranchUsage::ReadBranchList( const TString& fileName,
+                                     list_type& branches ) {
+
+   TString path( fileName );
+   gSystem->ExpandPathName( path );
+   std::ifstream in( path.Data() );
+   if( ! in.is_open() ) return kFALSE;
+
+   branches.clear();
+   std::string line;
+   while( std::getline( in, line ) ) {
+      std::istringstream words( line );
+      std::string treeName, branchName;
+      if( ! ( words >> treeName >> branchName ) ) continue;
+      if( treeName[ 0 ] == '#' ) continue;
+      branches.push_back( std::make_pair( treeName, branchName ) );
+   }
+
+   return kTRUE;
+}
+
+/**
+ * The information about the same branches is added up.
+ *
+ * @param coll The collection of objects to merge into this one
+ * @returns Zero if some problem happened, something else if everything was okay
+ */
+Int_t SBranchUsage::Merge( TCollection* coll ) {
+
+   //
+   // Return right away if the input is flawed:
+   //
+   if( ! coll ) return 0;
+   if( coll->IsEmpty() ) return 0;
+
+   TIter next( coll );
+   TObject* obj = 0;
+   while( ( obj = next() ) ) {
+
+      SBranchUsage* uobj = dynamic_cast< SBranchUsage* >( obj );
+      if( ! uobj ) {
+         REPORT_ERROR( "Trying to merge \"" << obj->ClassName()
+                       << "\" object into \"" << this->ClassName() << "\"" );
+         continue;
+      }
+
+      for( size_t i = 0; i < uobj->m_branches.size(); ++i ) {
+         const size_t index = Index( uobj->m_trees[ i ],
+                                     uobj->m_branches[ i ] );
+         m_diskBytes[ index ] += uobj->m_diskBytes[ i ];
+         m_connections[ index ] += uobj->m_connections[ i ];
+         m_entries[ index ] += uobj->m_entries[ i ];
+         m_bytes[ index ] += uobj->m_bytes[ i ];
+         m_zipBytes[ index ] += uobj->m_zipBytes[ i ];
+      }
+   }
+
+   return 1;
+}
+
+/**
+ * @param treeName The name of the tree
+ * @param branchName The name of the branch
+ * @returns The index of the branch in the member vectors
+ */
+size_t SBranchUsage::Index( const std::string& treeName,
+                            const std::string& branchName ) {
+
+   for( size_t i = 0; i < m_branches.size(); ++i ) {
+      if( ( m_branches[ i ] == branchName ) && ( m_trees[ i ] == treeName ) ) {
+         return i;
+      }
+   }
+
+   m_trees.push_back( treeName );
+   m_branches.push_back( branchName );
+   m_diskBytes.push_back( 0 );
+   m_connections.push_back( 0 );
+   m_entries.push_back( 0 );
+   m_bytes.push_back( 0 );
+   m_zipBytes.push_back( 0 );
+   return ( m_branches.size() - 1 );
+}
@@ -12,7 +12,9 @@
 
 // System include(s):
 #include <cstdlib>
+#include <cstdio>
 #include <sstream>
+#include <fstream>
 
 // ROOT include(s):
 #include <TString.h>
@@ -25,6 +27,8 @@
 #include "../include/SCycleBaseConfig.h"
 #include "../include/SGeneratorCut.h"
 #include "../include/STreeTypeDecoder.h"
+#include "../include/SConstants.h"
+#include "../include/SBranchUsage.h"
 
 #ifndef DOXYGEN_IGNORE
 ClassImp( SCycleBaseConfig )
@@ -79,6 +83,41 @@ namespace {
       return out;
    }
 
+   /**
+    * Cycles that don't merge their output ntuples write an index file that
+    * lists the ntuple files of the workers. This function reads the names of
+    * the files from such an index. Files given with a relative path are
+    * located relative to the index file.
+    *
+    * @param index The name of the index file
+    * @param files The names of the files listed in the index
+    * @returns <code>true</code> if the index could be read,
+    *          <code>false</code> otherwise
+    */
+   bool ReadNTupleIndex( const TString& index,
+                         std::vector< TString >& files ) {
+
+      TString path( index );
+      gSystem->ExpandPathName( path );
+      std::ifstream in( path.Data() );
+      if( ! in.is_open() ) return false;
+
+      const TString dirname = gSystem->DirName( index );
+      std::string line;
+      while( std::getline( in, line ) ) {
+         TString file( line.c_str() );
+         file = file.Strip( TString::kBoth );
+         if( file.IsNull() ) continue;
+         if( ( ! file.Contains( "://" ) ) &&
+             ( ! gSystem->IsAbsoluteFileName( file ) ) ) {
+            file = dirname + "/" + file;
+         }
+         files.push_back( file );
+      }
+
+      return true;
+   }
+
 } // private namespace
 
 /**
@@ -125,6 +164,8 @@ void SCycleBaseConfig::Initialize( TXMLNode* node ) {
             mode = SCycleConfig::LOCAL;
          else if( curAttr->GetValue() == TString( "PROOF" ) )
             mode = SCycleConfig::PROOF;
+         else if( curAttr->GetValue() == TString( "FORK" ) )
+            mode = SCycleConfig::FORK;
          else {
             m_logger << ::WARNING << "Running mode (\"" << curAttr->GetValue()
                      << "\") not recognised. Running locally!"
@@ -149,6 +190,44 @@ void SCycleBaseConfig::Initialize( TXMLNode* node ) {
          m_config.SetCacheLearnEntries( atoi( curAttr->GetValue() ) );
       } else if( curAttr->GetName() == TString( "ProcessOnlyLocal" ) ) {
          m_config.SetProcessOnlyLocal( ToBool( curAttr->GetValue() ) );
+      } else if( curAttr->GetName() == TString( "ProgressInterval" ) ) {
+         m_config.SetProgressInterval( atof( curAttr->GetValue() ) );
+      } else if( curAttr->GetName() == TString( "MemoryBudget" ) ) {
+         m_config.SetMemoryBudget( atoi( curAttr->GetValue() ) );
+      } else if( curAttr->GetName() == TString( "Checkpoint" ) ) {
+         m_config.SetCheckpoint( ToBool( curAttr->GetValue() ) );
+      } else if( curAttr->GetName() == TString( "CheckpointEvents" ) ) {
+         m_config.SetCheckpointEvents( atoi( curAttr->GetValue() ) );
+      } else if( curAttr->GetName() == TString( "MergeNTuples" ) ) {
+         m_config.SetMergeNTuples( ToBool( curAttr->GetValue() ) );
+      } else if( curAttr->GetName() == TString( "Pipeline" ) ) {
+         m_config.SetPipeline( ToBool( curAttr->GetValue() ) );
+      } else if( curAttr->GetName() == TString( "KeepIntermediate" ) ) {
+         m_config.SetKeepIntermediate( ToBool( curAttr->GetValue() ) );
+      } else if( curAttr->GetName() == TString( "SharedScan" ) ) {
+         m_config.SetSharedScan( ToBool( curAttr->GetValue() ) );
+      } else if( curAttr->GetName() == TString( "BackgroundMerge" ) ) {
+         m_config.SetBackgroundMerge( ToBool( curAttr->GetValue() ) );
+      } else if( curAttr->GetName() == TString( "BranchUsage" ) ) {
+         m_config.SetBranchUsage( curAttr->GetValue() );
+      } else if( ( curAttr->GetName() == TString( "BranchList" ) ) &&
+                 ( TString( curAttr->GetValue() ) != "" ) ) {
+         // The list is written by a previous job, so it may not exist yet:
+         const TString fileName( curAttr->GetValue() );
+         SCycleConfig::branch_type branches;
+         if( SBranchUsage::ReadBranchList( fileName, branches ) ) {
+            m_config.SetBranchListFile( fileName );
+            m_config.SetBranchList( branches );
+         } else {
+            m_logger << ::WARNING << "Couldn't read branch list file \""
+                     << fileName << "\", reading all connected branches"
+                     << SLogger::endmsg;
+         }
+         m_config.AddConfigFile( fileName );
+      } else if( curAttr->GetName() == TString( "EventListFile" ) ) {
+         m_config.SetEventListFile( curAttr->GetValue() );
+      } else if( curAttr->GetName() == TString( "UseEventList" ) ) {
+         m_config.SetUseEventList( curAttr->GetValue() );
       }
    }
 
@@ -450,6 +529,15 @@ SCycleBaseConfig::InitializeInputData( TXMLNode* node ) {
          inputData.SetSkipValid( ToBool( curAttr->GetValue() ) );
       } else if( curAttr->GetName() == TString( "SkipLookup" ) ) {
          inputData.SetSkipLookup( ToBool( curAttr->GetValue() ) );
+      } else if( curAttr->GetName() == TString( "Shard" ) ) {
+         Int_t index = 0, count = 0;
+         if( sscanf( curAttr->GetValue(), "%d/%d", &index, &count ) != 2 ) {
+            SError error( SError::SkipCycle );
+            error << "Shard specification \"" << curAttr->GetValue()
+                  << "\" not understood. It should be \"index/count\"";
+            throw error;
+         }
+         inputData.SetShard( index, count );
       }
    }
 
@@ -523,43 +611,84 @@ SCycleBaseConfig::InitializeInputData( TXMLNode* node ) {
                lumi = atof( attribute->GetValue() );
          }
 
-         REPORT_VERBOSE( "Found an input file with name \"" << fileName
-                         << "\" and lumi: " << lumi );
-         inputData.AddSFileIn( SFile( fileName, lumi ) );
+         // Expand the index of an unmerged ntuple output into its files:
+         if( fileName.EndsWith( SFrame::NTupleIndexExtension ) ) {
+            std::vector< TString > files;
+            if( ( ! ReadNTupleIndex( fileName, files ) ) || files.empty() ) {
+               REPORT_ERROR( "Couldn't read ntuple index file: " << fileName );
+               SError error( SError::SkipCycle );
+               error << "Couldn't read ntuple index file: " << fileName;
+               throw error;
+            }
+            m_config.AddConfigFile( fileName );
+            REPORT_VERBOSE( "Found an ntuple index with name \"" << fileName
+                            << "\", listing " << files.size() << " file(s)" );
+            for( std::vector< TString >::const_iterator file = files.begin();
+                 file != files.end(); ++file ) {
+               inputData.AddSFileIn( SFile( *file, lumi / files.size() ) );
+            }
+         } else {
+            REPORT_VERBOSE( "Found an input file with name \"" << fileName
+                            << "\" and lumi: " << lumi );
+            inputData.AddSFileIn( SFile( fileName, lumi ) );
+         }
 
       }
       // get a "regular" input tree
       else if( child->GetNodeName() == TString( "InputTree" ) ) {
 
-         TString treeName = "";
+         STree tree( "", ( STree::INPUT_TREE | STree::EVENT_TREE ) );
          attribute = 0;
          while( ( attribute =
                   dynamic_cast< TXMLAttr* >( attributes() ) ) != 0 ) {
             if( attribute->GetName() == TString( "Name" ) )
-               treeName = attribute->GetValue();
+               tree.treeName = attribute->GetValue();
+            if( attribute->GetName() == TString( "File" ) )
+               tree.fileName = attribute->GetValue();
+            if( attribute->GetName() == TString( "IndexMajor" ) )
+               tree.indexMajor = attribute->GetValue();
+            if( attribute->GetName() == TString( "IndexMinor" ) )
+               tree.indexMinor = attribute->GetValue();
          }
 
-         REPORT_VERBOSE( "Found regular input tree with name: " << treeName );
-         inputData.AddTree( decoder->GetXMLCode( "InputTree" ),
-                            STree( treeName, ( STree::INPUT_TREE |
-                                               STree::EVENT_TREE ) ) );
+         REPORT_VERBOSE( "Found regular input tree with name: "
+                         << tree.treeName );
+         // Trees aligned by an index don't have one entry per event:
+         if( tree.indexMajor != "" ) {
+            tree.type = STree::INPUT_TREE;
+            REPORT_VERBOSE( "  Aligned to the events by index: "
+                            << tree.indexMajor << " " << tree.indexMinor );
+         } else if( tree.fileName != "" ) {
+            SError error( SError::SkipCycle );
+            error << "Input tree \"" << tree.treeName << "\" read from file \""
+                  << tree.fileName << "\" needs an IndexMajor attribute";
+            throw error;
+         }
+         inputData.AddTree( decoder->GetXMLCode( "InputTree" ), tree );
 
       }
       // get an output tree
       else if( child->GetNodeName() == TString( "OutputTree" ) ) {
 
-         TString treeName = "";
+         STree tree( "", ( STree::OUTPUT_TREE | STree::EVENT_TREE ) );
          attribute = 0;
          while( ( attribute =
                   dynamic_cast< TXMLAttr* >( attributes() ) ) != 0 ) {
             if( attribute->GetName() == TString( "Name" ) )
-               treeName = attribute->GetValue();
+               tree.treeName = attribute->GetValue();
+            if( attribute->GetName() == TString( "CopyBranches" ) )
+               tree.copyBranches = attribute->GetValue();
+            if( attribute->GetName() == TString( "CopyFrom" ) )
+               tree.copyFrom = attribute->GetValue();
          }
 
-         REPORT_VERBOSE( "Found regular output tree with name: " << treeName );
-         inputData.AddTree( decoder->GetXMLCode( "OutputTree" ),
-                            STree( treeName, ( STree::OUTPUT_TREE |
-                                               STree::EVENT_TREE ) ) );
+         REPORT_VERBOSE( "Found regular output tree with name: "
+                         << tree.treeName );
+         if( tree.copyBranches != "" ) {
+            REPORT_VERBOSE( "  Copying input branches: "
+                            << tree.copyBranches );
+         }
+         inputData.AddTree( decoder->GetXMLCode( "OutputTree" ), tree );
 
       }
       // get an input metadata tree
@@ -596,8 +725,8 @@ SCycleBaseConfig::InitializeInputData( TXMLNode* node ) {
       } else {
          // Unknown field notification. It's not an ERROR anymore, as this
          // function may actually find XML nodes that it doesn't recognise.
-         m_logger << ::DEBUG << "Unknown field: " << child->GetNodeName()
-                  << SLogger::endmsg;
+         SLOG( ::DEBUG ) << "Unknown field: " << child->GetNodeName()
+                         << SLogger::endmsg;
       }
       child = child->GetNextNode();
    }
@@ -634,8 +763,9 @@ void SCycleBaseConfig::InitializeUserConfig( TXMLNode* node ) {
          if( attribute->GetName() == TString( "Value" ) )
             stringValue = DecodeEnvVar( attribute->GetValue() );
       }
-      m_logger << ::DEBUG << "Found user property with name \"" << name
-               << "\" and value \"" << stringValue << "\"" << SLogger::endmsg;
+      SLOG( ::DEBUG ) << "Found user property with name \"" << name
+                      << "\" and value \"" << stringValue << "\""
+                      << SLogger::endmsg;
 
       this->SetProperty( name, stringValue );
 
@@ -12,13 +12,20 @@
 
 // ROOT include(s):
 #include <TTree.h>
+#include <TFile.h>
 #include <TSystem.h>
+#include <TEntryList.h>
 
 // Local include(s):
 #include "../include/SCycleBaseExec.h"
 #include "../include/SInputData.h"
 #include "../include/SCycleConfig.h"
 #include "../include/SCycleStatistics.h"
+#include "../include/SMetricsRecord.h"
+#include "../include/SCycleProgress.h"
+#include "../include/SMemoryAccounting.h"
+#include "../include/SBranchUsage.h"
+#include "../include/SEventList.h"
 #include "../include/SLogWriter.h"
 #include "../include/STreeType.h"
 #include "../include/SConstants.h"
@@ -27,11 +34,30 @@
 ClassImp( SCycleBaseExec )
 #endif // DOXYGEN_IGNORE
 
+namespace {
+
+   /// Name identifying the current worker process in the metrics records
+   std::string WorkerName() {
+
+      return TString::Format( "%s:%i", gSystem->HostName(),
+                              gSystem->GetPid() ).Data();
+   }
+
+} // private namespace
+
 /**
  * The constructor just initialises some member variable(s).
  */
 SCycleBaseExec::SCycleBaseExec()
-   : m_nProcessedEvents( 0 ), m_nSkippedEvents( 0 ) {
+   : m_nProcessedEvents( 0 ), m_nSkippedEvents( 0 ), m_inputTree( 0 ),
+     m_pipelineSink( 0 ), m_pipelineSource( 0 ), m_pipelineKeep( kFALSE ),
+     m_pipelineEntry( 0 ), m_sharedScan(), m_scanLeader( 0 ),
+     m_eventRecord( 0 ), m_eventCache( 0 ), m_eventSelection( 0 ),
+     m_fileName( "" ),
+     m_fileProcessedEvents( 0 ), m_fileSkippedEvents( 0 ),
+     m_fileBytesRead( 0 ), m_fileReadCalls( 0 ), m_startBytesRead( 0 ),
+     m_startBytesWritten( 0 ), m_startReadCalls( 0 ), m_progress( 0 ),
+     m_progressMonitor(), m_progressStart( 0.0 ), m_lastProgress( 0.0 ) {
 
    SetLogName( this->GetName() );
    REPORT_VERBOSE( "SCycleBaseExec constructed" );
@@ -62,6 +88,19 @@ void SCycleBaseExec::Begin( TTree* ) {
       // Let the user initialize his/her code:
       this->BeginMasterInputData( *m_inputData );
 
+      // Initialise the cycle processing the events of this one:
+      if( m_pipelineSink ) {
+         m_pipelineSink->Begin( 0 );
+      }
+      // Initialise the cycles sharing the event loop with this one:
+      std::vector< SCycleBaseExec* >::const_iterator scan_itr =
+         m_sharedScan.begin();
+      std::vector< SCycleBaseExec* >::const_iterator scan_end =
+         m_sharedScan.end();
+      for( ; scan_itr != scan_end; ++scan_itr ) {
+         ( *scan_itr )->Begin( 0 );
+      }
+
    } catch( const SError& error ) {
       REPORT_FATAL( "Exception caught with message: " << error.what() );
       throw;
@@ -94,6 +133,22 @@ void SCycleBaseExec::SlaveBegin( TTree* ) {
 
       m_outputTrees.clear();
 
+      // Collect the usage of the input branches if it was requested:
+      if( GetConfig().GetBranchUsage() != "" ) {
+         SBranchUsage* usage = new SBranchUsage( SFrame::BranchUsageName );
+         fOutput->Add( usage );
+         this->SetBranchUsage( usage );
+      }
+
+      // Record the events passing the selections of the cycle if requested:
+      m_eventRecord = 0;
+      if( GetConfig().GetEventListFile() != "" ) {
+         m_eventRecord = new SEventList( SFrame::EventListName );
+         fOutput->Add( m_eventRecord );
+      }
+      // Read the event lists that the input should be processed with:
+      this->ReadEventLists();
+
       //
       // Create the output tree(s) if necessary:
       //
@@ -105,6 +160,9 @@ void SCycleBaseExec::SlaveBegin( TTree* ) {
       // Let the user code initialize itself:
       this->BeginInputData( *m_inputData );
 
+      // Check that the booked objects fit into the memory budget:
+      this->CheckMemoryBudget();
+
    } catch( const SError& error ) {
       REPORT_FATAL( "Exception caught with message: " << error.what() );
       throw;
@@ -115,11 +173,53 @@ void SCycleBaseExec::SlaveBegin( TTree* ) {
    m_nSkippedEvents = 0;
    m_firstInit = kTRUE;
 
+   // Start collecting the job metrics:
+   m_fileName = "";
+   m_fileRecords.clear();
+   m_startBytesRead = TFile::GetFileBytesRead();
+   m_startBytesWritten = TFile::GetFileBytesWritten();
+   m_startReadCalls = TFile::GetFileReadCalls();
+   m_workerTimer.Start( kTRUE );
+
+   //
+   // Set up the progress reporting. The progress object is put into the output
+   // list, so that PROOF could send it to the client as a feedback object.
+   //
+   m_progress = new SCycleProgress( SFrame::CycleProgressName );
+   fOutput->Add( m_progress );
+   m_progressMonitor.SetInterval( GetConfig().GetProgressInterval() );
+   m_progressMonitor.Start( m_inputData->GetNEventsMax() < 0 ?
+                            m_inputData->GetEventsTotal() :
+                            m_inputData->GetNEventsMax() );
+   m_progressStart = SProgressMonitor::Now();
+   m_lastProgress = m_progressStart;
+
    // Print what just happened:
    m_logger << ::INFO << "Initialised InputData \"" << m_inputData->GetType()
             << "\" (Version:" << m_inputData->GetVersion()
             << ") on worker node" << SLogger::endmsg;
 
+   //
+   // Initialise the cycle processing the events of this one. It can only
+   // connect to the output variables of this cycle once they have been
+   // declared in BeginInputData(...).
+   //
+   if( m_pipelineSink ) {
+      m_pipelineSink->SlaveBegin( 0 );
+      m_pipelineSink->Init( 0 );
+      m_pipelineSink->Notify();
+      m_pipelineEntry = 0;
+   }
+
+   // Initialise the cycles sharing the event loop with this one:
+   std::vector< SCycleBaseExec* >::const_iterator scan_itr =
+      m_sharedScan.begin();
+   std::vector< SCycleBaseExec* >::const_iterator scan_end =
+      m_sharedScan.end();
+   for( ; scan_itr != scan_end; ++scan_itr ) {
+      ( *scan_itr )->SlaveBegin( 0 );
+   }
+
    return;
 }
 
@@ -137,6 +237,15 @@ void SCycleBaseExec::Init( TTree* main_tree ) {
    REPORT_VERBOSE( "Caching the pointer to the main input tree" );
    m_inputTree = main_tree;
 
+   // The cycles sharing the event loop with this one use the same tree:
+   std::vector< SCycleBaseExec* >::const_iterator scan_itr =
+      m_sharedScan.begin();
+   std::vector< SCycleBaseExec* >::const_iterator scan_end =
+      m_sharedScan.end();
+   for( ; scan_itr != scan_end; ++scan_itr ) {
+      ( *scan_itr )->Init( main_tree );
+   }
+
    return;
 }
 
@@ -153,21 +262,54 @@ Bool_t SCycleBaseExec::Notify() {
 
    REPORT_VERBOSE( "Accessing a new input file" );
 
+   //
+   // In a pipeline the "input file" is the set of output trees of the
+   // upstream cycle, which is only connected to once:
+   //
+   if( m_pipelineSource ) {
+      EndFileMetrics();
+      BeginFileMetrics();
+      try {
+         this->ConnectPipelineTrees( *m_inputData,
+                                     m_pipelineSource->m_outputTrees );
+         this->SetHistInputFile( 0 );
+         this->BeginInputFile( *m_inputData );
+         this->ConnectCopiedBranches( kFALSE );
+      } catch( const SError& error ) {
+         REPORT_FATAL( "Exception caught with message: " << error.what() );
+         throw;
+      }
+      return kTRUE;
+   }
+
    // Should not run the initialization when it's first called in LOCAL mode.
    // ROOT always calls Notify() twice in this mode. Note that this behavior
-   // might change in future ROOT versions...
-   if( ( GetConfig().GetRunMode() == SCycleConfig::LOCAL ) && m_firstInit ) {
+   // might change in future ROOT versions... (The cycles sharing the event
+   // loop of another cycle are only notified by that cycle when needed.)
+   if( ( GetConfig().GetRunMode() == SCycleConfig::LOCAL ) && m_firstInit &&
+       ( ! m_scanLeader ) ) {
       m_firstInit = kFALSE;
       return kTRUE;
    }
 
+   // Record the metrics of the previous file, and start with the new one:
+   EndFileMetrics();
+   BeginFileMetrics();
+
    // Connect to all objects of the input file:
    TDirectory* inputFile = 0;
    try {
 
-      this->LoadInputTrees( *m_inputData, m_inputTree, inputFile );
+      this->LoadInputTrees( *m_inputData, m_inputTree, inputFile,
+                            ( m_scanLeader != 0 ) );
+      this->BeginFileEventLists();
       this->SetHistInputFile( inputFile );
       this->BeginInputFile( *m_inputData );
+      // The input branches copied into the output trees may be used by the
+      // other cycles of the event loop as well:
+      this->ConnectCopiedBranches( ( ! m_pipelineSink ) &&
+                                   m_sharedScan.empty() &&
+                                   ( ! m_scanLeader ) );
 
    } catch( const SError& error ) {
       REPORT_FATAL( "Exception caught with message: " << error.what() );
@@ -176,14 +318,17 @@ Bool_t SCycleBaseExec::Notify() {
 
 #if ROOT_VERSION_CODE >= ROOT_VERSION( 5, 26, 0 )
    // Tell the cache to learn the access pattern for the configured number
-   // of entries:
-   if( GetConfig().GetCacheLearnEntries() > 0 ) {
+   // of entries. (When a branch list is given, the listed branches have
+   // already been added to the cache, and nothing needs to be learned.)
+   if( ( GetConfig().GetCacheLearnEntries() > 0 ) &&
+       GetConfig().GetBranchList().empty() ) {
       m_inputTree->SetCacheLearnEntries( GetConfig().GetCacheLearnEntries() );
    } else {
       // If it's set to a negative number, add all the branches to the cache.
       // Otherwise (it's 0) trust that the user already added all the necessary
       // branches inside BeginInputFile(...).
-      if( GetConfig().GetCacheLearnEntries() < 0 ) {
+      if( ( GetConfig().GetCacheLearnEntries() < 0 ) &&
+          GetConfig().GetBranchList().empty() ) {
          m_inputTree->AddBranchToCache( "*", kTRUE );
       }
       m_inputTree->StopCacheLearningPhase();
@@ -192,14 +337,27 @@ Bool_t SCycleBaseExec::Notify() {
    // According to user reports, trying to turn on TTreeCache in LOCAL mode
    // leads to hard-to-detect, but serious problems. (The results don't match
    // up with the ones acquired without using a cache.) So, for now the code
-   // doesn't try to use a cache in this case.
+   // doesn't try to use a cache in this case. (The same applies to the FORK
+   // mode, which reads the input through a TChain as well.)
    if( GetConfig().GetUseTreeCache() &&
-       ( GetConfig().GetRunMode() == SCycleConfig::LOCAL ) ) {
-      m_logger << ::WARNING << "Can't use a TTreeCache in LOCAL mode, sorry..."
-               << SLogger::endmsg;
+       ( GetConfig().GetRunMode() != SCycleConfig::PROOF ) ) {
+      m_logger << ::WARNING << "Can't use a TTreeCache in LOCAL/FORK mode, "
+               << "sorry..." << SLogger::endmsg;
    }
 #endif // ROOT_VERSION...
 
+   //
+   // Let the cycles sharing the event loop with this one connect to the new
+   // file. They can re-use the variables that this cycle connected to.
+   //
+   std::vector< SCycleBaseExec* >::const_iterator scan_itr =
+      m_sharedScan.begin();
+   std::vector< SCycleBaseExec* >::const_iterator scan_end =
+      m_sharedScan.end();
+   for( ; scan_itr != scan_end; ++scan_itr ) {
+      ( *scan_itr )->Notify();
+   }
+
    // Return gracefully:
    return kTRUE;
 }
@@ -215,11 +373,40 @@ Bool_t SCycleBaseExec::Notify() {
  */
 Bool_t SCycleBaseExec::Process( Long64_t entry ) {
 
+   // Skip the events not in the event list of the current input file, without
+   // reading anything for them:
+   if( m_eventSelection && ( ! m_eventSelection->Contains( entry ) ) ) {
+      this->FlushCopiedEvents();
+      ++m_nSkippedEvents;
+      ++m_nProcessedEvents;
+      if( ! ( m_nProcessedEvents & 0x3ff ) ) {
+         this->UpdateProgress();
+         this->CheckMemoryBudget();
+      }
+      return kTRUE;
+   }
+
    // Execute the analysis code, looking out for any thrown exceptions:
    Bool_t skipEvent = kFALSE;
    try {
 
-      this->GetEvent( entry );
+      // The cycles sharing the event loop with this one read the event
+      // together with this cycle. They copy the variables read by the other
+      // cycles before any of the cycles could modify them.
+      if( ! m_scanLeader ) {
+         this->GetEvent( entry );
+         std::vector< SCycleBaseExec* >::const_iterator scan_itr =
+            m_sharedScan.begin();
+         std::vector< SCycleBaseExec* >::const_iterator scan_end =
+            m_sharedScan.end();
+         for( ; scan_itr != scan_end; ++scan_itr ) {
+            ( *scan_itr )->GetEvent( entry );
+         }
+         for( scan_itr = m_sharedScan.begin(); scan_itr != scan_end;
+              ++scan_itr ) {
+            ( *scan_itr )->CopySharedVariables();
+         }
+      }
       m_inputData->SetEventTreeEntry( entry );
       this->ExecuteEvent( *m_inputData, this->CalculateWeight( *m_inputData,
                                                                entry ) );
@@ -236,42 +423,61 @@ Bool_t SCycleBaseExec::Process( Long64_t entry ) {
          throw;
       }
    }
+   if( m_eventRecord ) {
+      m_eventRecord->AddProcessed();
+   }
 
    // Write a new event to the output TTree(s) if the event doesn't have to be
-   // skipped:
+   // skipped. In a pipeline this is only done if the intermediate ntuple was
+   // requested explicitly.
    if( ! skipEvent ) {
-      int nbytes = 0;
-      std::vector< TTree* >::iterator tree_itr = m_outputTrees.begin();
-      std::vector< TTree* >::iterator tree_end = m_outputTrees.end();
-      for( ; tree_itr != tree_end; ++tree_itr ) {
-         nbytes = ( *tree_itr )->Fill();
-         if( nbytes < 0 ) {
-            REPORT_ERROR( "Write error occured in tree \""
-                          << ( *tree_itr )->GetName() << "\"" );
-            // Stop the execution, as this is a serious problem:
-            throw SError( "TTree write error occured",
-                          SError::StopExecution );
-         } else if( nbytes == 0 ) {
-            m_logger << ::WARNING << "No data written to tree \""
-                     << ( *tree_itr )->GetName() << "\"" << SLogger::endmsg;
+      if( ( ! m_pipelineSink ) || m_pipelineKeep ) {
+         int nbytes = 0;
+         std::vector< TTree* >::iterator tree_itr = m_outputTrees.begin();
+         std::vector< TTree* >::iterator tree_end = m_outputTrees.end();
+         for( ; tree_itr != tree_end; ++tree_itr ) {
+            // Read the input branches copied into the tree. The trees made
+            // only of copied branches may be written later on, using fast
+            // cloning.
+            if( ! this->CopyInputBranches( *tree_itr, entry ) ) continue;
+            nbytes = ( *tree_itr )->Fill();
+            if( nbytes < 0 ) {
+               REPORT_ERROR( "Write error occured in tree \""
+                             << ( *tree_itr )->GetName() << "\"" );
+               // Stop the execution, as this is a serious problem:
+               throw SError( "TTree write error occured",
+                             SError::StopExecution );
+            } else if( nbytes == 0 ) {
+               m_logger << ::WARNING << "No data written to tree \""
+                        << ( *tree_itr )->GetName() << "\"" << SLogger::endmsg;
+            }
          }
       }
+      // Let the downstream cycle process the event as well:
+      if( m_pipelineSink ) {
+         m_pipelineSink->Process( m_pipelineEntry++ );
+      }
    } else {
+      // The input file can't be fast cloned anymore:
+      this->FlushCopiedEvents();
       ++m_nSkippedEvents;
    }
 
+   // Let the cycles sharing the event loop process the event independently:
+   std::vector< SCycleBaseExec* >::const_iterator scan_itr =
+      m_sharedScan.begin();
+   std::vector< SCycleBaseExec* >::const_iterator scan_end =
+      m_sharedScan.end();
+   for( ; scan_itr != scan_end; ++scan_itr ) {
+      ( *scan_itr )->Process( entry );
+   }
+
+   // Only look at the clock every 1024 events, to keep the overhead of the
+   // progress reporting negligible:
    ++m_nProcessedEvents;
-   if( ! ( m_nProcessedEvents % 1000 ) ) {
-      // Only print these messages in local mode in INFO level. In PROOF mode
-      // they're only needed for debugging.
-      m_logger << ( GetConfig().GetRunMode() == SCycleConfig::LOCAL ? ::INFO :
-                    ::DEBUG )
-               << "Processing entry: " << entry << " ("
-               << ( m_nProcessedEvents - 1 ) << " / "
-               << ( m_inputData->GetNEventsMax() < 0 ?
-                    m_inputData->GetEventsTotal() :
-                    m_inputData->GetNEventsMax() )
-               << " events processed so far)" << SLogger::endmsg;
+   if( ! ( m_nProcessedEvents & 0x3ff ) ) {
+      this->UpdateProgress();
+      this->CheckMemoryBudget();
    }
 
    // Return gracefully:
@@ -288,6 +494,18 @@ void SCycleBaseExec::SlaveTerminate() {
 
    REPORT_VERBOSE( "Running finalization on slave" );
 
+   // Finish the cycles processing the events of this one first:
+   if( m_pipelineSink ) {
+      m_pipelineSink->SlaveTerminate();
+   }
+   std::vector< SCycleBaseExec* >::const_iterator scan_itr =
+      m_sharedScan.begin();
+   std::vector< SCycleBaseExec* >::const_iterator scan_end =
+      m_sharedScan.end();
+   for( ; scan_itr != scan_end; ++scan_itr ) {
+      ( *scan_itr )->SlaveTerminate();
+   }
+
    //
    // Tell the user cycle that the InputData has ended:
    //
@@ -298,12 +516,25 @@ void SCycleBaseExec::SlaveTerminate() {
       throw;
    }
 
+   //
+   // Report the biggest memory consumers of the worker. This has to be done
+   // before the in-file merged objects are written out.
+   //
+   SMemoryAccounting memory;
+   this->AccountHistMemory( memory );
+   this->AccountNTupleMemory( memory );
+   memory.Print( ::INFO );
+
    //
    // Write the objects that are meant to be merged in-file, into
    // the output file:
    //
    this->WriteHistObjects();
 
+   // Stop collecting the metrics:
+   EndFileMetrics();
+   m_workerTimer.Stop();
+
    //
    // Write the node statistics to the output:
    //
@@ -315,9 +546,53 @@ void SCycleBaseExec::SlaveTerminate() {
    // Close the output file:
    this->CloseOutputFile();
 
+   //
+   // Fill the resource usage of the worker into the statistics object. This
+   // is done after closing the output file, to include the bytes written
+   // during the closing.
+   //
+   const Long64_t bytesRead = TFile::GetFileBytesRead() - m_startBytesRead;
+   const Long64_t bytesWritten =
+      TFile::GetFileBytesWritten() - m_startBytesWritten;
+   const Int_t readCalls = TFile::GetFileReadCalls() - m_startReadCalls;
+   const Long64_t peakRSS = SMetricsRecord::GetPeakRSS();
+   stat->SetRealTime( m_workerTimer.RealTime() );
+   stat->SetCpuTime( m_workerTimer.CpuTime() );
+   stat->SetBytesRead( bytesRead );
+   stat->SetBytesWritten( bytesWritten );
+   stat->SetPeakRSS( peakRSS );
+
+   std::vector< std::string >::const_iterator rec_itr = m_fileRecords.begin();
+   std::vector< std::string >::const_iterator rec_end = m_fileRecords.end();
+   for( ; rec_itr != rec_end; ++rec_itr ) {
+      stat->AddRecord( *rec_itr );
+   }
+   m_fileRecords.clear();
+
+   SMetricsRecord record( "worker" );
+   record.Add( "cycle", GetName() );
+   record.Add( "inputdata", m_inputData->GetType().Data() );
+   record.Add( "version", m_inputData->GetVersion().Data() );
+   record.Add( "worker", WorkerName() );
+   record.Add( "events_processed", m_nProcessedEvents );
+   record.Add( "events_skipped", m_nSkippedEvents );
+   record.Add( "real_time", m_workerTimer.RealTime() );
+   record.Add( "cpu_time", m_workerTimer.CpuTime() );
+   record.Add( "bytes_read", bytesRead );
+   record.Add( "bytes_written", bytesWritten );
+   record.Add( "read_calls", static_cast< Long64_t >( readCalls ) );
+   record.Add( "peak_rss_kb", peakRSS );
+   stat->AddRecord( record.GetJSON() );
+
    // Reset the ntuple handling component:
    this->ClearCachedTrees();
 
+   // The recorded event lists are owned by the output list:
+   m_eventRecord = 0;
+   delete m_eventCache;
+   m_eventCache = 0;
+   m_eventSelection = 0;
+
    m_logger << ::INFO << "Terminated InputData \"" << m_inputData->GetType()
             << "\" (Version:" << m_inputData->GetVersion()
             << ") on worker node" << SLogger::endmsg;
@@ -328,14 +603,17 @@ void SCycleBaseExec::SlaveTerminate() {
 
 /**
  * This function is called by ROOT/PROOF on the master node after all events
- * have been processed. The code just calls the user's
- * <code>EndMasterInputData(...)</code> function, and doesn't do anything else
- * in addition itself.
+ * have been processed. The code just re-sets the output list of the cycle,
+ * and calls the user's <code>EndMasterInputData(...)</code> function.
  */
 void SCycleBaseExec::Terminate() {
 
    REPORT_VERBOSE( "Running finalization on the master" );
 
+   // The objects in the output list have been replaced by the merged
+   // objects in PROOF mode, so the cached object pointers have to be reset:
+   this->SetHistOutput( fOutput );
+
    try {
       this->EndMasterInputData( *m_inputData );
    } catch( const SError& error ) {
@@ -343,10 +621,113 @@ void SCycleBaseExec::Terminate() {
       throw;
    }
 
+   // Finish the cycles processing the events of this one:
+   if( m_pipelineSink ) {
+      m_pipelineSink->Terminate();
+   }
+   std::vector< SCycleBaseExec* >::const_iterator scan_itr =
+      m_sharedScan.begin();
+   std::vector< SCycleBaseExec* >::const_iterator scan_end =
+      m_sharedScan.end();
+   for( ; scan_itr != scan_end; ++scan_itr ) {
+      ( *scan_itr )->Terminate();
+   }
+
    // Return gracefully:
    return;
 }
 
+/**
+ * With this function a downstream cycle can be set up to process the events
+ * of this cycle in the same event loop, instead of reading them from the
+ * output ntuple of this cycle in a separate job. The downstream cycle gets
+ * called by this cycle for every event that this cycle didn't skip, and it
+ * sees the output variables of this cycle as its input variables.
+ *
+ * Unless the intermediate output is requested explicitly, the output trees of
+ * this cycle are not filled in this mode, so they are written out empty.
+ *
+ * @param sink The cycle that should process the events of this cycle, or a
+ *             null pointer to turn off pipelining
+ * @param keepOutput Flag specifying whether this cycle should still fill its
+ *                   output tree(s)
+ */
+void SCycleBaseExec::SetPipelineSink( SCycleBaseExec* sink,
+                                      Bool_t keepOutput ) {
+
+   if( m_pipelineSink ) {
+      m_pipelineSink->m_pipelineSource = 0;
+   }
+   m_pipelineSink = sink;
+   m_pipelineKeep = keepOutput;
+   if( m_pipelineSink ) {
+      m_pipelineSink->m_pipelineSource = this;
+   }
+
+   return;
+}
+
+/**
+ * Cycles processing the same input data can be run in a single event loop.
+ * The cycle running the event loop calls the added cycles for every event,
+ * right after processing the event itself. The added cycles connect to the
+ * same input trees, and the branches that an earlier cycle in the event loop
+ * already connected to are not read again, the variables of that cycle are
+ * used instead.
+ *
+ * Each cycle decides about skipping the events on its own, and writes its own
+ * output.
+ *
+ * @param cycle The cycle that should process the input events of this cycle
+ */
+void SCycleBaseExec::AddSharedScan( SCycleBaseExec* cycle ) {
+
+   m_sharedScan.push_back( cycle );
+   cycle->m_scanLeader = this;
+
+   return;
+}
+
+/**
+ * After this call the cycle runs its event loop on its own again.
+ */
+void SCycleBaseExec::ClearSharedScan() {
+
+   std::vector< SCycleBaseExec* >::const_iterator scan_itr =
+      m_sharedScan.begin();
+   std::vector< SCycleBaseExec* >::const_iterator scan_end =
+      m_sharedScan.end();
+   for( ; scan_itr != scan_end; ++scan_itr ) {
+      ( *scan_itr )->m_scanLeader = 0;
+   }
+   m_sharedScan.clear();
+
+   return;
+}
+
+/**
+ * This function can be called from <code>ExecuteEvent(...)</code> to record
+ * that the current event passed a selection of the cycle. When the
+ * EventListFile option is set for the cycle, the events of each selection are
+ * stored for each completely processed input file at the end of the cycle.
+ * Later jobs of the same cycle, with the same properties, can then process
+ * only the events passing one of the selections, by setting the UseEventList
+ * option.
+ *
+ * The function doesn't do anything if the event lists are not recorded, or
+ * if the cycle processes the events of another cycle in a pipeline.
+ *
+ * @param name The name of the selection that the event passed
+ */
+void SCycleBaseExec::RecordSelection( const char* name ) {
+
+   if( m_eventRecord ) {
+      m_eventRecord->AddEntry( name, m_inputData->GetEventTreeEntry() );
+   }
+
+   return;
+}
+
 /**
  * This function takes care of accessing the cycle configuration objects on the
  * master and worker nodes.
@@ -396,3 +777,224 @@ void SCycleBaseExec::ExecuteEvent( Int_t /*event*/, Int_t /*px*/,
    REPORT_ERROR( "This function should never get called!" );
    return;
 }
+
+/**
+ * This function reads the event lists stored by a previous job of the same
+ * cycle, if the cycle was configured to use one of them. The event lists are
+ * not used for cycles reading the events of another cycle, or sharing their
+ * event loop with other cycles, as the events would have to be read for the
+ * other cycles anyway.
+ */
+void SCycleBaseExec::ReadEventLists() {
+
+   m_eventCache = 0;
+   m_eventSelection = 0;
+
+   // Check if an event list should be used:
+   const TString& selection = GetConfig().GetUseEventList();
+   if( selection == "" ) {
+      return;
+   }
+   if( m_pipelineSource || m_scanLeader || ( ! m_sharedScan.empty() ) ) {
+      m_logger << ::WARNING << "Event lists can't be used in a pipeline or "
+               << "a shared event loop, processing all events"
+               << SLogger::endmsg;
+      return;
+   }
+
+   // Open the file with the cached event lists:
+   TString path( GetConfig().GetEventListFile() );
+   gSystem->ExpandPathName( path );
+   TFile* file = 0;
+   if( ( path != "" ) && ( ! gSystem->AccessPathName( path ) ) ) {
+      file = TFile::Open( path, "READ" );
+   }
+   if( ( ! file ) || file->IsZombie() ) {
+      m_logger << ::WARNING << "Couldn't open event list file \"" << path
+               << "\", processing all events" << SLogger::endmsg;
+      delete file;
+      return;
+   }
+
+   // Read the lists belonging to this cycle configuration:
+   const TString key = SEventList::CacheKey( GetConfig() );
+   m_eventCache = dynamic_cast< SEventList* >( file->Get( key ) );
+   if( m_eventCache ) {
+      m_logger << ::INFO << "Processing only the events passing selection \""
+               << selection << "\" for the " << m_eventCache->GetNFiles()
+               << " input file(s) with event lists" << SLogger::endmsg;
+   } else {
+      m_logger << ::INFO << "No event lists stored for the current cycle "
+               << "configuration, processing all events" << SLogger::endmsg;
+   }
+   file->Close();
+   delete file;
+
+   return;
+}
+
+/**
+ * This function is called when a new input file is opened. It tells the
+ * recorded event lists which file is being processed, and looks up the list
+ * of the events to be processed from the file. The files are identified by
+ * their UUID, so renamed or copied files still find their event lists.
+ */
+void SCycleBaseExec::BeginFileEventLists() {
+
+   m_eventSelection = 0;
+   if( ! ( m_eventRecord || m_eventCache ) ) {
+      return;
+   }
+
+   TFile* file = m_inputTree ? m_inputTree->GetCurrentFile() : 0;
+   if( ! file ) {
+      return;
+   }
+   const TString fileId = file->GetUUID().AsString();
+
+   if( m_eventRecord ) {
+      m_eventRecord->BeginFile( fileId,
+                                m_inputTree->GetTree()->GetEntries() );
+   }
+   if( m_eventCache ) {
+      m_eventSelection =
+         m_eventCache->GetList( GetConfig().GetUseEventList(), fileId );
+      if( m_eventSelection ) {
+         SLOG( ::DEBUG ) << "Processing " << m_eventSelection->GetN()
+                         << " listed event(s) of file: " << file->GetName()
+                         << SLogger::endmsg;
+      } else {
+         SLOG( ::DEBUG ) << "No event list for file " << file->GetName()
+                         << ", processing all events" << SLogger::endmsg;
+      }
+   }
+
+   return;
+}
+
+/**
+ * This function is called when a new input file is opened, to remember the
+ * state of the counters at the beginning of the file.
+ */
+void SCycleBaseExec::BeginFileMetrics() {
+
+   TFile* file = m_inputTree ? m_inputTree->GetCurrentFile() : 0;
+   m_fileName = file ? file->GetName() : "";
+   m_fileProcessedEvents = m_nProcessedEvents;
+   m_fileSkippedEvents = m_nSkippedEvents;
+   m_fileBytesRead = TFile::GetFileBytesRead();
+   m_fileReadCalls = TFile::GetFileReadCalls();
+   m_fileTimer.Start( kTRUE );
+
+   return;
+}
+
+/**
+ * This function is called when the processing of an input file finished
+ * (a new file is opened, or the event loop ended), to create the metrics
+ * record of the file.
+ *
+ * The TTreeCache of a file is deleted together with the file, before this
+ * function could look at it. So instead of the efficiency of the cache, the
+ * number of read calls and the average size of the reads are recorded. A
+ * well working cache results in few, large reads.
+ */
+void SCycleBaseExec::EndFileMetrics() {
+
+   // Check if a file is being processed at all:
+   if( m_fileName == "" ) {
+      return;
+   }
+
+   m_fileTimer.Stop();
+   const Long64_t bytesRead = TFile::GetFileBytesRead() - m_fileBytesRead;
+   const Int_t readCalls = TFile::GetFileReadCalls() - m_fileReadCalls;
+
+   SMetricsRecord record( "file" );
+   record.Add( "cycle", GetName() );
+   record.Add( "inputdata", m_inputData->GetType().Data() );
+   record.Add( "version", m_inputData->GetVersion().Data() );
+   record.Add( "worker", WorkerName() );
+   record.Add( "file", m_fileName.Data() );
+   record.Add( "events_processed",
+               m_nProcessedEvents - m_fileProcessedEvents );
+   record.Add( "events_skipped", m_nSkippedEvents - m_fileSkippedEvents );
+   record.Add( "real_time", m_fileTimer.RealTime() );
+   record.Add( "cpu_time", m_fileTimer.CpuTime() );
+   record.Add( "bytes_read", bytesRead );
+   record.Add( "read_calls", static_cast< Long64_t >( readCalls ) );
+   record.Add( "bytes_per_read", readCalls ?
+               static_cast< Double_t >( bytesRead ) / readCalls : 0.0 );
+   m_fileRecords.push_back( record.GetJSON() );
+
+   m_fileName = "";
+   return;
+}
+
+/**
+ * This function is called every 1024 processed events, but it only updates the
+ * progress object at the time interval configured for the cycle. In LOCAL
+ * mode the progress is printed right away, on PROOF it is sent to the client
+ * by PROOF as a feedback object.
+ */
+void SCycleBaseExec::UpdateProgress() {
+
+   // Check if an update is due:
+   const Double_t interval = GetConfig().GetProgressInterval();
+   if( interval <= 0.0 ) {
+      return;
+   }
+   const Double_t now = SProgressMonitor::Now();
+   if( ( now - m_lastProgress ) < interval ) {
+      return;
+   }
+   m_lastProgress = now;
+
+   // Update the progress of this worker:
+   m_progress->Update( WorkerName(), m_nProcessedEvents,
+                       now - m_progressStart );
+
+   // Report it. (Only the cycle running the event loop prints its progress.)
+   if( ( GetConfig().GetRunMode() == SCycleConfig::LOCAL ) &&
+       ( ! m_pipelineSource ) && ( ! m_scanLeader ) ) {
+      m_progressMonitor.Update( *m_progress, kTRUE );
+   } else {
+      SLOG( ::DEBUG ) << "Processed " << m_nProcessedEvents
+                      << " events so far" << SLogger::endmsg;
+   }
+
+   return;
+}
+
+/**
+ * This function checks whether the resident memory of the worker process is
+ * below the budget configured for the cycle. If it is not, it prints the
+ * biggest memory consumers, and stops the processing. This way the user gets
+ * a clear error message, instead of the worker being killed by the system.
+ */
+void SCycleBaseExec::CheckMemoryBudget() {
+
+   // Check if a budget was set:
+   const Long64_t budget = GetConfig().GetMemoryBudget();
+   if( budget <= 0 ) {
+      return;
+   }
+
+   // Check if the worker is within its budget:
+   const Long64_t resident = SMemoryAccounting::GetResidentMemory();
+   if( resident <= budget * 1024 ) {
+      return;
+   }
+
+   // Print the biggest consumers, and stop the processing:
+   SMemoryAccounting memory;
+   this->AccountHistMemory( memory );
+   this->AccountNTupleMemory( memory );
+   memory.Print( ::ERROR );
+
+   REPORT_FATAL( "The worker uses " << ( resident / 1024 ) << " MB of memory, "
+                 << "exceeding the budget of " << budget << " MB" );
+   SError error( SError::StopExecution );
+   error << "Memory budget of " << budget << " MB exceeded";
+   throw error;
+}
@@ -11,6 +11,7 @@
  ***************************************************************************/
 
 // ROOT include(s):
+#include <TROOT.h>
 #include <TDirectory.h>
 #include <TH1.h>
 #include <TList.h>
@@ -19,6 +20,7 @@
 // Local inlcude(s):
 #include "../include/SCycleBaseHist.h"
 #include "../include/SCycleOutput.h"
+#include "../include/SMemoryAccounting.h"
 
 #ifndef DOXYGEN_IGNORE
 ClassImp( SCycleBaseHist )
@@ -28,8 +30,10 @@ ClassImp( SCycleBaseHist )
  * The constructor initialises the base class and the member variables.
  */
 SCycleBaseHist::SCycleBaseHist()
-   : SCycleBaseBase(), m_histoMap(), m_fileOutput(),
-     m_proofOutput( 0 ), m_inputFile( 0 ) {
+   : SCycleBaseBase(), m_histoMap(), m_bookedObjects(), m_bookedIndex(),
+     m_bookedNext( 0 ), m_fileOutput(), m_proofOutput( 0 ),
+     m_outputGeneration( 0 ), m_bookedObject( 0 ), m_bookedSite( 0 ),
+     m_inputFile( 0 ) {
 
    REPORT_VERBOSE( "SCycleBaseHist constructed" );
 }
@@ -38,6 +42,8 @@ void SCycleBaseHist::SetHistOutput( TSelectorList* output ) {
 
    m_proofOutput = output;
    m_histoMap.clear();
+   ForgetBookedObjects();
+   ++m_outputGeneration;
    return;
 }
 
@@ -46,6 +52,19 @@ TSelectorList* SCycleBaseHist::GetHistOutput() const {
    return m_proofOutput;
 }
 
+/**
+ * Objects that cache pointers to objects in the output list (like
+ * SSummedVar) can use this number to decide whether their cached pointers
+ * are still valid. The number changes every time a new output list is given
+ * to the cycle, or the objects in the existing list may have been replaced.
+ *
+ * @returns A number identifying the current state of the output list
+ */
+ULong_t SCycleBaseHist::GetHistOutputGeneration() const {
+
+   return m_outputGeneration;
+}
+
 /**
  * Function for writing any kind of object inheriting from TObject into
  * the output file. It is meant to be used with objects that are
@@ -150,6 +169,51 @@ TH1* SCycleBaseHist::Hist( const char* name, const char* dir ) {
    return result;
 }
 
+/**
+ * This function is used by the BOOK_CACHED macro to check whether an object
+ * was already booked from a given call site. The call sites are identified
+ * by the address of a string literal that the macro creates, so the lookup
+ * doesn't need any string operations.
+ *
+ * Since the call sites in the event loop are usually visited in the same
+ * order in every event, the function first checks the object that followed
+ * the previously found one. That makes the lookup about as fast as using a
+ * cached pointer.
+ *
+ * When the object is found, the function makes the ROOT memory directory
+ * the current one, the same way as SCycleBaseHist::Book does.
+ *
+ * @param site Unique identifier of the call site
+ * @returns The object booked from the call site, or a null pointer if none
+ *          was booked yet
+ */
+TObject* SCycleBaseHist::FindBookedAt( const char* site ) {
+
+   m_bookedSite = site;
+
+   // Check the object expected to come next:
+   if( ( m_bookedNext < m_bookedObjects.size() ) &&
+       ( m_bookedObjects[ m_bookedNext ].first == site ) ) {
+      m_bookedObject = m_bookedObjects[ m_bookedNext++ ].second;
+      gROOT->cd(); // Just like SCycleBaseHist::Book(...) would
+      return m_bookedObject;
+   }
+
+   // Look up the object in the index:
+   std::map< const char*, size_t >::const_iterator itr =
+      m_bookedIndex.find( site );
+   if( itr == m_bookedIndex.end() ) {
+      m_bookedNext = m_bookedObjects.size() + 1;
+      m_bookedObject = 0;
+      return 0;
+   }
+   m_bookedNext = itr->second + 1;
+   m_bookedObject = m_bookedObjects[ itr->second ].second;
+   gROOT->cd(); // Just like SCycleBaseHist::Book(...) would
+
+   return m_bookedObject;
+}
+
 void SCycleBaseHist::SetHistInputFile( TDirectory* file ) {
 
    m_inputFile = file;
@@ -216,6 +280,48 @@ void SCycleBaseHist::WriteHistObjects() {
       m_fileOutput.Clear();
    }
 
+   // The cached pointers may point to the removed objects now:
+   ForgetBookedObjects();
+
+   return;
+}
+
+/**
+ * The function adds all the objects to the accounting that are held in memory
+ * on the worker, both the ones merged in memory and the ones merged using the
+ * output file.
+ *
+ * @param acc The object collecting the memory usage information
+ */
+void SCycleBaseHist::AccountHistMemory( SMemoryAccounting& acc ) const {
+
+   const TList* lists[] = { m_proofOutput, &m_fileOutput };
+   for( size_t i = 0; i < 2; ++i ) {
+      if( ! lists[ i ] ) continue;
+      TIter next( lists[ i ] );
+      TObject* obj = 0;
+      while( ( obj = next() ) ) {
+         SCycleOutput* out = dynamic_cast< SCycleOutput* >( obj );
+         if( ! out ) continue;
+         acc.AddObject( ( i ? "in-file object" : "output object" ),
+                        out->GetName(), out->GetObject() );
+      }
+   }
+
+   return;
+}
+
+/**
+ * The objects cached for the BOOK_CACHED macro have to be forgotten whenever
+ * the output objects may be deleted or replaced.
+ */
+void SCycleBaseHist::ForgetBookedObjects() {
+
+   m_bookedObjects.clear();
+   m_bookedIndex.clear();
+   m_bookedNext = 0;
+   m_bookedObject = 0;
+
    return;
 }
 
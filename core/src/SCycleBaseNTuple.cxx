@@ -22,14 +22,23 @@
 #include <TTree.h>
 #include <TChain.h>
 #include <TBranch.h>
+#include <TBranchElement.h>
 #include <TROOT.h>
 #include <TList.h>
 #include <TSelectorList.h>
 #include <TFriendElement.h>
 #include <TVirtualIndex.h>
 #include <TTreeFormula.h>
+#include <TLeaf.h>
+#include <TObjArray.h>
 #include <TProofOutputFile.h>
 #include <TSystem.h>
+#include <TClass.h>
+#include <TRegexp.h>
+#include <TObjString.h>
+#if ROOT_VERSION_CODE >= ROOT_VERSION( 5, 26, 0 )
+#   include <TTreeCloner.h>
+#endif // ROOT_VERSION...
 
 // Local include(s):
 #include "../include/SCycleBaseNTuple.h"
@@ -39,16 +48,43 @@
 #include "../include/STreeType.h"
 #include "../include/SConstants.h"
 #include "../include/SOutputFile.h"
+#include "../include/SMemoryAccounting.h"
+#include "../include/SBranchUsage.h"
 
 #ifndef DOXYGEN_IGNORE
 ClassImp( SCycleBaseNTuple )
 #endif // DOXYGEN_IGNORE
 
+namespace {
+
+   /// Check if a branch name matches one of the wildcard patterns
+   bool MatchesPattern( const TString& name,
+                        const std::vector< TString >& patterns ) {
+
+      std::vector< TString >::const_iterator itr = patterns.begin();
+      std::vector< TString >::const_iterator end = patterns.end();
+      for( ; itr != end; ++itr ) {
+         Ssiz_t length = 0;
+         if( ( name.Index( TRegexp( *itr, kTRUE ), &length ) == 0 ) &&
+             ( length == name.Length() ) ) {
+            return true;
+         }
+      }
+
+      return false;
+   }
+
+} // private namespace
+
 /**
  * The constructor is only initialising the base class.
  */
 SCycleBaseNTuple::SCycleBaseNTuple()
-   : SCycleBaseBase(), m_inputTrees(), m_inputBranches(), m_inputVarPointers(),
+   : SCycleBaseBase(), m_inputTrees(), m_eventTrees(), m_inputBranches(),
+     m_indexedBranches(), m_treeFiles(), m_inputVarPointers(),
+     m_branchUsage( 0 ), m_branchUsageEntries( 0 ), m_branchReads(),
+     m_pipelined( kFALSE ), m_sharedInput( kFALSE ), m_sharedVars(),
+     m_indexedTrees(), m_treeCopies(),
      m_outputFile( 0 ),
      m_outputTrees(), m_metaInputTrees(), m_outputVarPointers(),
      m_input( 0 ), m_output( 0 ) {
@@ -63,6 +99,7 @@ SCycleBaseNTuple::SCycleBaseNTuple()
 SCycleBaseNTuple::~SCycleBaseNTuple() {
 
    DeleteInputVariables();
+   ClearTreeCopies();
    REPORT_VERBOSE( "SCycleBaseNTuple destructed" );
 }
 
@@ -346,14 +383,17 @@ TDirectory* SCycleBaseNTuple::GetOutputFile() {
       // anymore, but is being kept for backwards compatibility. To avoid using
       // conditional compilation, let's use it for now. If it gets dropped,
       // we'll have to put in some #if statements around here.
-      proofFile = new TProofOutputFile( path, "LOCAL" );
+      // When the ntuples should not be merged, the files of the workers are
+      // kept where they are, and only their list is sent back as a dataset.
+      proofFile = new TProofOutputFile( path, ( GetConfig().GetMergeNTuples() ?
+                                                "LOCAL" : "D" ) );
       proofFile->SetOutputFileName( out->GetTitle() );
       tempDirName = 0;
       m_output->Add( proofFile );
    } else {
-      m_logger << ::DEBUG
-               << "No PROOF output file specified in configuration -> "
-               << "Running in LOCAL mode" << SLogger::endmsg;
+      SLOG( ::DEBUG )
+         << "No PROOF output file specified in configuration -> "
+         << "Running in LOCAL mode" << SLogger::endmsg;
       proofFile = 0;
       // Use a more or less POSIX method for creating a unique file name:
       tempDirName = new char[ 300 ];
@@ -387,8 +427,8 @@ TDirectory* SCycleBaseNTuple::GetOutputFile() {
          m_logger << ::WARNING << "Saving the ntuples to memory"
                   << SLogger::endmsg;
       } else {
-         m_logger << ::DEBUG << "PROOF temp file opened with name: "
-                  << m_outputFile->GetName() << SLogger::endmsg;
+         SLOG( ::DEBUG ) << "PROOF temp file opened with name: "
+                         << m_outputFile->GetName() << SLogger::endmsg;
       }
    } else {
       if( ! tempDirName ) {
@@ -409,9 +449,9 @@ TDirectory* SCycleBaseNTuple::GetOutputFile() {
          m_logger << ::WARNING << "Saving the ntuples to memory"
                   << SLogger::endmsg;
       } else {
-         m_logger << ::DEBUG << "LOCAL temp file opened with name: "
-                  << tempDirName << "/" << SFrame::ProofOutputFileName
-                  << SLogger::endmsg;
+         SLOG( ::DEBUG ) << "LOCAL temp file opened with name: "
+                         << tempDirName << "/" << SFrame::ProofOutputFileName
+                         << SLogger::endmsg;
       }
    }
 
@@ -431,8 +471,8 @@ void SCycleBaseNTuple::CloseOutputFile() {
    // We only need to do anything if the output file has been made:
    if( m_outputFile ) {
 
-      m_logger << ::DEBUG << "Closing output file: " << m_outputFile->GetName()
-               << SLogger::endmsg;
+      SLOG( ::DEBUG ) << "Closing output file: " << m_outputFile->GetName()
+                      << SLogger::endmsg;
 
       // Save all the output trees into the output file. Memory-kept TTrees
       // don't need this.
@@ -478,9 +518,14 @@ CreateOutputTrees( const SInputData& iD,
    // Clear the vector of output variable pointers:
    m_outputVarPointers.clear();
 
+   // Forget about the branches copied in the previous input data:
+   ClearTreeCopies();
+
    // Access all the regular output trees:
    const std::vector< STree >* sOutTree =
       iD.GetTrees( STreeType::OutputSimpleTree );
+   const std::vector< STree >* sInTree =
+      iD.GetTrees( STreeType::InputSimpleTree );
 
    // Make sure we're in a generic directory as a start:
    gROOT->cd();
@@ -519,9 +564,9 @@ CreateOutputTrees( const SInputData& iD,
             delete array;
          }
 
-         m_logger << ::DEBUG << "Creating output event tree with name: "
-                  << tname << " in directory: \"" << dirname << "\""
-                  << SLogger::endmsg;
+         SLOG( ::DEBUG ) << "Creating output event tree with name: "
+                         << tname << " in directory: \"" << dirname << "\""
+                         << SLogger::endmsg;
 
          // Create the output TTree:
          TTree* tree = new TTree( tname,
@@ -547,6 +592,42 @@ CreateOutputTrees( const SInputData& iD,
             REPORT_VERBOSE( "Keeping TTree \"" << tname
                             << "\" in memory" );
          }
+
+         //
+         // Remember which input branches should be copied into the tree. The
+         // branches themselves are only created once the first input file is
+         // opened.
+         //
+         if( st->copyBranches != "" ) {
+            TreeCopy copy;
+            copy.output = tree;
+            copy.source = st->copyFrom;
+            if( ( copy.source == "" ) && sInTree && sInTree->size() ) {
+               copy.source = sInTree->front().treeName;
+            }
+            if( copy.source == "" ) {
+               SError error( SError::SkipInputData );
+               error << "No input tree to copy the branches of output tree "
+                     << tname << " from";
+               throw error;
+            }
+            // The input trees know only their name, not their directory:
+            if( copy.source.Contains( "/" ) ) {
+               copy.source.Remove( 0, copy.source.Last( '/' ) + 1 );
+            }
+            TObjArray* array = st->copyBranches.Tokenize( " ," );
+            for( Int_t i = 0; i < array->GetEntriesFast(); ++i ) {
+               TObjString* pattern =
+                  dynamic_cast< TObjString* >( array->At( i ) );
+               if( pattern ) copy.patterns.push_back( pattern->GetString() );
+            }
+            delete array;
+            copy.input = 0;
+            copy.deferred = kFALSE;
+            copy.firstEntry = 0;
+            copy.nEntries = 0;
+            m_treeCopies.push_back( copy );
+         }
       }
    }
 
@@ -585,9 +666,9 @@ CreateOutputTrees( const SInputData& iD,
             delete array;
          }
 
-         m_logger << ::DEBUG << "Creating output metadata tree with name: "
-                  << tname  << " in directory: \"" << dirname << "\""
-                  << SLogger::endmsg;
+         SLOG( ::DEBUG ) << "Creating output metadata tree with name: "
+                         << tname  << " in directory: \"" << dirname << "\""
+                         << SLogger::endmsg;
 
          // Create the metadata tree:
          TTree* tree = new TTree( tname, TString( "Format: User" ) +
@@ -625,6 +706,9 @@ CreateOutputTrees( const SInputData& iD,
  */
 void SCycleBaseNTuple::SaveOutputTrees() {
 
+   // Write the events that were held back for fast cloning:
+   FlushCopiedEvents();
+
    // Remember which directory we were in:
    TDirectory* savedir = gDirectory;
 
@@ -667,6 +751,9 @@ void SCycleBaseNTuple::SaveOutputTrees() {
       delete ( *tree );
    }
 
+   // The output trees don't exist anymore:
+   ClearTreeCopies();
+
    // Go back to the original directory:
    gDirectory = savedir;
 
@@ -683,11 +770,14 @@ void SCycleBaseNTuple::SaveOutputTrees() {
  * @param iD       The input data that we're handling at the moment
  * @param main_tree Pointer to the main input TTree
  * @param inputFile Pointer to the input file created by the function (output)
+ * @param shared    Flag showing that other cycles read the same input trees
+ *                  in the same event loop
  */
 void SCycleBaseNTuple::
 LoadInputTrees( const SInputData& iD,
                 TTree* main_tree,
-                TDirectory*& inputFile ) {
+                TDirectory*& inputFile,
+                Bool_t shared ) {
 
    REPORT_VERBOSE( "Loading/accessing the event-level input trees" );
 
@@ -700,19 +790,27 @@ LoadInputTrees( const SInputData& iD,
       iD.GetTrees( STreeType::InputMetaTree );
    Bool_t firstPassed = kFALSE;
    Long64_t nEvents = 0;
+   FlushBranchUsage();
    m_inputTrees.clear();
+   m_eventTrees.clear();
    m_inputBranches.clear();
+   m_indexedBranches.clear();
+   m_indexedTrees.clear();
    DeleteInputVariables();
    m_metaInputTrees.clear();
+   m_pipelined = kFALSE;
+   m_sharedInput = shared;
+   m_sharedVars.clear();
 
    //
    // Access the physical file that is currently being opened:
    //
    inputFile = 0;
-   if( GetConfig().GetRunMode() == SCycleConfig::LOCAL ) {
+   if( ( GetConfig().GetRunMode() == SCycleConfig::LOCAL ) ||
+       ( GetConfig().GetRunMode() == SCycleConfig::FORK ) ) {
       TChain* chain = dynamic_cast< TChain* >( main_tree );
       if( ! chain ) {
-         throw SError( "In LOCAL running the input TTree is not a TChain!",
+         throw SError( "In LOCAL/FORK running the input TTree is not a TChain!",
                        SError::StopExecution );
       }
       inputFile = chain->GetFile();
@@ -731,6 +829,7 @@ LoadInputTrees( const SInputData& iD,
    //
    // Handle the regular input trees:
    //
+   std::vector< std::pair< TTree*, const STree* > > indexedTrees;
    if( sInTree ) {
       std::vector< STree >::const_iterator st_itr = sInTree->begin();
       std::vector< STree >::const_iterator st_end = sInTree->end();
@@ -738,12 +837,17 @@ LoadInputTrees( const SInputData& iD,
 
          REPORT_VERBOSE( "Now trying to access TTree: " << st_itr->treeName );
 
+         // Trees with derived variables may be read from their own file:
+         TDirectory* treeFile = inputFile;
+         if( st_itr->fileName != "" ) {
+            treeFile = OpenTreeFile( st_itr->fileName );
+         }
          TTree* tree =
-            dynamic_cast< TTree* >( inputFile->Get( st_itr->treeName ) );
+            dynamic_cast< TTree* >( treeFile->Get( st_itr->treeName ) );
          if( ! tree ) {
             SError error( SError::SkipFile );
             error << "Tree " << st_itr->treeName << " doesn't exist in File "
-                  << inputFile->GetName();
+                  << treeFile->GetName();
             throw error;
          }
 
@@ -764,18 +868,40 @@ LoadInputTrees( const SInputData& iD,
                fe = 0;
             }
          }
-         // Delete index if any, for better performance
-         bool deleteIndex = true; // can be made configurable
+         // Delete index if any, for better performance. (The trees aligned
+         // to the events by an index need it of course.)
+         bool deleteIndex = ( st_itr->indexMajor == "" );
          if( deleteIndex ) {
             if( tree->GetTreeIndex() ) {
-               m_logger << ::DEBUG << "Delete index from tree "
-                        << tree->GetName() << SLogger::endmsg;
+               SLOG( ::DEBUG ) << "Delete index from tree "
+                               << tree->GetName() << SLogger::endmsg;
                tree->SetTreeIndex( 0 );
                delete tree->GetTreeIndex();
             }
          }
 
+         // Remember the size of the tree. (The trees in their own files would
+         // be counted again for every input file.)
+         if( m_branchUsage && ( st_itr->fileName == "" ) ) {
+            m_branchUsage->AddTree( tree->GetName(), tree );
+         }
          m_inputTrees.push_back( tree );
+
+         // The trees aligned by an index are set up once the main tree is
+         // known:
+         if( st_itr->indexMajor != "" ) {
+            indexedTrees.push_back( std::make_pair( tree, &*st_itr ) );
+            continue;
+         }
+
+         // Only read the branches listed in the configuration. (The cycles
+         // sharing the input of another cycle must not touch the branch
+         // settings of that cycle.)
+         if( ( ! shared ) && GetConfig().GetBranchList().size() ) {
+            PruneInputTree( tree, iD );
+         }
+
+         m_eventTrees.push_back( tree );
          if( firstPassed && tree->GetEntries() != nEvents ) {
             SError error( SError::SkipFile );
             error << "Conflict in number of entries - Tree " << tree->GetName()
@@ -789,6 +915,20 @@ LoadInputTrees( const SInputData& iD,
       }
    }
 
+   //
+   // Set up the trees aligned to the events by an index:
+   //
+   std::vector< std::pair< TTree*, const STree* > >::const_iterator it_itr =
+      indexedTrees.begin();
+   std::vector< std::pair< TTree*, const STree* > >::const_iterator it_end =
+      indexedTrees.end();
+   for( ; it_itr != it_end; ++it_itr ) {
+      SetupIndexedTree( it_itr->first, *it_itr->second, shared );
+      if( ( ! shared ) && GetConfig().GetBranchList().size() ) {
+         PruneInputTree( it_itr->first, iD );
+      }
+   }
+
    //
    // Handle the metadata trees:
    //
@@ -811,6 +951,86 @@ LoadInputTrees( const SInputData& iD,
    return;
 }
 
+/**
+ * This function is used instead of LoadInputTrees(...) when the cycle
+ * processes the events of an upstream cycle in a pipeline. The input trees of
+ * the cycle are the output trees of the upstream cycle. They are only used to
+ * look up the variables of the upstream cycle when the user connects to them,
+ * no entries are read from them.
+ *
+ * <strong>The function is used internally by the framework!</strong>
+ *
+ * @param id    The input data that we're handling at the moment
+ * @param trees The output trees of the upstream cycle
+ */
+void SCycleBaseNTuple::
+ConnectPipelineTrees( const SInputData& id,
+                      const std::vector< TTree* >& trees ) {
+
+   REPORT_VERBOSE( "Connecting to the output trees of the upstream cycle" );
+
+   // Reset the input handling:
+   FlushBranchUsage();
+   m_inputTrees.clear();
+   m_eventTrees.clear();
+   m_inputBranches.clear();
+   m_indexedBranches.clear();
+   m_indexedTrees.clear();
+   DeleteInputVariables();
+   m_metaInputTrees.clear();
+   m_sharedVars.clear();
+   m_pipelined = kTRUE;
+   m_sharedInput = kFALSE;
+
+   // The generator cuts would need to read the input trees:
+   if( id.GetSGeneratorCuts().size() ) {
+      REPORT_ERROR( "Generator cuts can't be used in a pipeline" );
+      throw SError( "Generator cuts can't be used in a pipeline",
+                    SError::SkipInputData );
+   }
+   if( id.GetTrees( STreeType::InputMetaTree ) ) {
+      m_logger << ::WARNING << "Metadata input trees are not available in a "
+               << "pipeline" << SLogger::endmsg;
+   }
+
+   //
+   // Find the upstream tree for each of the input trees:
+   //
+   const std::vector< STree >* sInTree =
+      id.GetTrees( STreeType::InputSimpleTree );
+   if( ! sInTree ) return;
+   std::vector< STree >::const_iterator st_itr = sInTree->begin();
+   std::vector< STree >::const_iterator st_end = sInTree->end();
+   for( ; st_itr != st_end; ++st_itr ) {
+
+      // The output trees know only their name, not their directory:
+      TString tname( st_itr->treeName );
+      if( tname.Contains( "/" ) ) {
+         tname.Remove( 0, tname.Last( '/' ) + 1 );
+      }
+
+      TTree* tree = 0;
+      std::vector< TTree* >::const_iterator tree_itr = trees.begin();
+      std::vector< TTree* >::const_iterator tree_end = trees.end();
+      for( ; tree_itr != tree_end; ++tree_itr ) {
+         if( tname == ( *tree_itr )->GetName() ) {
+            tree = *tree_itr;
+            break;
+         }
+      }
+      if( ! tree ) {
+         SError error( SError::SkipInputData );
+         error << "Tree " << st_itr->treeName << " is not written by the "
+               << "upstream cycle";
+         throw error;
+      }
+
+      m_inputTrees.push_back( tree );
+   }
+
+   return;
+}
+
 /**
  * Function reading in the same entry for each of the connected branches.
  * It is called first for each new event.
@@ -821,16 +1041,74 @@ LoadInputTrees( const SInputData& iD,
  */
 void SCycleBaseNTuple::GetEvent( Long64_t entry ) {
 
-   // Tell all trees to update their cache:
-   for( std::vector< TTree* >::const_iterator it = m_inputTrees.begin();
-        it != m_inputTrees.end(); ++it ) {
-      ( *it )->LoadTree( entry );
+   // In a pipeline nothing is read from the input trees:
+   if( ! m_pipelined ) {
+
+      // Tell the event-level trees to update their cache. (ROOT/PROOF has
+      // usually loaded the entry of the main tree already.)
+      for( std::vector< TTree* >::const_iterator it = m_eventTrees.begin();
+           it != m_eventTrees.end(); ++it ) {
+         if( ( *it )->GetReadEntry() != entry ) {
+            ( *it )->LoadTree( entry );
+         }
+      }
+
+      // Load the current entry for all the regular input variables. (The
+      // branches of the index-aligned trees are read at their own entries.)
+      if( ! m_branchUsage ) {
+         for( size_t i = 0; i < m_inputBranches.size(); ++i ) {
+            if( m_indexedBranches[ i ] ) continue;
+            m_inputBranches[ i ]->GetEntry( entry );
+         }
+      } else {
+         // Count how much is read from each branch if it was requested:
+         for( size_t i = 0; i < m_inputBranches.size(); ++i ) {
+            if( m_indexedBranches[ i ] ) continue;
+            const Int_t nbytes = m_inputBranches[ i ]->GetEntry( entry );
+            if( nbytes > 0 ) m_branchReads[ i ].bytes += nbytes;
+         }
+         ++m_branchUsageEntries;
+      }
+
+      // Load the matching entries of the index-aligned trees:
+      std::vector< IndexedTree >::iterator it_itr = m_indexedTrees.begin();
+      std::vector< IndexedTree >::iterator it_end = m_indexedTrees.end();
+      for( ; it_itr != it_end; ++it_itr ) {
+         LoadIndexedTree( *it_itr, entry );
+      }
    }
 
-   // Load the current entry for all the regular input variables:
-   for( std::vector< TBranch* >::const_iterator it = m_inputBranches.begin();
-        it != m_inputBranches.end(); ++it ) {
-      ( *it )->GetEntry( entry );
+   // In a pipeline the upstream cycle has finished with the event by now, so
+   // its variables can be copied. (The cycles sharing an event loop get their
+   // copies from the cycle running the event loop instead.)
+   if( m_pipelined ) {
+      CopySharedVariables();
+   }
+
+   return;
+}
+
+/**
+ * The cycles sharing the event loop of another cycle don't read the branches
+ * that an other cycle of the event loop connected to already. They receive a
+ * copy of that cycle's variables instead. The cycle running the event loop
+ * calls this function for all the other cycles after all of them read the
+ * event, but before any of them could modify their input variables. This way
+ * all the cycles see the same input as when running on their own.
+ *
+ * <strong>The function is used internally by the framework!</strong>
+ */
+void SCycleBaseNTuple::CopySharedVariables() {
+
+   std::vector< SharedVariable >::const_iterator var_itr =
+      m_sharedVars.begin();
+   std::vector< SharedVariable >::const_iterator var_end = m_sharedVars.end();
+   for( ; var_itr != var_end; ++var_itr ) {
+      if( var_itr->copy ) {
+         ( *var_itr->copy )( var_itr->target, var_itr->source );
+      } else {
+         memcpy( var_itr->target, var_itr->source, var_itr->size );
+      }
    }
 
    return;
@@ -919,13 +1197,271 @@ Double_t SCycleBaseNTuple::CalculateWeight( const SInputData& inputData,
  */
 void SCycleBaseNTuple::ClearCachedTrees() {
 
+   FlushBranchUsage();
+   m_branchUsage = 0;
+
    m_inputTrees.clear();
+   m_eventTrees.clear();
    m_inputBranches.clear();
+   m_indexedBranches.clear();
+   m_indexedTrees.clear();
    m_outputTrees.clear();
    m_metaInputTrees.clear();
    m_metaOutputTrees.clear();
+   m_pipelined = kFALSE;
+   m_sharedInput = kFALSE;
+   m_sharedVars.clear();
 
    DeleteInputVariables();
+   ClearTreeCopies();
+
+   // Close the files opened for the input trees:
+   std::vector< TFile* >::const_iterator file_itr = m_treeFiles.begin();
+   std::vector< TFile* >::const_iterator file_end = m_treeFiles.end();
+   for( ; file_itr != file_end; ++file_itr ) {
+      delete *file_itr;
+   }
+   m_treeFiles.clear();
+
+   return;
+}
+
+/**
+ * The function accounts for the basket buffers of the output trees and of the
+ * connected input branches, and for the TTreeCache of the input trees.
+ *
+ * @param acc The object collecting the memory usage information
+ */
+void SCycleBaseNTuple::AccountNTupleMemory( SMemoryAccounting& acc ) const {
+
+   std::vector< TTree* >::const_iterator tree_itr = m_outputTrees.begin();
+   std::vector< TTree* >::const_iterator tree_end = m_outputTrees.end();
+   for( ; tree_itr != tree_end; ++tree_itr ) {
+      acc.AddTree( "output tree", *tree_itr );
+   }
+   tree_itr = m_metaOutputTrees.begin();
+   tree_end = m_metaOutputTrees.end();
+   for( ; tree_itr != tree_end; ++tree_itr ) {
+      acc.AddTree( "metadata tree", *tree_itr );
+   }
+   tree_itr = m_inputTrees.begin();
+   tree_end = m_inputTrees.end();
+   for( ; tree_itr != tree_end; ++tree_itr ) {
+      if( ( *tree_itr )->GetCacheSize() > 0 ) {
+         acc.Add( "input cache", ( *tree_itr )->GetName(),
+                  ( *tree_itr )->GetCacheSize() );
+      }
+   }
+
+   std::vector< TBranch* >::const_iterator br_itr = m_inputBranches.begin();
+   std::vector< TBranch* >::const_iterator br_end = m_inputBranches.end();
+   for( ; br_itr != br_end; ++br_itr ) {
+      acc.AddBranch( "input branch", *br_itr );
+   }
+
+   return;
+}
+
+/**
+ * The object is created by SCycleBaseExec on the worker when the cycle is
+ * configured to collect the branch usage, and is owned by the output list of
+ * the cycle. It is forgotten about in ClearCachedTrees().
+ *
+ * @param usage The object collecting the usage of the input branches
+ */
+void SCycleBaseNTuple::SetBranchUsage( SBranchUsage* usage ) {
+
+   m_branchUsage = usage;
+   return;
+}
+
+/**
+ * The input branches listed in the configuration of the output trees are
+ * copied into the output trees for all the accepted events. The output
+ * branches use the buffers of the input branches directly, so nothing needs
+ * to be copied in memory. (When the cycle connected to an input branch
+ * itself, the output branch uses the cycle's variable.) The function has to
+ * be called for each new input file, after the cycle connected to its input
+ * variables.
+ *
+ * When an output tree holds nothing but copied branches, the events are held
+ * back, and if all the events of an input file end up being accepted, the
+ * baskets of the input branches are copied into the output tree without
+ * de-compressing them. (Fast cloning.)
+ *
+ * <strong>The function is used internally by the framework!</strong>
+ *
+ * @param exclusive Flag showing that no other cycle uses the variables of
+ *                  this one. Otherwise the copied branches are read for
+ *                  every event, and the events are never held back.
+ */
+void SCycleBaseNTuple::ConnectCopiedBranches( Bool_t exclusive ) {
+
+   std::list< TreeCopy >::iterator copy = m_treeCopies.begin();
+   std::list< TreeCopy >::iterator copy_end = m_treeCopies.end();
+   for( ; copy != copy_end; ++copy ) {
+
+      // The events of the previous file should've been written already.
+      // If they were not, they can't be read anymore, so the output would
+      // silently miss them:
+      if( copy->nEntries ) {
+         SError error( SError::StopExecution );
+         error << copy->nEntries << " event(s) held back for tree \""
+               << copy->output->GetName() << "\" were not written before "
+               << "switching to a new input file";
+         throw error;
+      }
+
+      // Find the input tree to copy the branches from:
+      copy->input = 0;
+      std::vector< TTree* >::const_iterator tree_itr = m_inputTrees.begin();
+      std::vector< TTree* >::const_iterator tree_end = m_inputTrees.end();
+      for( ; tree_itr != tree_end; ++tree_itr ) {
+         if( copy->source == ( *tree_itr )->GetName() ) {
+            copy->input = *tree_itr;
+            break;
+         }
+      }
+      if( ! copy->input ) {
+         SError error( SError::SkipInputData );
+         error << "Input tree " << copy->source << " is not available for "
+               << "copying its branches into tree "
+               << copy->output->GetName();
+         throw error;
+      }
+      std::vector< IndexedTree >::const_iterator it_itr =
+         m_indexedTrees.begin();
+      std::vector< IndexedTree >::const_iterator it_end = m_indexedTrees.end();
+      for( ; it_itr != it_end; ++it_itr ) {
+         if( it_itr->tree != copy->input ) continue;
+         SError error( SError::SkipInputData );
+         error << "Branches of the index-aligned tree " << copy->source
+               << " can't be copied into tree " << copy->output->GetName();
+         throw error;
+      }
+
+      // Connect the matching branches of the new input tree. The objects
+      // created for the previous file are only deleted once the output
+      // branches don't point to them anymore.
+      std::list< CopiedBranch > previous;
+      previous.swap( copy->branches );
+      TObjArray* branches = copy->input->GetListOfBranches();
+      for( Int_t i = 0; i < branches->GetEntriesFast(); ++i ) {
+         TBranch* br = dynamic_cast< TBranch* >( branches->At( i ) );
+         if( ( ! br ) || ( ! MatchesPattern( br->GetName(),
+                                              copy->patterns ) ) ) {
+            continue;
+         }
+         ConnectCopiedBranch( *copy, br, previous );
+      }
+      // Other cycles may connect to the copied branches as well, so then
+      // they need to be read for every event:
+      std::list< CopiedBranch >::iterator br_itr = copy->branches.begin();
+      std::list< CopiedBranch >::iterator br_end = copy->branches.end();
+      for( ; ( ! exclusive ) && ( br_itr != br_end ); ++br_itr ) {
+         if( ! br_itr->read ) continue;
+         RegisterInputBranch( br_itr->input );
+         br_itr->read = kFALSE;
+      }
+      std::list< CopiedBranch >::const_iterator prev_itr = previous.begin();
+      std::list< CopiedBranch >::const_iterator prev_end = previous.end();
+      for( ; prev_itr != prev_end; ++prev_itr ) {
+         if( prev_itr->object ) {
+            prev_itr->objectClass->Destructor( prev_itr->object );
+         }
+      }
+
+      // The events can only be held back for output trees that are written
+      // to a file, and hold only copied branches. The input has to be read
+      // one file after the other, up to the end of each file, for this as
+      // well. That's only guaranteed in LOCAL mode, as the PROOF and FORK
+      // workers may stop processing a file at the end of any packet.
+      copy->deferred =
+         ( exclusive && ( ! m_pipelined ) && copy->output->GetCurrentFile() &&
+           ( GetConfig().GetRunMode() == SCycleConfig::LOCAL ) &&
+           ( copy->output->GetListOfBranches()->GetEntriesFast() ==
+             static_cast< Int_t >( copy->branches.size() ) ) );
+      copy->firstEntry = 0;
+      copy->nEntries = 0;
+
+      SLOG( ::DEBUG ) << "Copying " << copy->branches.size()
+                      << " branch(es) of tree \"" << copy->source
+                      << "\" into tree \"" << copy->output->GetName() << "\""
+                      << ( copy->deferred ? " (fast cloning possible)" : "" )
+                      << SLogger::endmsg;
+   }
+
+   return;
+}
+
+/**
+ * The function is called for each output tree before it would be filled with
+ * an accepted event. It reads the copied input branches that the cycle didn't
+ * read by itself. For the trees that may be fast cloned it only remembers
+ * the entry, and the tree must not be filled by the caller.
+ *
+ * <strong>The function is used internally by the framework!</strong>
+ *
+ * @param tree The output tree to be filled
+ * @param entry The current entry of the input trees
+ * @returns <code>kTRUE</code> if the tree should be filled now,
+ *          <code>kFALSE</code> if it's taken care of by the function
+ */
+Bool_t SCycleBaseNTuple::CopyInputBranches( TTree* tree, Long64_t entry ) {
+
+   // Find the copy description belonging to this tree:
+   std::list< TreeCopy >::iterator copy = m_treeCopies.begin();
+   std::list< TreeCopy >::iterator copy_end = m_treeCopies.end();
+   for( ; copy != copy_end; ++copy ) {
+      if( copy->output == tree ) break;
+   }
+   if( copy == copy_end ) return kTRUE;
+
+   // Hold back the event if the tree may be fast cloned. Only a continuous
+   // range of events can be held back.
+   if( copy->deferred ) {
+      if( copy->nEntries &&
+          ( entry != copy->firstEntry + copy->nEntries ) ) {
+         FlushTreeCopy( *copy );
+      } else {
+         if( ! copy->nEntries ) copy->firstEntry = entry;
+         ++copy->nEntries;
+         // Write the events when reaching the end of the input file:
+         if( entry + 1 == copy->input->GetEntries() ) {
+            if( copy->firstEntry == 0 ) {
+               FastCloneTreeCopy( *copy );
+            } else {
+               FlushTreeCopy( *copy );
+            }
+         }
+         return kFALSE;
+      }
+   }
+
+   // Read the branches not read by the cycle itself:
+   std::list< CopiedBranch >::const_iterator br_itr = copy->branches.begin();
+   std::list< CopiedBranch >::const_iterator br_end = copy->branches.end();
+   for( ; br_itr != br_end; ++br_itr ) {
+      if( br_itr->read ) br_itr->input->GetEntry( entry );
+   }
+
+   return kTRUE;
+}
+
+/**
+ * This function is called when the cycle rejects an event, and at the end of
+ * processing an input data. The events held back for the output trees are
+ * written out one by one, as the input file can't be fast cloned anymore.
+ *
+ * <strong>The function is used internally by the framework!</strong>
+ */
+void SCycleBaseNTuple::FlushCopiedEvents() {
+
+   std::list< TreeCopy >::iterator copy = m_treeCopies.begin();
+   std::list< TreeCopy >::iterator copy_end = m_treeCopies.end();
+   for( ; copy != copy_end; ++copy ) {
+      FlushTreeCopy( *copy );
+   }
 
    return;
 }
@@ -1059,16 +1595,445 @@ void SCycleBaseNTuple::RegisterInputBranch( TBranch* br ) {
    // This is a bit slow, but still not the worst part of the code...
    if( std::find( m_inputBranches.begin(), m_inputBranches.end(), br ) !=
        m_inputBranches.end() ) {
-      m_logger << ::DEBUG << "Branch '" << br->GetName()
-               << "' already registered!" << SLogger::endmsg;
+      SLOG( ::DEBUG ) << "Branch '" << br->GetName()
+                      << "' already registered!" << SLogger::endmsg;
    } else {
       m_inputBranches.push_back( br );
+      // Remember if the branch is read at the entries of an index-aligned
+      // tree:
+      Bool_t indexed = kFALSE;
+      std::vector< IndexedTree >::iterator it_itr = m_indexedTrees.begin();
+      std::vector< IndexedTree >::iterator it_end = m_indexedTrees.end();
+      for( ; it_itr != it_end; ++it_itr ) {
+         if( it_itr->tree == br->GetTree() ) {
+            it_itr->branches.push_back( m_inputBranches.size() - 1 );
+            indexed = kTRUE;
+            break;
+         }
+      }
+      m_indexedBranches.push_back( indexed );
+      if( m_branchUsage ) {
+         BranchRead read;
+         read.tree = br->GetTree()->GetName();
+         read.branch = br->GetName();
+         const Long64_t totBytes = br->GetTotBytes( "*" );
+         read.zipRatio = ( totBytes > 0 ?
+                           static_cast< Double_t >( br->GetZipBytes( "*" ) ) /
+                           static_cast< Double_t >( totBytes ) : 1.0 );
+         read.bytes = 0;
+         m_branchReads.push_back( read );
+      }
    }
 
    // Return gracefully:
    return;
 }
 
+/**
+ * When the cycle is configured with a list of branches to read, all the other
+ * branches of the input trees are disabled. This way no other code (like the
+ * TTreeCache, or a fast copy of the input tree) reads them. The listed
+ * branches are put into the TTreeCache right away, so the cache doesn't need
+ * a learning phase to find out what to pre-fetch.
+ *
+ * The branches used by the generator cuts of the input data are kept
+ * enabled as well.
+ *
+ * @param tree The input tree to prune
+ * @param id The input data that we're handling at the moment
+ */
+void SCycleBaseNTuple::PruneInputTree( TTree* tree,
+                                       const SInputData& id ) const {
+
+   tree->SetBranchStatus( "*", 0 );
+
+   // Enable the listed branches:
+   Int_t nbranches = 0;
+   SCycleConfig::branch_type::const_iterator itr =
+      GetConfig().GetBranchList().begin();
+   SCycleConfig::branch_type::const_iterator end =
+      GetConfig().GetBranchList().end();
+   for( ; itr != end; ++itr ) {
+      if( itr->first != tree->GetName() ) continue;
+      TBranch* br = tree->GetBranch( itr->second.c_str() );
+      if( ! br ) {
+         SLOG( ::DEBUG ) << "Listed branch \"" << itr->second
+                         << "\" doesn't exist in tree \"" << tree->GetName()
+                         << "\"" << SLogger::endmsg;
+         continue;
+      }
+      if( br->GetListOfBranches()->GetEntriesFast() ) {
+         tree->SetBranchStatus( ( itr->second + "*" ).c_str(), 1 );
+      } else {
+         tree->SetBranchStatus( itr->second.c_str(), 1 );
+      }
+#if ROOT_VERSION_CODE >= ROOT_VERSION( 5, 26, 0 )
+      tree->AddBranchToCache( br, kTRUE );
+#endif // ROOT_VERSION...
+      ++nbranches;
+   }
+
+   // Enable the branches used by the generator cuts:
+   std::vector< SGeneratorCut >::const_iterator gc_itr =
+      id.GetSGeneratorCuts().begin();
+   std::vector< SGeneratorCut >::const_iterator gc_end =
+      id.GetSGeneratorCuts().end();
+   for( ; gc_itr != gc_end; ++gc_itr ) {
+      if( gc_itr->GetTreeName() != tree->GetName() ) continue;
+      TTreeFormula formula( "branchList", gc_itr->GetFormula().Data(), tree );
+      for( Int_t i = 0; i < formula.GetNcodes(); ++i ) {
+         TLeaf* leaf = formula.GetLeaf( i );
+         if( leaf && leaf->GetBranch() ) {
+            tree->SetBranchStatus( leaf->GetBranch()->GetName(), 1 );
+         }
+      }
+   }
+
+   SLOG( ::DEBUG ) << "Reading " << nbranches << " listed branch(es) of "
+                   << "tree \"" << tree->GetName() << "\"" << SLogger::endmsg;
+
+   return;
+}
+
+/**
+ * Input trees with derived variables can be kept in their own file, which is
+ * then used with all the input files. The file is only opened once on a
+ * worker, and it is also re-used if another cycle reading the same events
+ * has opened it already.
+ *
+ * @param fileName The name of the file holding the input tree
+ * @returns The opened file
+ */
+TDirectory* SCycleBaseNTuple::OpenTreeFile( const TString& fileName ) {
+
+   TString path( fileName );
+   gSystem->ExpandPathName( path );
+
+   // Check if the file is open already:
+   TFile* file =
+      dynamic_cast< TFile* >( gROOT->GetListOfFiles()->FindObject( path ) );
+   if( file ) {
+      return file;
+   }
+
+   // Open it, without disturbing the current directory:
+   TDirectory* savedir = gDirectory;
+   file = TFile::Open( path, "READ" );
+   gDirectory = savedir;
+   if( ( ! file ) || file->IsZombie() ) {
+      delete file;
+      SError error( SError::SkipInputData );
+      error << "Couldn't open input tree file: " << path;
+      throw error;
+   }
+   m_treeFiles.push_back( file );
+
+   SLOG( ::DEBUG ) << "Opened input tree file: " << path << SLogger::endmsg;
+   return file;
+}
+
+/**
+ * The entries of an index-aligned tree are looked up using the major and
+ * minor keys of the events. The keys are read from the branches of the main
+ * input tree that have the same name as the index keys of the tree. An index
+ * stored with the tree is used if it was built with the right keys,
+ * otherwise the index is built when the tree is first accessed.
+ *
+ * In PROOF mode the tree gets a TTreeCache of the same size as the main
+ * input tree. (ROOT caches the baskets of each tree separately.)
+ *
+ * @param tree The index-aligned input tree
+ * @param stree The configuration of the input tree
+ * @param shared Flag showing that other cycles read the same input trees
+ */
+void SCycleBaseNTuple::SetupIndexedTree( TTree* tree, const STree& stree,
+                                         Bool_t shared ) {
+
+   // The keys of the events are read from the main input tree:
+   if( m_eventTrees.empty() ) {
+      SError error( SError::SkipInputData );
+      error << "Tree " << stree.treeName << " can only be aligned to the "
+            << "events of an input tree with one entry per event";
+      throw error;
+   }
+   TTree* mainTree = m_eventTrees.front();
+
+   IndexedTree itree;
+   itree.tree = tree;
+   itree.majorLeaf = mainTree->GetLeaf( stree.indexMajor );
+   itree.minorLeaf = ( stree.indexMinor == "" ? 0 :
+                       mainTree->GetLeaf( stree.indexMinor ) );
+   if( ( ! itree.majorLeaf ) ||
+       ( ( stree.indexMinor != "" ) && ( ! itree.minorLeaf ) ) ) {
+      SError error( SError::SkipFile );
+      error << "Index keys of tree " << stree.treeName << " (\""
+            << stree.indexMajor << "\", \"" << stree.indexMinor
+            << "\") not found in tree " << mainTree->GetName();
+      throw error;
+   }
+   itree.major = 0;
+   itree.minor = 0;
+   itree.entry = -1;
+
+   // Use the index stored with the tree if it has the right keys:
+   const TString minorName = ( stree.indexMinor == "" ? TString( "0" ) :
+                               stree.indexMinor );
+   TVirtualIndex* index = tree->GetTreeIndex();
+   if( ( ! index ) || ( stree.indexMajor != index->GetMajorName() ) ||
+       ( minorName != index->GetMinorName() ) ) {
+      if( tree->BuildIndex( stree.indexMajor, minorName ) <= 0 ) {
+         SError error( SError::SkipFile );
+         error << "Couldn't build index (\"" << stree.indexMajor << "\", \""
+               << minorName << "\") for tree " << stree.treeName;
+         throw error;
+      }
+      SLOG( ::DEBUG ) << "Built index (\"" << stree.indexMajor << "\", \""
+                      << minorName << "\") for tree " << stree.treeName
+                      << SLogger::endmsg;
+   }
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION( 5, 26, 0 )
+   // Give the tree its own cache. (The cache of the main tree is set up by
+   // PROOF.)
+   if( ( ! shared ) && GetConfig().GetUseTreeCache() &&
+       ( GetConfig().GetRunMode() == SCycleConfig::PROOF ) &&
+       ( tree->GetCacheSize() == 0 ) ) {
+      tree->SetCacheSize( GetConfig().GetCacheSize() );
+   }
+#endif // ROOT_VERSION...
+
+   m_indexedTrees.push_back( itree );
+   return;
+}
+
+/**
+ * The entry of the tree matching the keys of the current event is looked up
+ * once per event. Consecutive events often belong to the same entry of a tree
+ * with a coarser granularity (like a tree with per-run information), in
+ * which case nothing is read from the tree again. Events not found in the
+ * tree are skipped.
+ *
+ * @param itree The index-aligned tree
+ * @param entry The current entry of the main input tree
+ */
+void SCycleBaseNTuple::LoadIndexedTree( IndexedTree& itree, Long64_t entry ) {
+
+   // Read the keys of the event, unless the cycle already read them:
+   TBranch* br = itree.majorLeaf->GetBranch();
+   if( br->GetReadEntry() != entry ) {
+      br->GetEntry( entry, 1 );
+   }
+   const Long64_t major =
+      static_cast< Long64_t >( itree.majorLeaf->GetValue() );
+   Long64_t minor = 0;
+   if( itree.minorLeaf ) {
+      br = itree.minorLeaf->GetBranch();
+      if( br->GetReadEntry() != entry ) {
+         br->GetEntry( entry, 1 );
+      }
+      minor = static_cast< Long64_t >( itree.minorLeaf->GetValue() );
+   }
+
+   // Check if the right entry is loaded already:
+   if( ( itree.entry >= 0 ) && ( major == itree.major ) &&
+       ( minor == itree.minor ) ) {
+      return;
+   }
+
+   // Look up the entry:
+   itree.major = major;
+   itree.minor = minor;
+   itree.entry = itree.tree->GetEntryNumberWithIndex( major, minor );
+   if( itree.entry < 0 ) {
+      SError error( SError::SkipEvent );
+      error << "No entry with index (" << major << ", " << minor
+            << ") in tree " << itree.tree->GetName();
+      throw error;
+   }
+
+   // Read the connected branches of the tree:
+   itree.tree->LoadTree( itree.entry );
+   std::vector< size_t >::const_iterator itr = itree.branches.begin();
+   std::vector< size_t >::const_iterator end = itree.branches.end();
+   for( ; itr != end; ++itr ) {
+      const Int_t nbytes = m_inputBranches[ *itr ]->GetEntry( itree.entry );
+      if( m_branchUsage && ( nbytes > 0 ) ) {
+         m_branchReads[ *itr ].bytes += nbytes;
+      }
+   }
+
+   return;
+}
+
+/**
+ * The amount of data read from the connected branches is collected for each
+ * input file, and is added to the branch usage object when the cycle moves
+ * on to the next file. The branch objects may not exist anymore at that
+ * point, so everything needed is recorded when the branches are registered.
+ */
+void SCycleBaseNTuple::FlushBranchUsage() {
+
+   if( m_branchUsage ) {
+      std::vector< BranchRead >::const_iterator itr = m_branchReads.begin();
+      std::vector< BranchRead >::const_iterator end = m_branchReads.end();
+      for( ; itr != end; ++itr ) {
+         m_branchUsage->AddRead( itr->tree.c_str(), itr->branch.c_str(),
+                                 m_branchUsageEntries, itr->bytes,
+                                 static_cast< Long64_t >( itr->bytes *
+                                                          itr->zipRatio ) );
+      }
+   }
+   m_branchReads.clear();
+   m_branchUsageEntries = 0;
+
+   return;
+}
+
+/**
+ * In a pipeline, or for a branch that another cycle sharing the input has
+ * already connected to, the primitive input variables are not read from the
+ * input tree. They are copied from the variable of the other cycle instead.
+ * This function remembers which variable should be copied where.
+ *
+ * Since the variables are copied byte by byte, the function makes sure that
+ * the branch has a single leaf with the same (element) type as the variable,
+ * and that the other cycle's variable has exactly the same size.
+ *
+ * @param br The branch that the other cycle's variable is connected to
+ * @param variable The variable to copy the other cycle's variable into
+ * @param type_name The typeid name of the (element) type of the variable
+ * @param size The size of the variable in bytes
+ */
+void SCycleBaseNTuple::ConnectSharedVariable( TBranch* br, void* variable,
+                                              const char* type_name,
+                                              size_t size ) {
+
+   if( ! br->GetAddress() ) {
+      SError error( SError::SkipInputData );
+      error << "Branch " << br->GetName() << " of the other cycle has no "
+            << "variable connected to it";
+      throw error;
+   }
+
+   // Check that the variable matches the other cycle's one:
+   TObjArray* leaves = br->GetListOfLeaves();
+   TLeaf* leaf = ( ( leaves->GetEntriesFast() == 1 ) ?
+                   dynamic_cast< TLeaf* >( leaves->At( 0 ) ) : 0 );
+   if( ! leaf ) {
+      REPORT_ERROR( "Branch \"" << br->GetName() << "\" doesn't have a "
+                    << "single leaf, its variable can't be shared" );
+      throw SError( "Can't share the variable of branch: " +
+                    TString( br->GetName() ), SError::SkipCycle );
+   }
+   if( strcmp( type_name, TypeidType( leaf->GetTypeName() ) ) ) {
+      REPORT_ERROR( "Trying to connect a wrong type of primitive to the "
+                    << "branch: " << br->GetName() );
+      REPORT_ERROR( "  Use variable of type: " << leaf->GetTypeName() );
+      throw SError( "Wrong variable type given for branch: " +
+                    TString( br->GetName() ), SError::SkipCycle );
+   }
+   const size_t source_size =
+      static_cast< size_t >( leaf->GetLenStatic() ) * leaf->GetLenType();
+   if( size != source_size ) {
+      REPORT_ERROR( "Trying to connect a variable of " << size << " bytes "
+                    << "to the branch \"" << br->GetName() << "\" holding "
+                    << source_size << " bytes" );
+      REPORT_ERROR( "  Use a variable with " << leaf->GetLenStatic()
+                    << " element(s) of type: " << leaf->GetTypeName() );
+      throw SError( "Wrong variable size given for branch: " +
+                    TString( br->GetName() ), SError::SkipCycle );
+   }
+
+   SharedVariable var;
+   var.source = br->GetAddress();
+   var.target = variable;
+   var.size = size;
+   var.copy = 0;
+   m_sharedVars.push_back( var );
+
+   // The branch is read by the other cycle, but this one needs it as well:
+   if( m_branchUsage && ( ! m_pipelined ) ) {
+      m_branchUsage->AddRead( br->GetTree()->GetName(), br->GetName(),
+                              0, 0, 0 );
+   }
+
+   SLOG( ::DEBUG ) << "Connected to the variable of branch \""
+                   << br->GetName() << "\" of another cycle"
+                   << SLogger::endmsg;
+
+   return;
+}
+
+/**
+ * In a pipeline, or for a branch that another cycle sharing the input has
+ * already connected to, the input objects are not read from the input tree.
+ * The user gets a pointer to the object of the other cycle. This function
+ * finds that object, after making sure that it is of the type that the user
+ * expects.
+ *
+ * @param br The branch that the other cycle's object is connected to
+ * @param ti The type that the user expects
+ * @returns The object of the other cycle
+ */
+void* SCycleBaseNTuple::GetSharedObject( TBranch* br,
+                                         const std::type_info& ti ) const {
+
+   // Check that the object is of the right type:
+   TClass* cl = TClass::GetClass( ti );
+   if( ( ! cl ) || strcmp( cl->GetName(), br->GetClassName() ) ) {
+      REPORT_ERROR( "Trying to connect a wrong type of object to the "
+                    << "branch: " << br->GetName() );
+      REPORT_ERROR( "  Use a pointer of type: " << br->GetClassName() );
+      throw SError( "Wrong variable type given for branch: " +
+                    TString( br->GetName() ), SError::SkipCycle );
+   }
+
+   // The object branches store the address of the pointer to the object:
+   void** pointer = reinterpret_cast< void** >( br->GetAddress() );
+   if( ! pointer ) {
+      SError error( SError::SkipInputData );
+      error << "Branch " << br->GetName() << " of the other cycle has no "
+            << "object connected to it";
+      throw error;
+   }
+
+   // The branch is read by the other cycle, but this one needs it as well:
+   if( m_branchUsage && ( ! m_pipelined ) ) {
+      m_branchUsage->AddRead( br->GetTree()->GetName(), br->GetName(),
+                              0, 0, 0 );
+   }
+
+   return *pointer;
+}
+
+/**
+ * For a branch that another cycle sharing the input has already connected
+ * to, the cycle gets its own object, and the other cycle's object is copied
+ * into it in every event. The type of the object has to be checked with
+ * SCycleBaseNTuple::GetSharedObject before calling this function.
+ *
+ * @param br The branch that the other cycle's object is connected to
+ * @param object The object of this cycle
+ * @param copy The function copying the other cycle's object into this one's
+ */
+void SCycleBaseNTuple::ConnectSharedObject( TBranch* br, void* object,
+                                            void ( *copy )( void*,
+                                                            const void* ) ) {
+
+   SharedVariable var;
+   var.source = br->GetAddress();
+   var.target = object;
+   var.size = 0;
+   var.copy = copy;
+   m_sharedVars.push_back( var );
+
+   SLOG( ::DEBUG ) << "Connected to a copy of the object of branch \""
+                   << br->GetName() << "\" of another cycle"
+                   << SLogger::endmsg;
+
+   return;
+}
+
 /**
  * This function deletes the contents of the input variable list. Since the
  * SPointer objects in the list know exactly what kind of object they point to
@@ -1086,6 +2051,244 @@ void SCycleBaseNTuple::DeleteInputVariables() {
    return;
 }
 
+/**
+ * The output branch is created with the same type, leaf list or class, basket
+ * size and split level as the input branch, so that the baskets of the input
+ * branch could be copied into it directly. Its address is the address of the
+ * input branch. If no address was set for the input branch, a buffer/object
+ * is created for it.
+ *
+ * @param copy The description of the output tree
+ * @param br The input branch to copy
+ * @param previous The branches copied from the previous input file
+ */
+void SCycleBaseNTuple::
+ConnectCopiedBranch( TreeCopy& copy, TBranch* br,
+                     const std::list< CopiedBranch >& previous ) {
+
+   // Don't copy the same branch twice:
+   std::list< CopiedBranch >::const_iterator itr = copy.branches.begin();
+   std::list< CopiedBranch >::const_iterator end = copy.branches.end();
+   for( ; itr != end; ++itr ) {
+      if( itr->input == br ) return;
+   }
+
+   // Check whether the output branch was already created for a previous
+   // input file:
+   TBranch* existing = copy.output->GetBranch( br->GetName() );
+   if( existing ) {
+      Bool_t copied = kFALSE;
+      for( itr = previous.begin(); itr != previous.end(); ++itr ) {
+         if( itr->output == existing ) {
+            copied = kTRUE;
+            break;
+         }
+      }
+      if( ! copied ) {
+         m_logger << ::WARNING << "Not copying branch \"" << br->GetName()
+                  << "\" into tree \"" << copy.output->GetName()
+                  << "\", as the cycle declared it itself" << SLogger::endmsg;
+         return;
+      }
+   }
+
+   // Only simple branches with a single leaf, and object branches, can be
+   // copied:
+   TBranchElement* element = dynamic_cast< TBranchElement* >( br );
+   TLeaf* leaf = 0;
+   if( ! element ) {
+      if( br->GetListOfLeaves()->GetEntriesFast() != 1 ) {
+         m_logger << ::WARNING << "Branch \"" << br->GetName() << "\" has "
+                  << "multiple leaves, it can't be copied" << SLogger::endmsg;
+         return;
+      }
+      leaf = dynamic_cast< TLeaf* >( br->GetListOfLeaves()->At( 0 ) );
+      // The size of a variable-size array has to be copied first:
+      if( leaf && leaf->GetLeafCount() && leaf->GetLeafCount()->GetBranch() ) {
+         ConnectCopiedBranch( copy, leaf->GetLeafCount()->GetBranch(),
+                              previous );
+      }
+   }
+
+   // Make sure that the branch is read, even if it was pruned:
+   if( ! copy.input->GetBranchStatus( br->GetName() ) ) {
+      if( br->GetListOfBranches()->GetEntriesFast() ) {
+         copy.input->SetBranchStatus( TString( br->GetName() ) + "*", 1 );
+      } else {
+         copy.input->SetBranchStatus( br->GetName(), 1 );
+      }
+#if ROOT_VERSION_CODE >= ROOT_VERSION( 5, 26, 0 )
+      copy.input->AddBranchToCache( br, kTRUE );
+#endif // ROOT_VERSION...
+   }
+
+   CopiedBranch cbranch;
+   cbranch.input = br;
+   cbranch.output = 0;
+   cbranch.read = ( ( ! m_pipelined ) &&
+                    ( std::find( m_inputBranches.begin(),
+                                 m_inputBranches.end(), br ) ==
+                      m_inputBranches.end() ) );
+   cbranch.object = 0;
+   cbranch.objectClass = 0;
+   copy.branches.push_back( cbranch );
+   CopiedBranch& copied = copy.branches.back();
+
+   // Find/create the buffer that the input branch is read into:
+   void* address = br->GetAddress();
+   if( ( ! address ) && element ) {
+      copied.objectClass = TClass::GetClass( element->GetClassName() );
+      if( ! copied.objectClass ) {
+         REPORT_ERROR( "No dictionary found for class \""
+                       << element->GetClassName() << "\" of branch: "
+                       << br->GetName() );
+         copy.branches.pop_back();
+         return;
+      }
+      copied.object = copied.objectClass->New();
+      address = &copied.object;
+      br->SetAddress( address );
+   } else if( ! address ) {
+      Int_t length = leaf->GetLenStatic();
+      if( leaf->GetLeafCount() ) {
+         length *= ( leaf->GetLeafCount()->GetMaximum() + 1 );
+      }
+      copied.buffer.resize( length * leaf->GetLenType() + 1 );
+      address = &copied.buffer[ 0 ];
+      br->SetAddress( address );
+   }
+
+   // Connect/create the output branch:
+   if( existing ) {
+      existing->SetAddress( address );
+      copied.output = existing;
+   } else if( element ) {
+      copied.output = copy.output->Branch( br->GetName(),
+                                           element->GetClassName(), address,
+                                           br->GetBasketSize(),
+                                           element->GetSplitLevel() );
+   } else {
+      copied.output = copy.output->Branch( br->GetName(), address,
+                                           br->GetTitle(),
+                                           br->GetBasketSize() );
+   }
+   if( ! copied.output ) {
+      REPORT_ERROR( "Couldn't copy branch \"" << br->GetName()
+                    << "\" into tree: " << copy.output->GetName() );
+      if( copied.object ) copied.objectClass->Destructor( copied.object );
+      copy.branches.pop_back();
+      return;
+   }
+
+   REPORT_VERBOSE( "Copying branch \"" << br->GetName() << "\" into tree: "
+                   << copy.output->GetName() );
+
+   return;
+}
+
+/**
+ * The held back events are read from the input tree, and are written into
+ * the output tree one by one. The events of the current input file are not
+ * held back anymore after this.
+ *
+ * The copied input branches may be used by the cycle(s) as well, so they are
+ * re-read for the entry that they held before the function was called.
+ *
+ * @param copy The description of the output tree
+ */
+void SCycleBaseNTuple::FlushTreeCopy( TreeCopy& copy ) {
+
+   copy.deferred = kFALSE;
+   if( ! copy.nEntries ) return;
+
+   // Remember which entry the branches hold at the moment:
+   std::vector< Long64_t > current;
+   std::list< CopiedBranch >::const_iterator itr = copy.branches.begin();
+   std::list< CopiedBranch >::const_iterator end = copy.branches.end();
+   for( ; itr != end; ++itr ) {
+      current.push_back( itr->input->GetReadEntry() );
+   }
+
+   // Write the held back events:
+   for( Long64_t entry = copy.firstEntry;
+        entry < copy.firstEntry + copy.nEntries; ++entry ) {
+      for( itr = copy.branches.begin(); itr != end; ++itr ) {
+         itr->input->GetEntry( entry );
+      }
+      if( copy.output->Fill() < 0 ) {
+         REPORT_ERROR( "Write error occured in tree \""
+                       << copy.output->GetName() << "\"" );
+         throw SError( "TTree write error occured", SError::StopExecution );
+      }
+   }
+   SLOG( ::DEBUG ) << "Written " << copy.nEntries << " held back event(s) "
+                   << "into tree \"" << copy.output->GetName() << "\""
+                   << SLogger::endmsg;
+   copy.nEntries = 0;
+
+   // Restore the contents of the branches:
+   size_t index = 0;
+   for( itr = copy.branches.begin(); itr != end; ++itr, ++index ) {
+      if( current[ index ] >= 0 ) itr->input->GetEntry( current[ index ] );
+   }
+
+   return;
+}
+
+/**
+ * All the events of the input file were accepted, so the baskets of the
+ * copied input branches are copied into the output tree as they are. If
+ * that's not possible, for instance because the output branches ended up
+ * with a different layout than the input ones, the events are written one by
+ * one instead.
+ *
+ * @param copy The description of the output tree
+ */
+void SCycleBaseNTuple::FastCloneTreeCopy( TreeCopy& copy ) {
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION( 5, 26, 0 )
+   TTreeCloner cloner( copy.input, copy.output, "fast",
+                       TTreeCloner::kIgnoreMissingTopLevel );
+   if( cloner.IsValid() ) {
+      copy.output->SetEntries( copy.output->GetEntries() +
+                               copy.input->GetEntries() );
+      cloner.Exec();
+      SLOG( ::DEBUG ) << "Fast cloned " << copy.nEntries << " event(s) into "
+                      << "tree \"" << copy.output->GetName() << "\""
+                      << SLogger::endmsg;
+      copy.nEntries = 0;
+      copy.deferred = kFALSE;
+      return;
+   }
+   SLOG( ::DEBUG ) << "Fast cloning into tree \"" << copy.output->GetName()
+                   << "\" is not possible: " << cloner.GetWarning()
+                   << SLogger::endmsg;
+#endif // ROOT_VERSION...
+
+   FlushTreeCopy( copy );
+   return;
+}
+
+/**
+ * The function deletes the objects created for the copied object branches,
+ * and forgets about all the output trees receiving copied branches.
+ */
+void SCycleBaseNTuple::ClearTreeCopies() {
+
+   std::list< TreeCopy >::const_iterator copy = m_treeCopies.begin();
+   std::list< TreeCopy >::const_iterator copy_end = m_treeCopies.end();
+   for( ; copy != copy_end; ++copy ) {
+      std::list< CopiedBranch >::const_iterator itr = copy->branches.begin();
+      std::list< CopiedBranch >::const_iterator end = copy->branches.end();
+      for( ; itr != end; ++itr ) {
+         if( itr->object ) itr->objectClass->Destructor( itr->object );
+      }
+   }
+   m_treeCopies.clear();
+
+   return;
+}
+
 /**
  * This function can create a sub-directory inside an existing directory (a file
  * for instance). It's used to make directories for output trees.
@@ -38,7 +38,12 @@ SCycleConfig::SCycleConfig( const char* name )
      m_inputData(), m_targetLumi( 1. ), m_outputDirectory( "" ),
      m_postFix( "" ), m_msgLevel( INFO ), m_useTreeCache( kFALSE ),
      m_cacheSize( 30000000 ), m_cacheLearnEntries( 100 ),
-     m_processOnlyLocal( kFALSE ) {
+     m_processOnlyLocal( kFALSE ), m_progressInterval( 10.0 ),
+     m_memoryBudget( 0 ), m_checkpoint( kFALSE ), m_checkpointEvents( 0 ),
+     m_mergeNTuples( kTRUE ), m_pipeline( kFALSE ),
+     m_keepIntermediate( kFALSE ), m_sharedScan( kFALSE ),
+     m_backgroundMerge( kFALSE ), m_branchUsage( "" ), m_branchListFile( "" ),
+     m_branchList(), m_eventListFile( "" ), m_useEventList( "" ) {
 
 }
 
@@ -94,7 +99,8 @@ void SCycleConfig::SetProofServer( const TString& server ) {
 }
 
 /**
- * @returns The number of PROOF nodes to use for the cycle
+ * @returns The number of PROOF nodes (or forked worker processes in FORK
+ *          mode) to use for the cycle
  */
 Int_t SCycleConfig::GetProofNodes() const {
 
@@ -102,7 +108,8 @@ Int_t SCycleConfig::GetProofNodes() const {
 }
 
 /**
- * @param nodes The number of PROOF nodes to use for the cycle
+ * @param nodes The number of PROOF nodes (or forked worker processes in FORK
+ *              mode) to use for the cycle
  */
 void SCycleConfig::SetProofNodes( Int_t nodes ) {
 
@@ -286,6 +293,335 @@ Bool_t SCycleConfig::GetProcessOnlyLocal() const {
    return m_processOnlyLocal;
 }
 
+/**
+ * @param interval The time between two progress reports in seconds. Zero or
+ *                 a negative value turns the reports off.
+ */
+void SCycleConfig::SetProgressInterval( Double_t interval ) {
+
+   m_progressInterval = interval;
+   return;
+}
+
+/**
+ * @returns The time between two progress reports in seconds
+ */
+Double_t SCycleConfig::GetProgressInterval() const {
+
+   return m_progressInterval;
+}
+
+/**
+ * @param budget The maximal resident memory allowed for a worker in MB. Zero
+ *               or a negative value turns off the check.
+ */
+void SCycleConfig::SetMemoryBudget( Long64_t budget ) {
+
+   m_memoryBudget = budget;
+   return;
+}
+
+/**
+ * @returns The maximal resident memory allowed for a worker in MB
+ */
+Long64_t SCycleConfig::GetMemoryBudget() const {
+
+   return m_memoryBudget;
+}
+
+/**
+ * @param flag <code>kTRUE</code> if the output should be checkpointed after
+ *             each input file, <code>kFALSE</code> if not
+ */
+void SCycleConfig::SetCheckpoint( Bool_t flag ) {
+
+   m_checkpoint = flag;
+   return;
+}
+
+/**
+ * @returns <code>kTRUE</code> if the output should be checkpointed after
+ *          each input file, <code>kFALSE</code> if not
+ */
+Bool_t SCycleConfig::GetCheckpoint() const {
+
+   return m_checkpoint;
+}
+
+/**
+ * @param events The maximal number of events between two checkpoints. Zero
+ *               means that checkpoints are only made at the end of the input
+ *               files.
+ */
+void SCycleConfig::SetCheckpointEvents( Long64_t events ) {
+
+   m_checkpointEvents = events;
+   return;
+}
+
+/**
+ * @returns The maximal number of events between two checkpoints
+ */
+Long64_t SCycleConfig::GetCheckpointEvents() const {
+
+   return m_checkpointEvents;
+}
+
+/**
+ * @param flag <code>kTRUE</code> if the output ntuples of the workers should
+ *             be merged into the output file of the cycle,
+ *             <code>kFALSE</code> if they should be kept as separate files
+ */
+void SCycleConfig::SetMergeNTuples( Bool_t flag ) {
+
+   m_mergeNTuples = flag;
+   return;
+}
+
+/**
+ * @returns <code>kTRUE</code> if the output ntuples of the workers should be
+ *          merged into the output file of the cycle, <code>kFALSE</code> if
+ *          they should be kept as separate files
+ */
+Bool_t SCycleConfig::GetMergeNTuples() const {
+
+   return m_mergeNTuples;
+}
+
+/**
+ * A cycle running in a pipeline doesn't read its input from files. It
+ * processes the events written by the cycle preceding it in the same job,
+ * right after that cycle wrote them, without any disk round-trip.
+ *
+ * @param flag <code>kTRUE</code> if the cycle should process the output
+ *             events of the previous cycle in memory, <code>kFALSE</code> if
+ *             it should read its input files
+ */
+void SCycleConfig::SetPipeline( Bool_t flag ) {
+
+   m_pipeline = flag;
+   return;
+}
+
+/**
+ * @returns <code>kTRUE</code> if the cycle processes the output events of the
+ *          previous cycle in memory, <code>kFALSE</code> if it reads its
+ *          input files
+ */
+Bool_t SCycleConfig::GetPipeline() const {
+
+   return m_pipeline;
+}
+
+/**
+ * @param flag <code>kTRUE</code> if the previous cycle should still write
+ *             its output ntuples when running in a pipeline with this cycle,
+ *             <code>kFALSE</code> if not
+ */
+void SCycleConfig::SetKeepIntermediate( Bool_t flag ) {
+
+   m_keepIntermediate = flag;
+   return;
+}
+
+/**
+ * @returns <code>kTRUE</code> if the previous cycle still writes its output
+ *          ntuples when running in a pipeline with this cycle,
+ *          <code>kFALSE</code> if not
+ */
+Bool_t SCycleConfig::GetKeepIntermediate() const {
+
+   return m_keepIntermediate;
+}
+
+/**
+ * Cycles processing the same input data can be executed in a single event
+ * loop. This way the input files are only opened and read once, and the
+ * branches used by more than one of the cycles are only read once as well.
+ * Each of the cycles still writes its own output file.
+ *
+ * @param flag <code>kTRUE</code> if the cycle should process its input
+ *             events in the same event loop as the previous cycle,
+ *             <code>kFALSE</code> if it should run on its own
+ */
+void SCycleConfig::SetSharedScan( Bool_t flag ) {
+
+   m_sharedScan = flag;
+   return;
+}
+
+/**
+ * @returns <code>kTRUE</code> if the cycle processes its input events in the
+ *          same event loop as the previous cycle, <code>kFALSE</code> if it
+ *          runs on its own
+ */
+Bool_t SCycleConfig::GetSharedScan() const {
+
+   return m_sharedScan;
+}
+
+/**
+ * In LOCAL and FORK mode the output of each input data can be written (and
+ * the output ntuples merged) in a background process, while the processing
+ * of the next input data already starts. Only one such process is running
+ * at a time.
+ *
+ * @param flag <code>kTRUE</code> if the output should be written in a
+ *             background process, <code>kFALSE</code> if it should be
+ *             written before starting the next input data
+ */
+void SCycleConfig::SetBackgroundMerge( Bool_t flag ) {
+
+   m_backgroundMerge = flag;
+   return;
+}
+
+/**
+ * @returns <code>kTRUE</code> if the output is written in a background
+ *          process, <code>kFALSE</code> if not
+ */
+Bool_t SCycleConfig::GetBackgroundMerge() const {
+
+   return m_backgroundMerge;
+}
+
+/**
+ * The framework only reads the input branches that the cycle connected to.
+ * When this option is set, it also collects how much data was read from
+ * each of them, prints a report about it at the end of the cycle, and writes
+ * the list of connected branches into the specified file. The file can be
+ * given to the BranchList option of later jobs.
+ *
+ * @param fileName The file to write the list of connected branches into, or
+ *                 an empty string to turn off the branch usage collection
+ */
+void SCycleConfig::SetBranchUsage( const TString& fileName ) {
+
+   m_branchUsage = fileName;
+   return;
+}
+
+/**
+ * @returns The file to write the list of connected branches into, or an
+ *          empty string if the branch usage is not collected
+ */
+const TString& SCycleConfig::GetBranchUsage() const {
+
+   return m_branchUsage;
+}
+
+/**
+ * @param fileName The file that the list of branches to read was taken from
+ */
+void SCycleConfig::SetBranchListFile( const TString& fileName ) {
+
+   m_branchListFile = fileName;
+   return;
+}
+
+/**
+ * @returns The file that the list of branches to read was taken from
+ */
+const TString& SCycleConfig::GetBranchListFile() const {
+
+   return m_branchListFile;
+}
+
+/**
+ * When a branch list is given, all the other branches of the input trees are
+ * disabled, and the listed branches are put into the TTreeCache right away,
+ * without a learning phase. The cycle can still connect to branches that are
+ * not on the list, but those are reported as missing from it.
+ *
+ * @param branches The (tree name, branch name) pairs of the branches to read
+ */
+void SCycleConfig::SetBranchList( const branch_type& branches ) {
+
+   m_branchList = branches;
+   return;
+}
+
+/**
+ * @returns The (tree name, branch name) pairs of the branches to read, or
+ *          an empty list if all the branches should be kept enabled
+ */
+const SCycleConfig::branch_type& SCycleConfig::GetBranchList() const {
+
+   return m_branchList;
+}
+
+/**
+ * When this option is set, the events passing the selections recorded by
+ * the cycle with SCycleBaseExec::RecordSelection(...) are saved into the
+ * specified ROOT file at the end of the cycle. The lists are stored for each
+ * input file that was processed completely, and are only used again for the
+ * same cycle with the same user properties.
+ *
+ * @param fileName The ROOT file caching the lists of selected events, or an
+ *                 empty string to turn off the event list caching
+ */
+void SCycleConfig::SetEventListFile( const TString& fileName ) {
+
+   m_eventListFile = fileName;
+   return;
+}
+
+/**
+ * @returns The ROOT file caching the lists of selected events, or an empty
+ *          string if the event lists are not cached
+ */
+const TString& SCycleConfig::GetEventListFile() const {
+
+   return m_eventListFile;
+}
+
+/**
+ * When a selection name is given, only the events of the input files that
+ * passed the selection in a previous job are processed. (The other events are
+ * counted as skipped, without reading anything for them.) The input files
+ * that don't have a cached list for the selection are processed fully.
+ *
+ * @param selection The name of the selection, or an empty string to process
+ *                  all the events
+ */
+void SCycleConfig::SetUseEventList( const TString& selection ) {
+
+   m_useEventList = selection;
+   return;
+}
+
+/**
+ * @returns The name of the selection whose cached event list should be used,
+ *          or an empty string if all the events should be processed
+ */
+const TString& SCycleConfig::GetUseEventList() const {
+
+   return m_useEventList;
+}
+
+/**
+ * The configuration of a cycle can depend on files other than the XML
+ * configuration file itself. (Like the index files of unmerged ntuples.)
+ * The job configuration cache needs to know about these files, so that it
+ * could notice when they change.
+ *
+ * @param fileName Name of the file that the configuration was read from
+ */
+void SCycleConfig::AddConfigFile( const TString& fileName ) {
+
+   m_configFiles.push_back( fileName );
+   return;
+}
+
+/**
+ * @returns The names of the files besides the XML configuration file that
+ *          the configuration was read from
+ */
+const std::vector< TString >& SCycleConfig::GetConfigFiles() const {
+
+   return m_configFiles;
+}
+
 /**
  * This function is used at the initialization stage to print the configuration
  * of the cycle in a nice way.
@@ -299,10 +635,14 @@ void SCycleConfig::PrintConfig() const {
    logger << INFO << "                    Cycle configuration"
           << SLogger::endmsg;
    logger << INFO << "  - Running mode: "
-          << ( m_mode == LOCAL ? "LOCAL" : "PROOF" ) << SLogger::endmsg;
+          << ( m_mode == LOCAL ? "LOCAL" : ( m_mode == PROOF ? "PROOF" :
+                                             "FORK" ) ) << SLogger::endmsg;
    if( m_mode == PROOF ) {
       logger << INFO << "  - PROOF server: " << m_server << SLogger::endmsg;
       logger << INFO << "  - PROOF nodes: " << m_nodes << SLogger::endmsg;
+   } else if( m_mode == FORK ) {
+      logger << INFO << "  - Worker processes: " << m_nodes
+             << SLogger::endmsg;
    }
    logger << INFO << "  - Target luminosity: " << m_targetLumi
           << SLogger::endmsg;
@@ -328,6 +668,57 @@ void SCycleConfig::PrintConfig() const {
       logger << INFO << "  - Workers will only process local files"
              << SLogger::endmsg;
    }
+   if( m_progressInterval > 0.0 ) {
+      logger << INFO << "  - Progress report interval: " << m_progressInterval
+             << " s" << SLogger::endmsg;
+   } else {
+      logger << INFO << "  - Progress reports turned off" << SLogger::endmsg;
+   }
+   if( m_memoryBudget > 0 ) {
+      logger << INFO << "  - Memory budget per worker: " << m_memoryBudget
+             << " MB" << SLogger::endmsg;
+   }
+   if( m_checkpoint ) {
+      logger << INFO << "  - Checkpointing after each input file";
+      if( m_checkpointEvents > 0 ) {
+         logger << " and every " << m_checkpointEvents << " events";
+      }
+      logger << SLogger::endmsg;
+   }
+   if( ! m_mergeNTuples ) {
+      logger << INFO << "  - Output ntuples kept in separate files"
+             << SLogger::endmsg;
+   }
+   if( m_pipeline ) {
+      logger << INFO << "  - Reading the events of the previous cycle in "
+             << "memory" << ( m_keepIntermediate ? ", keeping its ntuples" :
+                              "" ) << SLogger::endmsg;
+   }
+   if( m_sharedScan ) {
+      logger << INFO << "  - Reading the input together with the previous "
+             << "cycle" << SLogger::endmsg;
+   }
+   if( m_backgroundMerge ) {
+      logger << INFO << "  - Output written in a background process while "
+             << "processing the next input data" << SLogger::endmsg;
+   }
+   if( m_branchUsage != "" ) {
+      logger << INFO << "  - Connected branches written to: " << m_branchUsage
+             << SLogger::endmsg;
+   }
+   if( m_branchListFile != "" ) {
+      logger << INFO << "  - Reading only the " << m_branchList.size()
+             << " branch(es) listed in: " << m_branchListFile
+             << SLogger::endmsg;
+   }
+   if( m_eventListFile != "" ) {
+      logger << INFO << "  - Selected events cached in: " << m_eventListFile
+             << SLogger::endmsg;
+   }
+   if( m_useEventList != "" ) {
+      logger << INFO << "  - Processing only the events passing selection: "
+             << m_useEventList << SLogger::endmsg;
+   }
 
    for( id_type::const_iterator id = m_inputData.begin();
         id != m_inputData.end(); ++id ) {
@@ -397,6 +788,24 @@ void SCycleConfig::ArrangeInputData() {
    return;
 }
 
+/**
+ * The sharding of the input can also be requested from the command line of
+ * sframe_main, in which case it's applied to all the input data objects of
+ * the cycle. This function has to be called before ValidateInput().
+ *
+ * @param index The index of the shard to process (from 0 to count - 1)
+ * @param count The number of shards to split the input data into
+ */
+void SCycleConfig::SetShard( Int_t index, Int_t count ) {
+
+   for( id_type::iterator id = m_inputData.begin(); id != m_inputData.end();
+        ++id ) {
+      id->SetShard( index, count );
+   }
+
+   return;
+}
+
 /**
  * Some information about the input is gathered automatically from the
  * input files, and not from the XML configuration. This information is
@@ -474,6 +883,8 @@ TString SCycleConfig::GetStringConfig( const SInputData* id ) const {
       result += "LOCAL";
    } else if( m_mode == PROOF ) {
       result += "PROOF";
+   } else if( m_mode == FORK ) {
+      result += "FORK";
    } else {
       result += "UNKNOWN";
    }
@@ -488,8 +899,34 @@ TString SCycleConfig::GetStringConfig( const SInputData* id ) const {
    result += TString::Format( "       TreeCacheSize=\"%lld\"\n", m_cacheSize );
    result += TString::Format( "       TreeCacheLearnEntries=\"%i\"\n",
                               m_cacheLearnEntries );
-   result += TString::Format( "       ProcessOnlyLocal=\"%s\">\n\n",
+   result += TString::Format( "       ProcessOnlyLocal=\"%s\"\n",
                               ( m_processOnlyLocal ? "True" : "False" ) );
+   result += TString::Format( "       ProgressInterval=\"%g\"\n",
+                              m_progressInterval );
+   result += TString::Format( "       MemoryBudget=\"%lld\"\n",
+                              m_memoryBudget );
+   result += TString::Format( "       Checkpoint=\"%s\"\n",
+                              ( m_checkpoint ? "True" : "False" ) );
+   result += TString::Format( "       CheckpointEvents=\"%lld\"\n",
+                              m_checkpointEvents );
+   result += TString::Format( "       MergeNTuples=\"%s\"\n",
+                              ( m_mergeNTuples ? "True" : "False" ) );
+   result += TString::Format( "       Pipeline=\"%s\"\n",
+                              ( m_pipeline ? "True" : "False" ) );
+   result += TString::Format( "       KeepIntermediate=\"%s\"\n",
+                              ( m_keepIntermediate ? "True" : "False" ) );
+   result += TString::Format( "       SharedScan=\"%s\"\n",
+                              ( m_sharedScan ? "True" : "False" ) );
+   result += TString::Format( "       BackgroundMerge=\"%s\"\n",
+                              ( m_backgroundMerge ? "True" : "False" ) );
+   result += TString::Format( "       BranchUsage=\"%s\"\n",
+                              m_branchUsage.Data() );
+   result += TString::Format( "       BranchList=\"%s\"\n",
+                              m_branchListFile.Data() );
+   result += TString::Format( "       EventListFile=\"%s\"\n",
+                              m_eventListFile.Data() );
+   result += TString::Format( "       UseEventList=\"%s\">\n\n",
+                              m_useEventList.Data() );
 
    // Decide how to add the input data information:
    if( id ) {
@@ -541,6 +978,21 @@ void SCycleConfig::ClearConfig() {
    m_useTreeCache = kFALSE;
    m_cacheSize = 30000000;
    m_cacheLearnEntries = 100;
+   m_progressInterval = 10.0;
+   m_memoryBudget = 0;
+   m_checkpoint = kFALSE;
+   m_checkpointEvents = 0;
+   m_mergeNTuples = kTRUE;
+   m_pipeline = kFALSE;
+   m_keepIntermediate = kFALSE;
+   m_sharedScan = kFALSE;
+   m_backgroundMerge = kFALSE;
+   m_branchUsage = "";
+   m_branchListFile = "";
+   m_branchList.clear();
+   m_eventListFile = "";
+   m_useEventList = "";
+   m_configFiles.clear();
 
    return;
 }
@@ -10,11 +10,21 @@
  *
  ***************************************************************************/
 
+// System include(s):
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <poll.h>
+#include <cerrno>
+
 // STL include(s):
 #include <iomanip>
 #include <sstream>
+#include <fstream>
 #include <cstdlib>
 #include <limits>
+#include <algorithm>
 
 // ROOT include(s):
 #include <TDOMParser.h>
@@ -36,7 +46,12 @@
 #include <THashList.h>
 #include <TFileInfo.h>
 #include <TObjString.h>
+#include <TUrl.h>
 #include <TInterpreter.h>
+#include <TBufferFile.h>
+#include <TMethodCall.h>
+#include <TNamed.h>
+#include <TMD5.h>
 
 // Local include(s):
 #include "../include/SCycleController.h"
@@ -50,6 +65,461 @@
 #include "../include/SCycleConfig.h"
 #include "../include/SCycleOutput.h"
 #include "../include/SProofManager.h"
+#include "../include/SMetricsRecord.h"
+#include "../include/SProgressMonitor.h"
+#include "../include/SCycleProgress.h"
+#include "../include/SPacketizer.h"
+#include "../include/SBranchUsage.h"
+#include "../include/SEventList.h"
+
+namespace {
+
+   /// Type describing a range of entries as (first entry, number of entries)
+   typedef std::pair< Long64_t, Long64_t > EntryRange;
+
+   /// Split the entries to be processed from a chain into checkpoint chunks
+   /**
+    * Each chunk is contained in a single input file, and holds at most
+    * <code>maxChunk</code> entries. (If <code>maxChunk</code> is positive.)
+    */
+   void MakeCheckpointChunks( TChain& chain, Long64_t first, Long64_t nentries,
+                              Long64_t maxChunk,
+                              std::vector< EntryRange >& chunks ) {
+
+      chunks.clear();
+
+      // The range of entries to process:
+      const Long64_t total = chain.GetEntries();
+      const Long64_t available = std::max( total - first, 0LL );
+      const Long64_t end = first + std::min( nentries, available );
+
+      // Split the range at the file boundaries and every maxChunk entries:
+      const Long64_t* offsets = chain.GetTreeOffset();
+      for( Int_t i = 0; i < chain.GetNtrees(); ++i ) {
+         Long64_t begin = std::max( offsets[ i ], first );
+         const Long64_t fileEnd = std::min( offsets[ i + 1 ], end );
+         while( begin < fileEnd ) {
+            Long64_t size = fileEnd - begin;
+            if( ( maxChunk > 0 ) && ( size > maxChunk ) ) {
+               size = maxChunk;
+            }
+            chunks.push_back( EntryRange( begin, size ) );
+            begin += size;
+         }
+      }
+
+      // Process the chain in one go if there's nothing to split:
+      if( chunks.empty() ) {
+         chunks.push_back( EntryRange( first, nentries ) );
+      }
+
+      return;
+   }
+
+   /// Name of the output file of a cycle for one input data type
+   /**
+    * When only one shard of the input data is processed, the index of the
+    * shard is added to the file name. The outputs of all the shards can
+    * be merged into the usual output file using sframe_merge_shards.py.
+    */
+   TString OutputFileName( const SCycleConfig& config, const TString& cycleName,
+                           const SInputData& id ) {
+
+      TString result = config.GetOutputDirectory() + cycleName + "." +
+         id.GetType() + "." + id.GetVersion() + config.GetPostFix();
+      if( id.GetShardCount() > 1 ) {
+         result += TString::Format( ".shard%iof%i", id.GetShardIndex(),
+                                    id.GetShardCount() );
+      }
+      result += ".root";
+      result.ReplaceAll( "::", "." );
+      return result;
+   }
+
+   /// Name of the index file listing the unmerged ntuple files of an output
+   TString NTupleIndexName( const TString& outputFile ) {
+
+      TString result( outputFile );
+      if( result.EndsWith( ".root" ) ) {
+         result.Remove( result.Length() - 5, 5 );
+      }
+      return result + SFrame::NTupleIndexExtension;
+   }
+
+   /// Name of one of the unmerged ntuple files of an output
+   TString NTupleFileName( const TString& outputFile, Int_t index ) {
+
+      TString result( outputFile );
+      if( result.EndsWith( ".root" ) ) {
+         result.Remove( result.Length() - 5, 5 );
+      }
+      return TString::Format( "%s.ntuple%i.root", result.Data(), index );
+   }
+
+   /// Message sent by the forked workers when requesting a new packet
+   struct ForkRequest {
+      Long64_t entries; ///< Number of entries processed in the last packet
+      Double_t realTime; ///< Time spent on processing the last packet
+   };
+
+   /// Read a given number of bytes from a socket
+   bool ReadAll( int fd, void* data, size_t size ) {
+
+      char* ptr = static_cast< char* >( data );
+      while( size ) {
+         const ssize_t n = read( fd, ptr, size );
+         if( n < 0 ) {
+            if( errno == EINTR ) continue;
+            return false;
+         }
+         if( n == 0 ) return false;
+         ptr += n;
+         size -= n;
+      }
+      return true;
+   }
+
+   /// Write a given number of bytes to a socket
+   bool WriteAll( int fd, const void* data, size_t size ) {
+
+      const char* ptr = static_cast< const char* >( data );
+      while( size ) {
+         const ssize_t n = write( fd, ptr, size );
+         if( n < 0 ) {
+            if( errno == EINTR ) continue;
+            return false;
+         }
+         ptr += n;
+         size -= n;
+      }
+      return true;
+   }
+
+   /// Name of the main event-level input tree of an input data
+   const char* MainTreeName( const SInputData& id ) {
+
+      std::map< Int_t, std::vector< STree > >::const_iterator trees =
+         id.GetTrees().begin();
+      std::map< Int_t, std::vector< STree > >::const_iterator trees_end =
+         id.GetTrees().end();
+      for( ; trees != trees_end; ++trees ) {
+         std::vector< STree >::const_iterator st = trees->second.begin();
+         std::vector< STree >::const_iterator st_end = trees->second.end();
+         for( ; st != st_end; ++st ) {
+            if( ( st->type & STree::INPUT_TREE ) &&
+                ( st->type & STree::EVENT_TREE ) ) {
+               return st->treeName.Data();
+            }
+         }
+      }
+      return 0;
+   }
+
+   /// Check whether two cycles would process exactly the same input events
+   /**
+    * The input data of the cycles have to be arranged already.
+    */
+   bool SameInput( const SCycleConfig& c1, const SCycleConfig& c2 ) {
+
+      if( c1.GetInputData().size() != c2.GetInputData().size() ) {
+         return false;
+      }
+      for( size_t i = 0; i < c1.GetInputData().size(); ++i ) {
+         const SInputData& id1 = c1.GetInputData()[ i ];
+         const SInputData& id2 = c2.GetInputData()[ i ];
+         if( ( id1.GetType() != id2.GetType() ) ||
+             ( id1.GetVersion() != id2.GetVersion() ) ||
+             ( id1.GetNEventsMax() != id2.GetNEventsMax() ) ||
+             ( id1.GetNEventsSkip() != id2.GetNEventsSkip() ) ||
+             ( id1.GetShardIndex() != id2.GetShardIndex() ) ||
+             ( id1.GetShardCount() != id2.GetShardCount() ) ||
+             id1.GetDataSets().size() || id2.GetDataSets().size() ||
+             ( id1.GetSFileIn().size() != id2.GetSFileIn().size() ) ) {
+            return false;
+         }
+         const char* tree1 = MainTreeName( id1 );
+         const char* tree2 = MainTreeName( id2 );
+         if( ( ! tree1 ) || ( ! tree2 ) || strcmp( tree1, tree2 ) ) {
+            return false;
+         }
+         for( size_t j = 0; j < id1.GetSFileIn().size(); ++j ) {
+            if( id1.GetSFileIn()[ j ].file != id2.GetSFileIn()[ j ].file ) {
+               return false;
+            }
+         }
+      }
+      return true;
+   }
+
+   /// Wait for a child process to finish
+   /**
+    * @returns <code>true</code> if the process finished successfully,
+    *          <code>false</code> otherwise
+    */
+   bool WaitForProcess( pid_t pid ) {
+
+      int status = 0;
+      while( ( waitpid( pid, &status, 0 ) < 0 ) && ( errno == EINTR ) ) {}
+      return ( WIFEXITED( status ) && ( ! WEXITSTATUS( status ) ) );
+   }
+
+   /// Create the metrics records describing the processing of an input data
+   /**
+    * The records of the workers/files that processed the input data are
+    * taken from the statistics object of the cycle, and a summary record is
+    * added after them.
+    */
+   std::vector< std::string >
+   InputDataRecords( const TString& cycleName, const SInputData& id,
+                     const TString& output, const SCycleStatistics* stat,
+                     Double_t realTime, Double_t cpuTime,
+                     Double_t mergeTime ) {
+
+      std::vector< std::string > records;
+      if( stat ) {
+         records = stat->GetRecords();
+      }
+      SMetricsRecord record( "inputdata" );
+      record.Add( "cycle", cycleName.Data() );
+      record.Add( "inputdata", id.GetType().Data() );
+      record.Add( "version", id.GetVersion().Data() );
+      record.Add( "output", output.Data() );
+      record.Add( "events_processed", stat ? stat->GetProcessedEvents() : -1 );
+      record.Add( "events_skipped", stat ? stat->GetSkippedEvents() : -1 );
+      record.Add( "real_time", realTime );
+      record.Add( "cpu_time", cpuTime );
+      record.Add( "worker_real_time", stat ? stat->GetRealTime() : 0.0 );
+      record.Add( "worker_cpu_time", stat ? stat->GetCpuTime() : 0.0 );
+      record.Add( "bytes_read", stat ? stat->GetBytesRead() : 0 );
+      record.Add( "bytes_written", stat ? stat->GetBytesWritten() : 0 );
+      record.Add( "merge_time", mergeTime );
+      record.Add( "peak_rss_kb", stat ? stat->GetPeakRSS() : 0 );
+      records.push_back( record.GetJSON() );
+
+      return records;
+   }
+
+   /// Name of the file caching the configuration read from an XML file
+   /**
+    * The cache files are kept in the directory specified by the
+    * SFRAME_CONFIG_CACHE environment variable, or in ~/.sframe/ConfigCache
+    * by default. They are named after the MD5 checksum of the full path name
+    * of the XML file.
+    */
+   TString ConfigCacheName( const TString& xmlConfigFile ) {
+
+      TString dir;
+      if( gSystem->Getenv( "SFRAME_CONFIG_CACHE" ) ) {
+         dir = gSystem->Getenv( "SFRAME_CONFIG_CACHE" );
+      } else {
+         dir = TString( gSystem->HomeDirectory() ) + "/.sframe/ConfigCache";
+      }
+
+      TString path( xmlConfigFile );
+      gSystem->ExpandPathName( path );
+      if( ! gSystem->IsAbsoluteFileName( path ) ) {
+         path = TString( gSystem->WorkingDirectory() ) + "/" + path;
+      }
+      TMD5 md5;
+      md5.Update( reinterpret_cast< const UChar_t* >( path.Data() ),
+                  path.Length() );
+      md5.Final();
+
+      return dir + "/" + md5.AsString() + ".root";
+   }
+
+   /// Current value of a dependency of a cached configuration
+   /**
+    * The dependencies are either files, in which case the MD5 checksum of
+    * the file is returned, or ":exp:" values, in which case their current
+    * expansion is returned. An empty string is returned for files that can't
+    * be read.
+    */
+   TString DependencyValue( const TString& dependency ) {
+
+      TString value( dependency );
+      if( value.BeginsWith( ":exp:" ) ) {
+         value.Remove( 0, 5 );
+         gSystem->ExpandPathName( value );
+         return value;
+      }
+
+      gSystem->ExpandPathName( value );
+      TMD5* md5 = TMD5::FileChecksum( value );
+      if( ! md5 ) {
+         return "";
+      }
+      const TString result = md5->AsString();
+      delete md5;
+      return result;
+   }
+
+   /// Collect the dependencies of an XML configuration file
+   /**
+    * Besides the file itself, the configuration depends on the external
+    * entity files (<code>&lt;!ENTITY name SYSTEM "file"&gt;</code>) used in
+    * it, on its DTD, and on the values of the environment variables used in
+    * the ":exp:" values of these files.
+    */
+   void AddConfigDependencies( const TString& fileName,
+                               std::vector< TString >& deps ) {
+
+      // Don't process the same file twice:
+      if( std::find( deps.begin(), deps.end(), fileName ) != deps.end() ) {
+         return;
+      }
+      deps.push_back( fileName );
+
+      // Read the contents of the file:
+      TString path( fileName );
+      gSystem->ExpandPathName( path );
+      std::ifstream in( path.Data() );
+      if( ! in.is_open() ) return;
+      std::ostringstream buffer;
+      buffer << in.rdbuf();
+      const std::string text = buffer.str();
+
+      // Look for the external entities. Their file names are understood
+      // relative to the file declaring them:
+      const TString dirname = gSystem->DirName( fileName );
+      std::string::size_type pos = 0;
+      while( ( pos = text.find( "<!ENTITY", pos ) ) != std::string::npos ) {
+         const std::string decl = text.substr( pos, text.find( '>', pos ) -
+                                               pos );
+         pos += 8;
+         const std::string::size_type system = decl.find( "SYSTEM" );
+         if( system == std::string::npos ) continue;
+         const std::string::size_type begin =
+            decl.find_first_of( "\"'", system );
+         if( begin == std::string::npos ) continue;
+         const std::string::size_type end = decl.find( decl[ begin ],
+                                                       begin + 1 );
+         if( end == std::string::npos ) continue;
+         TString entity( decl.substr( begin + 1, end - begin - 1 ).c_str() );
+         if( ! gSystem->IsAbsoluteFileName( entity ) ) {
+            entity = dirname + "/" + entity;
+         }
+         AddConfigDependencies( entity, deps );
+      }
+
+      // The DTD of the file provides the default values of the attributes,
+      // so the configuration depends on it as well. Its file name is the
+      // last quoted value of the document type declaration:
+      const std::string::size_type doctype = text.find( "<!DOCTYPE" );
+      if( doctype != std::string::npos ) {
+         const std::string decl =
+            text.substr( doctype, text.find_first_of( "[>", doctype ) -
+                         doctype );
+         const std::string::size_type end = decl.find_last_of( "\"'" );
+         const std::string::size_type begin =
+            ( ( ( end != std::string::npos ) && end ) ?
+              decl.find_last_of( decl[ end ], end - 1 ) : std::string::npos );
+         if( ( begin != std::string::npos ) && ( end > begin + 1 ) ) {
+            TString dtd( decl.substr( begin + 1, end - begin - 1 ).c_str() );
+            if( ! gSystem->IsAbsoluteFileName( dtd ) ) {
+               dtd = dirname + "/" + dtd;
+            }
+            AddConfigDependencies( dtd, deps );
+         }
+      }
+
+      // Look for the values expanded with environment variables:
+      pos = 0;
+      while( ( pos = text.find( ":exp:", pos ) ) != std::string::npos ) {
+         const std::string::size_type end = text.find_first_of( "\"'<",
+                                                                pos );
+         const TString value( text.substr( pos, end - pos ).c_str() );
+         if( std::find( deps.begin(), deps.end(), value ) == deps.end() ) {
+            deps.push_back( value );
+         }
+         pos += 5;
+      }
+
+      return;
+   }
+
+   /// Add the branch usage information from an output list to a summary
+   void CollectBranchUsage( const TList* outputs, SBranchUsage& usage ) {
+
+      if( ! outputs ) return;
+      TObject* obj = outputs->FindObject( SFrame::BranchUsageName );
+      if( ! obj ) return;
+
+      TList list;
+      list.Add( obj );
+      usage.Merge( &list );
+
+      return;
+   }
+
+   /// Print the branch usage of a cycle, and save its list of branches
+   void ReportBranchUsage( const SCycleConfig& config,
+                           const SBranchUsage& usage ) {
+
+      if( config.GetBranchUsage() == "" ) return;
+
+      SLogger logger( "SCycleController" );
+      logger << INFO << "Usage of the input branches by cycle '"
+             << usage.GetTitle() << "':" << SLogger::endmsg;
+      usage.PrintReport( INFO, config.GetBranchList() );
+      usage.WriteBranchList( config.GetBranchUsage() );
+
+      return;
+   }
+
+   /// Add the event lists from an output list to the lists of a cycle
+   void CollectEventLists( const TList* outputs, SEventList& lists ) {
+
+      if( ! outputs ) return;
+      TObject* obj = outputs->FindObject( SFrame::EventListName );
+      if( ! obj ) return;
+
+      TList list;
+      list.Add( obj );
+      lists.Merge( &list );
+
+      return;
+   }
+
+   /// Store the event lists recorded by a cycle, for the following jobs
+   void UpdateEventListCache( const SCycleConfig& config,
+                              const SEventList& recorded ) {
+
+      if( config.GetEventListFile() == "" ) return;
+
+      SLogger logger( "SCycleController" );
+      TString path( config.GetEventListFile() );
+      gSystem->ExpandPathName( path );
+      TFile* file = TFile::Open( path, "UPDATE" );
+      if( ( ! file ) || file->IsZombie() ) {
+         logger << ERROR << "Couldn't open event list file: " << path
+                << SLogger::endmsg;
+         delete file;
+         return;
+      }
+
+      // Replace the lists of the processed files in the stored object:
+      const TString key = SEventList::CacheKey( config );
+      SEventList* cache = dynamic_cast< SEventList* >( file->Get( key ) );
+      if( ! cache ) {
+         cache = new SEventList( key );
+      }
+      cache->SetTitle( recorded.GetTitle() );
+      cache->Update( recorded );
+      cache->Write( key, TObject::kOverwrite );
+
+      logger << INFO << "Event lists of " << cache->GetNFiles()
+             << " input file(s) of cycle '" << recorded.GetTitle()
+             << "' stored in: " << path << SLogger::endmsg;
+
+      file->Close();
+      delete file;
+      delete cache;
+
+      return;
+   }
+
+} // private namespace
 
 /**
  * The user has to specify a configuration file already at the construction
@@ -61,8 +531,10 @@
  */
 SCycleController::SCycleController( const TString& xmlConfigFile )
    : m_curCycle( 0 ), m_isInitialized( kFALSE ),
-     m_xmlConfigFile( xmlConfigFile ),
-     m_proof( 0 ), m_logger( "SCycleController" ) {
+     m_xmlConfigFile( xmlConfigFile ), m_metricsFile( "" ),
+     m_forceReparse( kFALSE ), m_shardIndex( 0 ), m_shardCount( 1 ),
+     m_proof( 0 ), m_keepProof( kFALSE ),
+     m_logger( "SCycleController" ) {
 
 }
 
@@ -70,7 +542,7 @@ SCycleController::SCycleController( const TString& xmlConfigFile )
  * This destructor actually does something. (Yay!)
  * It deletes all the analysis cycles that have been created from the
  * configuration in the XML file, and closes the connection to the
- * PROOF server.
+ * PROOF server. (Unless it was asked to keep it open for a following job.)
  */
 SCycleController::~SCycleController() {
 
@@ -79,7 +551,12 @@ SCycleController::~SCycleController() {
       delete ( *it );
    }
 
-   ShutDownProof();
+   if( m_keepProof ) {
+      // The next job may need different packages:
+      SProofManager::Instance()->ResetConfigured();
+   } else {
+      ShutDownProof();
+   }
 }
 
 /**
@@ -104,6 +581,73 @@ void SCycleController::Initialize() {
    this->DeleteAllAnalysisCycles();
    m_parPackages.clear();
 
+   // Set up the job from the configuration cache if possible, and read the
+   // XML file otherwise:
+   std::string jobName = "";
+   if( m_forceReparse || ( ! ReadConfigCache( jobName ) ) ) {
+      TList actions;
+      actions.SetOwner( kTRUE );
+      if( ReadConfigXML( jobName, actions ) ) {
+         WriteConfigCache( actions );
+      }
+   }
+
+   m_logger << INFO << "Job '" << jobName << "' configured"
+            << SLogger::endmsg;
+
+   // Start a new metrics file if one was requested:
+   if( m_metricsFile != "" ) {
+      m_logger << INFO << "Writing job metrics to: " << m_metricsFile
+               << SLogger::endmsg;
+      SMetricsRecord record( "job" );
+      record.Add( "job", jobName );
+      record.Add( "config", m_xmlConfigFile.Data() );
+      record.Add( "cycles",
+                  static_cast< Long64_t >( m_analysisCycles.size() ) );
+      WriteMetrics( std::vector< std::string >( 1, record.GetJSON() ),
+                    kTRUE );
+   }
+
+   // Print how much time it took to initialise the analysis:
+   timer.Stop();
+   m_logger << INFO << "Time needed for initialisation: " << std::setw( 6 )
+            << std::setprecision( 2 ) << timer.RealTime() << " s"
+            << SLogger::endmsg;
+
+   // Print memory consumption after initialising the analysis:
+   ProcInfo_t procinfo;
+   gSystem->GetProcInfo( &procinfo );
+   m_logger << DEBUG << "Memory consumption after initialisation:"
+            << SLogger::endmsg;
+   m_logger.setf( std::ios::fixed );
+   m_logger << DEBUG << "  Resident mem.: " << std::setw( 7 )
+            << procinfo.fMemResident << " kB; Virtual mem.: " << std::setw( 7 )
+            << procinfo.fMemVirtual << " kB" << SLogger::endmsg;
+
+   // set object status to be ready
+   m_isInitialized = kTRUE;
+
+   return;
+}
+
+/**
+ * This function reads the configuration of the job from the XML file. It
+ * creates and configures all the analysis cycles, loads the libraries, and
+ * executes the macros defined in the configuration. All the steps taken are
+ * recorded in a list, so that they could be repeated from the configuration
+ * cache in the next job.
+ *
+ * @param jobName The name of the job, read from the configuration
+ * @param actions List of the steps taken to set up the job
+ * @returns <code>kTRUE</code> if the configuration could be cached,
+ *          <code>kFALSE</code> if some of it had to be skipped
+ */
+Bool_t SCycleController::ReadConfigXML( std::string& jobName,
+                                        TList& actions ) {
+
+   // The configuration is only cached if it could be read without problems:
+   Bool_t cacheable = kTRUE;
+
    // --------------- xml read
    m_logger << INFO << "Reading xml file: '" << m_xmlConfigFile << "'"
             << SLogger::endmsg;
@@ -137,8 +681,9 @@ void SCycleController::Initialize() {
    TXMLNode* rootNode = xmldoc->GetRootNode();
 
    if( rootNode->GetNodeName() == TString( "JobConfiguration" ) ) {
-      std::string jobName = "";
+      jobName = "";
       std::string outputLevelString = "";
+      m_metricsFile = "";
       TListIter attribIt( rootNode->GetAttributes() );
       TXMLAttr* curAttr( 0 );
       while ( (curAttr = dynamic_cast< TXMLAttr* >( attribIt() ) ) != 0 ) {
@@ -146,6 +691,8 @@ void SCycleController::Initialize() {
             jobName = curAttr->GetValue();
          else if( curAttr->GetName() == TString( "OutputLevel" ) )
             outputLevelString = curAttr->GetValue();
+         else if( curAttr->GetName() == TString( "MetricsFile" ) )
+            m_metricsFile = curAttr->GetValue();
       }
       SMsgType type = INFO;
       if     ( outputLevelString == "VERBOSE" ) type = VERBOSE;
@@ -162,6 +709,14 @@ void SCycleController::Initialize() {
       }
       SLogWriter::Instance()->SetMinType( type );
 
+      // Remember the job level settings for the configuration cache:
+      actions.Add( new TNamed( "JobName", jobName.c_str() ) );
+      actions.Add( new TNamed( "OutputLevel",
+                               TString::Format( "%i",
+                                                static_cast< Int_t >( type ) )
+                               .Data() ) );
+      actions.Add( new TNamed( "MetricsFile", m_metricsFile.Data() ) );
+
       TXMLNode* nodes = rootNode->GetChildren();
 
       // now loop over nodes
@@ -203,6 +758,7 @@ void SCycleController::Initialize() {
                // Initialize the cycle, and remember it:
                cycle->Initialize( nodes );
                this->AddAnalysisCycle( cycle );
+               actions.Add( new TNamed( "Cycle", cycleName.c_str() ) );
 
             } else if( nodes->GetNodeName() == TString( "Library" ) ) {
 
@@ -221,6 +777,7 @@ void SCycleController::Initialize() {
                if( ( ret = gSystem->Load( libraryName ) ) >= 0 ) {
                   m_logger << DEBUG << "Library loaded: \"" << libraryName
                            << "\"" << SLogger::endmsg;
+                  actions.Add( new TNamed( "Library", libraryName.Data() ) );
                } else {
                   SError error( SError::StopExecution );
                   error << "Library failed to load: \"" << libraryName
@@ -245,6 +802,7 @@ void SCycleController::Initialize() {
                std::ostringstream command;
                command << "import " << libraryName;
                TPython::Exec( command.str().c_str() );
+               actions.Add( new TNamed( "PyLibrary", libraryName.Data() ) );
 
             } else if( nodes->GetNodeName() == TString( "Package" ) ) {
 
@@ -260,6 +818,7 @@ void SCycleController::Initialize() {
                         << packageName << SLogger::endmsg;
 
                m_parPackages.push_back( packageName );
+               actions.Add( new TNamed( "Package", packageName.Data() ) );
 
             } else if( nodes->GetNodeName() == TString( "Macro" ) ) {
 
@@ -281,6 +840,7 @@ void SCycleController::Initialize() {
                   REPORT_ERROR( "There was a problem executing macro: "
                                 << macroName );
                }
+               actions.Add( new TNamed( "Macro", macroName.Data() ) );
             }
 
          } catch( const SError& error ) {
@@ -294,6 +854,9 @@ void SCycleController::Initialize() {
                REPORT_ERROR( "Message: " << error.what() );
                REPORT_ERROR( "--> Skipping cycle!" );
 
+               // Don't cache a configuration that had problems:
+               cacheable = kFALSE;
+
                nodes = nodes->GetNextNode();
                continue;
             } else {
@@ -306,9 +869,6 @@ void SCycleController::Initialize() {
 
       } // end loop over nodes
 
-      m_logger << INFO << "Job '" << jobName << "' configured"
-               << SLogger::endmsg;
-
    } else {
       SError error( SError::StopExecution );
       error << "XML root node " << rootNode->GetNodeName()
@@ -318,24 +878,247 @@ void SCycleController::Initialize() {
 
    // --------------- end of xml interpretation
 
-   // Print how much time it took to initialise the analysis:
-   timer.Stop();
-   m_logger << INFO << "Time needed for initialisation: " << std::setw( 6 )
-            << std::setprecision( 2 ) << timer.RealTime() << " s"
-            << SLogger::endmsg;
+   return cacheable;
+}
 
-   // Print memory consumption after initialising the analysis:
-   ProcInfo_t procinfo;
-   gSystem->GetProcInfo( &procinfo );
-   m_logger << DEBUG << "Memory consumption after initialisation:"
-            << SLogger::endmsg;
-   m_logger.setf( std::ios::fixed );
-   m_logger << DEBUG << "  Resident mem.: " << std::setw( 7 )
-            << procinfo.fMemResident << " kB; Virtual mem.: " << std::setw( 7 )
-            << procinfo.fMemVirtual << " kB" << SLogger::endmsg;
+/**
+ * Reading the XML configuration of a big job, and setting up all the input
+ * data from it can take a noticeable amount of time. So the result of this
+ * is saved in a cache file by SCycleController::WriteConfigCache. This
+ * function tries to set up the job from such a cache file.
+ *
+ * The cache is only used if none of the files that the configuration was
+ * read from changed since the cache was written, and the environment
+ * variables used in the configuration still have the same values.
+ *
+ * @param jobName The name of the job, read from the cache
+ * @returns <code>kTRUE</code> if the job was set up from the cache,
+ *          <code>kFALSE</code> if the XML file has to be read
+ */
+Bool_t SCycleController::ReadConfigCache( std::string& jobName ) {
+
+   // Check if there is a cache for this configuration:
+   const TString fileName = ConfigCacheName( m_xmlConfigFile );
+   if( gSystem->AccessPathName( fileName ) ) {
+      REPORT_VERBOSE( "No configuration cache found for: "
+                      << m_xmlConfigFile );
+      return kFALSE;
+   }
 
-   // set object status to be ready
-   m_isInitialized = kTRUE;
+   // Read the contents of the cache:
+   TFile* file = TFile::Open( fileName, "READ" );
+   if( ( ! file ) || file->IsZombie() ) {
+      m_logger << WARNING << "Couldn't open configuration cache: "
+               << fileName << SLogger::endmsg;
+      delete file;
+      return kFALSE;
+   }
+   TList* deps = dynamic_cast< TList* >( file->Get( "Dependencies" ) );
+   TList* actions = dynamic_cast< TList* >( file->Get( "Actions" ) );
+   TList* cycles = dynamic_cast< TList* >( file->Get( "Cycles" ) );
+   file->Close();
+   delete file;
+   if( deps ) deps->SetOwner( kTRUE );
+   if( actions ) actions->SetOwner( kTRUE );
+   if( cycles ) cycles->SetOwner( kTRUE );
+
+   Bool_t valid = ( deps && actions && cycles );
+   if( ! valid ) {
+      m_logger << WARNING << "Configuration cache is corrupt: " << fileName
+               << SLogger::endmsg;
+   }
+
+   // Check that nothing changed since the cache was written:
+   for( Int_t i = 0; valid && ( i < deps->GetSize() ); ++i ) {
+      const TNamed* dep = dynamic_cast< const TNamed* >( deps->At( i ) );
+      if( ( ! dep ) || ( DependencyValue( dep->GetName() ) !=
+                         dep->GetTitle() ) ) {
+         m_logger << INFO << "Configuration changed since it was cached ("
+                  << ( dep ? dep->GetName() : "?" ) << ")"
+                  << SLogger::endmsg;
+         valid = kFALSE;
+      }
+   }
+
+   // Set up the job from the cache:
+   if( valid ) {
+      m_logger << INFO << "Reading cached configuration of: '"
+               << m_xmlConfigFile << "'" << SLogger::endmsg;
+      valid = ReplayConfigCache( *actions, *cycles, jobName );
+   }
+
+   delete deps;
+   delete actions;
+   delete cycles;
+
+   return valid;
+}
+
+/**
+ * This function repeats all the steps that were taken when the job was last
+ * set up from the XML file. The libraries and macros are loaded/executed in
+ * the same order as then, and the cycles are created and configured using
+ * the configuration objects saved in the cache.
+ *
+ * @param actions List of the steps taken to set up the job
+ * @param cycles The configurations of the cycles
+ * @param jobName The name of the job, read from the cache
+ * @returns <code>kTRUE</code> if the job could be set up,
+ *          <code>kFALSE</code> if not
+ */
+Bool_t SCycleController::ReplayConfigCache( const TList& actions,
+                                            const TList& cycles,
+                                            std::string& jobName ) {
+
+   Int_t cycleIndex = 0;
+   for( Int_t i = 0; i < actions.GetSize(); ++i ) {
+
+      const TNamed* action = dynamic_cast< const TNamed* >( actions.At( i ) );
+      if( ! action ) continue;
+      const TString kind = action->GetName();
+      const TString value = action->GetTitle();
+
+      if( kind == "JobName" ) {
+
+         jobName = value.Data();
+
+      } else if( kind == "OutputLevel" ) {
+
+         SLogWriter::Instance()->SetMinType(
+            static_cast< SMsgType >( value.Atoi() ) );
+
+      } else if( kind == "MetricsFile" ) {
+
+         m_metricsFile = value;
+
+      } else if( kind == "Cycle" ) {
+
+         const SCycleConfig* config =
+            dynamic_cast< const SCycleConfig* >( cycles.At( cycleIndex++ ) );
+         TClass* cycleClass = gROOT->GetClass( value, true );
+         if( ( ! config ) || ( ! cycleClass ) ||
+             ( ! cycleClass->InheritsFrom( "ISCycleBase" ) ) ) {
+            m_logger << WARNING << "Couldn't create cycle '" << value
+                     << "' from the configuration cache" << SLogger::endmsg;
+            this->DeleteAllAnalysisCycles();
+            m_parPackages.clear();
+            return kFALSE;
+         }
+
+         // Instantiate the cycle:
+         ISCycleBase* cycle =
+            reinterpret_cast< ISCycleBase* >( cycleClass->New() );
+
+         m_logger << INFO << "Created cycle '" << value << "'"
+                  << SLogger::endmsg;
+
+         // Configure the cycle, and remember it:
+         cycle->SetConfig( *config );
+         cycle->GetConfig().PrintConfig();
+         this->AddAnalysisCycle( cycle );
+
+      } else if( kind == "Library" ) {
+
+         REPORT_VERBOSE( "Trying to load library \"" << value << "\"" );
+
+         int ret = 0;
+         if( ( ret = gSystem->Load( value ) ) >= 0 ) {
+            m_logger << DEBUG << "Library loaded: \"" << value << "\""
+                     << SLogger::endmsg;
+         } else {
+            SError error( SError::StopExecution );
+            error << "Library failed to load: \"" << value
+                  << "\"\nRet. Val.: " << ret;
+            throw error;
+         }
+
+      } else if( kind == "PyLibrary" ) {
+
+         REPORT_VERBOSE( "Trying to load python library \"" << value
+                         << "\"" );
+         TPython::Exec( ( "import " + value ).Data() );
+
+      } else if( kind == "Package" ) {
+
+         m_logger << DEBUG << "Using PROOF ARchive package: " << value
+                  << SLogger::endmsg;
+         m_parPackages.push_back( value );
+
+      } else if( kind == "Macro" ) {
+
+         m_logger << DEBUG << "Executing macro: " << value << SLogger::endmsg;
+         Int_t errorCode = 0;
+         gROOT->Macro( value, &errorCode );
+         if( errorCode != TInterpreter::kNoError ) {
+            REPORT_ERROR( "There was a problem executing macro: " << value );
+         }
+      }
+   }
+
+   return kTRUE;
+}
+
+/**
+ * The cache file holds the list of files (and environment variable
+ * expansions) that the configuration depends on, the list of steps taken
+ * to set up the job, and the configuration objects of all the cycles. The
+ * file is first written under a temporary name, and only renamed at the
+ * end, so that a parallel job would never see a half-written cache.
+ *
+ * @param actions List of the steps taken to set up the job
+ */
+void SCycleController::WriteConfigCache( const TList& actions ) const {
+
+   // Collect the dependencies of the configuration:
+   std::vector< TString > files;
+   AddConfigDependencies( m_xmlConfigFile, files );
+   TList cycles;
+   cycles.SetOwner( kTRUE );
+   std::vector< ISCycleBase* >::const_iterator cycle =
+      m_analysisCycles.begin();
+   std::vector< ISCycleBase* >::const_iterator cycle_end =
+      m_analysisCycles.end();
+   for( ; cycle != cycle_end; ++cycle ) {
+      const SCycleConfig& config = ( *cycle )->GetConfig();
+      files.insert( files.end(), config.GetConfigFiles().begin(),
+                    config.GetConfigFiles().end() );
+      cycles.Add( new SCycleConfig( config ) );
+   }
+   TList deps;
+   deps.SetOwner( kTRUE );
+   std::vector< TString >::const_iterator itr = files.begin();
+   std::vector< TString >::const_iterator end = files.end();
+   for( ; itr != end; ++itr ) {
+      deps.Add( new TNamed( *itr, DependencyValue( *itr ) ) );
+   }
+
+   // Write the cache under a temporary name:
+   const TString fileName = ConfigCacheName( m_xmlConfigFile );
+   const TString tmpName = TString::Format( "%s.%i", fileName.Data(),
+                                            gSystem->GetPid() );
+   gSystem->mkdir( gSystem->DirName( fileName ), kTRUE );
+   TFile* file = TFile::Open( tmpName, "RECREATE" );
+   if( ( ! file ) || file->IsZombie() ) {
+      m_logger << WARNING << "Couldn't write configuration cache: "
+               << fileName << SLogger::endmsg;
+      delete file;
+      return;
+   }
+   deps.Write( "Dependencies", TObject::kSingleKey );
+   actions.Write( "Actions", TObject::kSingleKey );
+   cycles.Write( "Cycles", TObject::kSingleKey );
+   file->Close();
+   delete file;
+
+   // Move it to its final place:
+   if( gSystem->Rename( tmpName, fileName ) ) {
+      m_logger << WARNING << "Couldn't write configuration cache: "
+               << fileName << SLogger::endmsg;
+      gSystem->Unlink( tmpName );
+      return;
+   }
+   m_logger << DEBUG << "Configuration cached in: " << fileName
+            << SLogger::endmsg;
 
    return;
 }
@@ -362,8 +1145,9 @@ void SCycleController::ExecuteAllCycles() {
    // Let the user know what's happening:
    m_logger << INFO << "Entering ExecuteAllCycles()" << SLogger::endmsg;
 
-   // Execute each cycle one by one:
-   for( size_t i = 0; i < m_analysisCycles.size(); ++i ) {
+   // Execute each cycle one by one. (Pipelined cycles are executed together
+   // with the cycle before them.)
+   while( m_curCycle < m_analysisCycles.size() ) {
       this->ExecuteNextCycle();
    }
 
@@ -405,6 +1189,9 @@ void SCycleController::ExecuteNextCycle() {
    SCycleConfig config = cycle->GetConfig();
    config.SetName( SFrame::CycleConfigName );
    config.ArrangeInputData(); // To handle multiple ID of the same type...
+   if( m_shardCount > 1 ) {
+      config.SetShard( m_shardIndex, m_shardCount ); // Before the validation!
+   }
    config.ValidateInput(); // This is needed for the proper weighting...
    config.SetMsgLevel( SLogWriter::Instance()->GetMinType() ); // For the correct msg level...
    config.SetCycleName( cycle->GetName() ); // For technical reasons...
@@ -413,9 +1200,95 @@ void SCycleController::ExecuteNextCycle() {
    m_logger << INFO << "Executing Cycle #" << m_curCycle << " ('"
             << cycleName << "') "
             << ( config.GetRunMode() == SCycleConfig::LOCAL ? "locally" :
-                 "on PROOF" )
+                 ( config.GetRunMode() == SCycleConfig::PROOF ? "on PROOF" :
+                   "in forked processes" ) )
             << SLogger::endmsg;
 
+   //
+   // Collect the cycles that should be executed in the same event loop as
+   // this one. Either the next cycle processes the events of this cycle in a
+   // pipeline, or the following cycles read the same input events as this
+   // one. This is only possible if all the cycles run locally, in a single
+   // event loop.
+   //
+   std::vector< ISCycleBase* > companions;
+   std::vector< SCycleConfig > companionConfigs;
+   Bool_t pipelined = kFALSE;
+   const Bool_t singleLoop =
+      ( ( config.GetRunMode() == SCycleConfig::LOCAL ) &&
+        ( ! config.GetCheckpoint() ) );
+   for( UInt_t i = m_curCycle + 1;
+        singleLoop && ( ! pipelined ) && ( i < m_analysisCycles.size() );
+        ++i ) {
+
+      ISCycleBase* next = m_analysisCycles.at( i );
+      if( ( next->GetConfig().GetRunMode() != SCycleConfig::LOCAL ) ||
+          next->GetConfig().GetCheckpoint() ) {
+         break;
+      }
+      if( ! ( next->GetConfig().GetPipeline() ||
+              next->GetConfig().GetSharedScan() ) ) {
+         break;
+      }
+
+      SCycleConfig nextConfig = next->GetConfig();
+      nextConfig.SetName( SFrame::CycleConfigName );
+      nextConfig.ArrangeInputData();
+      nextConfig.SetMsgLevel( SLogWriter::Instance()->GetMinType() );
+      nextConfig.SetCycleName( next->GetName() );
+      if( m_shardCount > 1 ) {
+         nextConfig.SetShard( m_shardIndex, m_shardCount );
+      }
+
+      if( nextConfig.GetPipeline() && companions.empty() ) {
+         // The input files of the downstream cycle are not validated, as they
+         // are not even written yet:
+         pipelined = kTRUE;
+         m_logger << INFO << "Executing Cycle #" << i << " ('"
+                  << next->GetName() << "') on the events of this cycle, in "
+                  << "the same event loop" << SLogger::endmsg;
+      } else if( nextConfig.GetSharedScan() &&
+                 SameInput( config, nextConfig ) ) {
+         nextConfig.ValidateInput(); // This is needed for the proper weighting
+         m_logger << INFO << "Executing Cycle #" << i << " ('"
+                  << next->GetName() << "') on the input of this cycle, in "
+                  << "the same event loop" << SLogger::endmsg;
+      } else {
+         break;
+      }
+
+      next->SetConfig( nextConfig );
+      companions.push_back( next );
+      companionConfigs.push_back( nextConfig );
+   }
+   if( config.GetPipeline() ) {
+      m_logger << WARNING << "Cycle can only be pipelined with the previous "
+               << "cycle if both of them run in LOCAL mode, without "
+               << "checkpointing" << SLogger::endmsg;
+      m_logger << WARNING << "Reading the input of the cycle from file(s)"
+               << SLogger::endmsg;
+   } else if( config.GetSharedScan() ) {
+      m_logger << WARNING << "Cycle can only share the event loop of the "
+               << "previous cycle if both of them run in LOCAL mode, without "
+               << "checkpointing, on the same input data" << SLogger::endmsg;
+      m_logger << WARNING << "Reading the input of the cycle on its own"
+               << SLogger::endmsg;
+   }
+
+   // The input objects of the cycles executed in the same event loop:
+   std::vector< TList* > companionLists;
+   std::vector< SInputData > companionIds( companions.size() );
+   std::vector< SBranchUsage* > companionUsages;
+   std::vector< SEventList* > companionEvents;
+   for( size_t i = 0; i < companions.size(); ++i ) {
+      companionLists.push_back( new TList() );
+      companionUsages.push_back(
+         new SBranchUsage( SFrame::BranchUsageName ) );
+      companionUsages.back()->SetTitle( companions[ i ]->GetName() );
+      companionEvents.push_back( new SEventList( SFrame::EventListName ) );
+      companionEvents.back()->SetTitle( companions[ i ]->GetName() );
+   }
+
    //
    // Make some initialisation steps before starting the cycle:
    //
@@ -435,33 +1308,61 @@ void SCycleController::ExecuteNextCycle() {
          for( ; pkg_itr != pkg_end; ++pkg_itr ) {
 
             // Find the full path name of the package:
-            TString pkg = SParLocator::Locate( *pkg_itr );
-            if( pkg == "" ) continue;
+            const TString pkgPath = SParLocator::Locate( *pkg_itr );
+            if( pkgPath == "" ) continue;
+
+            // The server still has the package from an earlier job if it was
+            // enabled there, and it didn't change since then:
+            const Bool_t cached =
+               SProofManager::Instance()->IsPackageEnabled(
+                  config.GetProofServer(), pkgPath );
 
             // Tell PROOF to upload the package to the cluster:
-            REPORT_VERBOSE( "Uploading package: " << pkg );
-            if( m_proof->UploadPackage( pkg ) ) {
-               REPORT_ERROR( "There was a problem with uploading "
-                             << *pkg_itr );
-               throw SError( *pkg_itr + " could not be uploaded to PROOF",
-                             SError::SkipCycle );
+            if( cached ) {
+               REPORT_VERBOSE( "Package unchanged, not uploading: "
+                               << pkgPath );
+            } else {
+               REPORT_VERBOSE( "Uploading package: " << pkgPath );
+               if( m_proof->UploadPackage( pkgPath ) ) {
+                  REPORT_ERROR( "There was a problem with uploading "
+                                << *pkg_itr );
+                  throw SError( *pkg_itr + " could not be uploaded to PROOF",
+                                SError::SkipCycle );
+               }
             }
 
             // Get the package file name without the extension:
+            TString pkg = pkgPath;
             const Ssiz_t slash_pos = pkg.Last( '/' );
             pkg.Remove( 0, slash_pos + 1 );
             if( pkg.EndsWith( ".par", TString::kIgnoreCase ) ) {
                pkg.Remove( pkg.Length() - 4, 4 );
             }
 
-            // Enable (compile) the package on the cluster:
+            // Enable (compile) the package on the cluster. If the server
+            // doesn't have the package that it should have, upload it
+            // after all:
             m_logger << INFO << "Enabling package: " << pkg << SLogger::endmsg;
-            if( m_proof->EnablePackage( pkg, kTRUE ) ) {
+            Int_t status = m_proof->EnablePackage( pkg, kTRUE );
+            if( status && cached ) {
+               m_logger << WARNING << "Package " << pkg << " is not available "
+                        << "on the server anymore, uploading it again"
+                        << SLogger::endmsg;
+               status = m_proof->UploadPackage( pkgPath );
+               if( ! status ) {
+                  status = m_proof->EnablePackage( pkg, kTRUE );
+               }
+            }
+            if( status ) {
                REPORT_ERROR( "There was a problem with enabling "
                              << *pkg_itr );
                throw SError( *pkg_itr + " could not be enabled on PROOF",
                              SError::SkipCycle );
             }
+
+            // Remember that the package is now available on the server:
+            SProofManager::Instance()->SetPackageEnabled(
+               config.GetProofServer(), pkgPath );
          }
       }
       // Remember that this PROOF connection is now "configured":
@@ -473,11 +1374,69 @@ void SCycleController::ExecuteNextCycle() {
    Long64_t procev = 0;
    // Number of skipped events:
    Long64_t skipev = 0;
+   // Resource usage of the workers, and time spent writing the output:
+   Double_t workerReal = 0.0, workerCpu = 0.0, mergeTime = 0.0;
+   Long64_t bytesRead = 0, bytesWritten = 0;
+   Long64_t peakRSS = SMetricsRecord::GetPeakRSS();
+   // Usage of the input branches by the cycle:
+   SBranchUsage branchUsage( SFrame::BranchUsageName );
+   branchUsage.SetTitle( cycleName );
+   // Events passing the selections recorded by the cycle:
+   SEventList eventLists( SFrame::EventListName );
+   eventLists.SetTitle( cycleName );
+
+   //
+   // Set up the checkpointing of the cycle. The checkpoint file tells how far
+   // a previous, interrupted execution of the cycle got:
+   //
+   const Bool_t checkpoint = ( config.GetCheckpoint() &&
+                               ( config.GetRunMode() == SCycleConfig::LOCAL ) );
+   if( config.GetCheckpoint() && ( ! checkpoint ) ) {
+      m_logger << WARNING << "Checkpointing is only available in LOCAL mode"
+               << SLogger::endmsg;
+   }
+   // (The jobs processing different shards of the input can't share it.)
+   TString checkpointFile = config.GetOutputDirectory() + cycleName +
+      config.GetPostFix();
+   for( SCycleConfig::id_type::const_iterator sid =
+           config.GetInputData().begin(); sid != config.GetInputData().end();
+        ++sid ) {
+      if( sid->GetShardCount() > 1 ) {
+         checkpointFile += TString::Format( ".shard%iof%i",
+                                            sid->GetShardIndex(),
+                                            sid->GetShardCount() );
+         break;
+      }
+   }
+   checkpointFile += ".checkpoint";
+   checkpointFile.ReplaceAll( "::", "." );
+   Int_t doneInputData = 0;
+   Long64_t doneEntries = 0;
+   if( checkpoint &&
+       ReadCheckpoint( checkpointFile, doneInputData, doneEntries ) ) {
+      m_logger << INFO << "Resuming from checkpoint: InputData #"
+               << doneInputData << ", entry " << doneEntries
+               << SLogger::endmsg;
+   }
+
+   //
+   // The output of each input data is written in a background process if
+   // possible, so that the processing of the next input data could start
+   // right away. Checkpointing needs the output to be on disk before it can
+   // move on, and PROOF takes care of merging the output by itself.
+   //
+   const Bool_t backgroundMerge =
+      ( config.GetBackgroundMerge() && ( ! checkpoint ) &&
+        ( config.GetRunMode() != SCycleConfig::PROOF ) );
+   pid_t writer = -1;
 
    //
    // The begin cycle function has to be called here by hand:
    //
    cycle->BeginCycle();
+   for( size_t i = 0; i < companions.size(); ++i ) {
+      companions[ i ]->BeginCycle();
+   }
 
    //
    // Loop over all defined input data types:
@@ -486,6 +1445,14 @@ void SCycleController::ExecuteNextCycle() {
    SCycleConfig::id_type::const_iterator id_end = config.GetInputData().end();
    for( ; id != id_end; ++id ) {
 
+      // Measure the time needed for processing this input data:
+      TStopwatch idTimer;
+      idTimer.Start();
+
+      // Index of the input data in the cycle:
+      const Int_t idIndex =
+         static_cast< Int_t >( id - config.GetInputData().begin() );
+
       //
       // Decide how to write the output file at the end of processing this
       // InputData. The InputData objects should be arranged by their type at
@@ -511,6 +1478,24 @@ void SCycleController::ExecuteNextCycle() {
          }
       }
 
+      //
+      // Skip the input data that was fully processed before the checkpoint.
+      // If this input data was partially processed, then its partial output
+      // is already in the output file.
+      //
+      if( checkpoint && ( idIndex < doneInputData ) ) {
+         m_logger << INFO << "Skipping input data type: " << id->GetType()
+                  << " version: " << id->GetVersion()
+                  << ", it was processed before the checkpoint"
+                  << SLogger::endmsg;
+         continue;
+      }
+      const Long64_t resumeEntries =
+         ( ( checkpoint && ( idIndex == doneInputData ) ) ? doneEntries : 0 );
+      if( resumeEntries > 0 ) {
+         updateOutput = kTRUE;
+      }
+
       //
       // Each input data has to have at least one input tree:
       //
@@ -524,18 +1509,7 @@ void SCycleController::ExecuteNextCycle() {
       // Find the first event-level input tree in the configuration:
       REPORT_VERBOSE( "Finding the name of the main event-level input "
                       "TTree..." );
-      const char* treeName = 0;
-      for( std::map< Int_t, std::vector< STree > >::const_iterator trees =
-              id->GetTrees().begin(); trees != id->GetTrees().end(); ++trees ) {
-         for( std::vector< STree >::const_iterator st = trees->second.begin();
-              st != trees->second.end(); ++st ) {
-            if( ( st->type & STree::INPUT_TREE ) &&
-                ( st->type & STree::EVENT_TREE ) ) {
-               treeName = st->treeName.Data();
-               break;
-            }
-         }
-      }
+      const char* treeName = MainTreeName( *id );
       if( ! treeName ) {
          REPORT_ERROR( "Can't determine input TTree name for input data "
                        << id->GetType() );
@@ -565,20 +1539,72 @@ void SCycleController::ExecuteNextCycle() {
       //
       // Calculate how many events to process:
       //
-      const Long64_t evmax = ( id->GetNEventsMax() == -1 ?
+      const Long64_t evmax = ( id->GetShardNEventsMax() == -1 ?
                                std::numeric_limits< Long64_t >::max() :
-                               id->GetNEventsMax() );
+                               id->GetShardNEventsMax() );
+
+      // The output file of the cycle for this input data:
+      const TString outputFileName = OutputFileName( config, cycleName, *id );
 
       // This will point to the created output objects:
       TList* outputs = 0;
 
+      //
+      // Set up the cycles executed in the same event loop, using their input
+      // data matching this one:
+      //
+      cycle->SetPipelineSink( 0, kFALSE );
+      cycle->ClearSharedScan();
+      std::vector< Bool_t > companionUsed( companions.size(), kFALSE );
+      for( size_t i = 0; i < companions.size(); ++i ) {
+
+         const SInputData* cid = 0;
+         SCycleConfig::id_type::const_iterator cid_itr =
+            companionConfigs[ i ].GetInputData().begin();
+         SCycleConfig::id_type::const_iterator cid_end =
+            companionConfigs[ i ].GetInputData().end();
+         for( ; cid_itr != cid_end; ++cid_itr ) {
+            if( ( cid_itr->GetType() == id->GetType() ) &&
+                ( cid_itr->GetVersion() == id->GetVersion() ) ) {
+               cid = &*cid_itr;
+               break;
+            }
+         }
+         if( ! cid ) {
+            m_logger << WARNING << "Cycle '" << companions[ i ]->GetName()
+                     << "' has no input data of type: " << id->GetType()
+                     << " version: " << id->GetVersion() << SLogger::endmsg;
+            continue;
+         }
+
+         companionIds[ i ] = *cid;
+         companionIds[ i ].SetName( SFrame::CurrentInputDataName );
+         companionLists[ i ]->Clear();
+         companionLists[ i ]->Add( &companionConfigs[ i ] );
+         companionLists[ i ]->Add( &companionIds[ i ] );
+         const TList& cconfigList = companions[ i ]->GetConfigurationObjects();
+         for( Int_t j = 0; j < cconfigList.GetSize(); ++j ) {
+            companionLists[ i ]->Add( cconfigList.At( j ) );
+         }
+         companions[ i ]->SetInputList( companionLists[ i ] );
+         if( pipelined ) {
+            const Bool_t keep = companionConfigs[ i ].GetKeepIntermediate();
+            cycle->SetPipelineSink( companions[ i ], keep );
+         } else {
+            cycle->AddSharedScan( companions[ i ] );
+         }
+         companionUsed[ i ] = kTRUE;
+      }
+
       //
       // The cycle can be run in two modes:
       //
-      if( config.GetRunMode() == SCycleConfig::LOCAL ) {
+      if( ( config.GetRunMode() == SCycleConfig::LOCAL ) ||
+          ( config.GetRunMode() == SCycleConfig::FORK ) ) {
 
          if( id->GetDataSets().size() ) {
-            REPORT_ERROR( "Can't use DataSet-s as input in LOCAL mode!" );
+            REPORT_ERROR( "Can't use DataSet-s as input in LOCAL/FORK "
+                          "mode!" );
             REPORT_ERROR( "Skipping InputData type: " << id->GetType()
                           << " version: " << id->GetVersion() );
             continue;
@@ -610,10 +1636,88 @@ void SCycleController::ExecuteNextCycle() {
          //
          // Run the cycle:
          //
-         chain.Process( cycle, "", evmax, id->GetNEventsSkip() );
+         if( config.GetRunMode() == SCycleConfig::FORK ) {
+
+            if( ! ExecuteForked( cycle, chain, id->GetShardNEventsSkip(), evmax,
+                                 config.GetProofNodes() ) ) {
+               REPORT_ERROR( "There was an error processing:" );
+               REPORT_ERROR( "  Cycle      = " << cycle->GetName() );
+               REPORT_ERROR( "  ID type    = " << inputData.GetType() );
+               REPORT_ERROR( "  ID version = " << inputData.GetVersion() );
+               REPORT_ERROR( "Stopping the execution of this cycle!" );
+               break;
+            }
 
-         // Get the output objects from the cycle:
-         outputs = cycle->GetOutputList();
+            // Get the merged output objects of the workers:
+            outputs = cycle->GetOutputList();
+
+         } else if( checkpoint ) {
+
+            //
+            // Process the events in chunks. The output of each chunk, except
+            // for the last one, is written to the output file right away,
+            // and the progress is recorded in the checkpoint file. The last
+            // chunk is handled like a normal job.
+            //
+            std::vector< EntryRange > chunks;
+            MakeCheckpointChunks( chain, id->GetShardNEventsSkip(), evmax,
+                                  config.GetCheckpointEvents(), chunks );
+            SCycleStatistics chunkStat( SFrame::RunStatisticsName );
+            for( size_t i = 0; i < chunks.size(); ++i ) {
+
+               // Skip the chunks processed before the checkpoint:
+               const Long64_t chunkEnd = chunks[ i ].first + chunks[ i ].second;
+               if( chunkEnd <= resumeEntries ) continue;
+
+               // Process the events of the chunk:
+               chain.Process( cycle, "", chunks[ i ].second,
+                              chunks[ i ].first );
+               outputs = cycle->GetOutputList();
+               if( ( i + 1 == chunks.size() ) || ( ! outputs ) ) continue;
+
+               // Remember the statistics of this chunk:
+               TObject* tstat =
+                  outputs->FindObject( SFrame::RunStatisticsName );
+               if( tstat ) {
+                  TList stats;
+                  stats.Add( tstat );
+                  chunkStat.Merge( &stats );
+               }
+               CollectBranchUsage( outputs, branchUsage );
+               CollectEventLists( outputs, eventLists );
+
+               // Write the output of the chunk, and the checkpoint:
+               WriteCycleOutput( outputs, outputFileName,
+                                 config.GetStringConfig( &inputData ),
+                                 updateOutput );
+               updateOutput = kTRUE;
+#if ROOT_VERSION_CODE < ROOT_VERSION( 5, 28, 0 )
+               outputs->SetOwner( kTRUE );
+#endif
+               outputs->Clear();
+               outputs = 0;
+               WriteCheckpoint( checkpointFile, idIndex, chunkEnd );
+            }
+
+            // Add the statistics of the previous chunks to the last one:
+            SCycleStatistics* lastStat = 0;
+            if( outputs ) {
+               lastStat = dynamic_cast< SCycleStatistics* >(
+                  outputs->FindObject( SFrame::RunStatisticsName ) );
+            }
+            if( lastStat && chunkStat.GetProcessedEvents() ) {
+               TList stats;
+               stats.Add( &chunkStat );
+               lastStat->Merge( &stats );
+            }
+
+         } else {
+
+            chain.Process( cycle, "", evmax, id->GetShardNEventsSkip() );
+
+            // Get the output objects from the cycle:
+            outputs = cycle->GetOutputList();
+         }
 
       } else if( config.GetRunMode() == SCycleConfig::PROOF ) {
 
@@ -684,6 +1788,14 @@ void SCycleController::ExecuteNextCycle() {
             m_proof->AddInput( configList.At( i ) );
          }
 
+         // Print the progress reported by the workers during the processing.
+         // (The object disconnects from PROOF when going out of scope.)
+         const Long64_t nevents = inputData.GetEventsTotal();
+         SProgressMonitor progress( config.GetProgressInterval() );
+         progress.Start( nevents > 0 ? ( evmax < nevents ? evmax : nevents ) :
+                         -1 );
+         progress.Connect( m_proof );
+
          if( id->GetDataSets().size() ) {
 
             // Merge the dataset names in the way that PROOF expects them. This
@@ -705,7 +1817,7 @@ void SCycleController::ExecuteNextCycle() {
 
             // Process the events:
             if( m_proof->Process( dsets, cycle->GetName(), "", evmax,
-                                  id->GetNEventsSkip() ) == -1 ) {
+                                  id->GetShardNEventsSkip() ) == -1 ) {
                REPORT_ERROR( "There was an error processing:" );
                REPORT_ERROR( "  Cycle      = " << cycle->GetName() );
                REPORT_ERROR( "  ID type    = " << inputData.GetType() );
@@ -737,7 +1849,7 @@ void SCycleController::ExecuteNextCycle() {
 
                // Process the events:
                if( m_proof->Process( &set, cycle->GetName(), "", evmax,
-                                     id->GetNEventsSkip() ) == -1 ) {
+                                     id->GetShardNEventsSkip() ) == -1 ) {
                   REPORT_ERROR( "There was an error processing:" );
                   REPORT_ERROR( "  Cycle      = " << cycle->GetName() );
                   REPORT_ERROR( "  ID type    = " << inputData.GetType() );
@@ -756,7 +1868,7 @@ void SCycleController::ExecuteNextCycle() {
                // nasty crashes...
                //
                if( m_proof->Process( id->GetDSet(), cycle->GetName(), "", evmax,
-                                     id->GetNEventsSkip() ) == -1 ) {
+                                     id->GetShardNEventsSkip() ) == -1 ) {
                   REPORT_ERROR( "There was an error processing:" );
                   REPORT_ERROR( "  Cycle      = " << cycle->GetName() );
                   REPORT_ERROR( "  ID type    = " << inputData.GetType() );
@@ -811,6 +1923,39 @@ void SCycleController::ExecuteNextCycle() {
          throw SError( "Running mode not recognised!", SError::SkipCycle );
       }
 
+      //
+      // Write out the objects produced by the cycles executed in the same
+      // event loop:
+      //
+      for( size_t i = 0; i < companions.size(); ++i ) {
+
+         TList* coutputs = ( companionUsed[ i ] ?
+                             companions[ i ]->GetOutputList() : 0 );
+         if( ! coutputs ) continue;
+
+         TObject* tcstat = coutputs->FindObject( SFrame::RunStatisticsName );
+         SCycleStatistics* cstat = dynamic_cast< SCycleStatistics* >( tcstat );
+         if( cstat ) {
+            m_logger << INFO << "Cycle '" << companions[ i ]->GetName()
+                     << "' processed " << cstat->GetProcessedEvents()
+                     << " events, skipped " << cstat->GetSkippedEvents()
+                     << SLogger::endmsg;
+         }
+         const TString cFileName =
+            OutputFileName( companionConfigs[ i ], companions[ i ]->GetName(),
+                            *id );
+         WriteCycleOutput( coutputs, cFileName,
+                           companionConfigs[ i ].GetStringConfig(
+                              &companionIds[ i ] ),
+                           updateOutput, companions[ i ] );
+         CollectBranchUsage( coutputs, *companionUsages[ i ] );
+         CollectEventLists( coutputs, *companionEvents[ i ] );
+#if ROOT_VERSION_CODE < ROOT_VERSION( 5, 28, 0 )
+         coutputs->SetOwner( kTRUE );
+#endif
+         coutputs->Clear();
+      }
+
       // Check that the cycle output is available:
       if( ! outputs ) {
          REPORT_ERROR( "Cycle output could not be retrieved." );
@@ -823,11 +1968,20 @@ void SCycleController::ExecuteNextCycle() {
       //
       // Collect the statistics from this input data:
       //
+      CollectBranchUsage( outputs, branchUsage );
+      CollectEventLists( outputs, eventLists );
       TObject* tstat = outputs->FindObject( SFrame::RunStatisticsName );
       SCycleStatistics* stat = dynamic_cast< SCycleStatistics* >( tstat );
       if( stat ) {
          procev += stat->GetProcessedEvents();
          skipev += stat->GetSkippedEvents();
+         workerReal += stat->GetRealTime();
+         workerCpu += stat->GetCpuTime();
+         bytesRead += stat->GetBytesRead();
+         bytesWritten += stat->GetBytesWritten();
+         if( stat->GetPeakRSS() > peakRSS ) {
+            peakRSS = stat->GetPeakRSS();
+         }
       } else {
          m_logger << WARNING << "Cycle statistics not received from: "
                   << cycle->GetName() << SLogger::endmsg;
@@ -836,14 +1990,82 @@ void SCycleController::ExecuteNextCycle() {
       }
 
       //
-      // Write out the objects produced by the cycle:
+      // Write out the objects produced by the cycle. Only one background
+      // writer process is kept running at a time. This also makes sure that
+      // an output file is complete by the time that it gets updated with
+      // the output of the next input data.
+      //
+      TStopwatch mergeTimer;
+      mergeTimer.Start();
+      if( writer > 0 ) {
+         if( ! WaitForProcess( writer ) ) {
+            REPORT_ERROR( "The background process writing the output of the "
+                          "previous input data failed" );
+         }
+         writer = -1;
+      }
+      if( backgroundMerge ) {
+         idTimer.Stop();
+         writer = fork();
+         if( writer < 0 ) {
+            REPORT_ERROR( "Couldn't start background process for writing the "
+                          "output, writing it right away" );
+         } else if( writer == 0 ) {
+            // This is the writer process. It also writes the metrics of the
+            // input data, as only it knows how long the writing took:
+            Int_t status = 0;
+            try {
+               WriteCycleOutput( outputs, outputFileName,
+                                 config.GetStringConfig( &inputData ),
+                                 updateOutput );
+               mergeTimer.Stop();
+               if( m_metricsFile != "" ) {
+                  WriteMetrics( InputDataRecords( cycleName, *id,
+                                                  outputFileName, stat,
+                                                  idTimer.RealTime(),
+                                                  idTimer.CpuTime(),
+                                                  mergeTimer.RealTime() ) );
+               }
+            } catch( const SError& error ) {
+               REPORT_ERROR( "Failed writing the output with message: "
+                             << error.what() );
+               status = 1;
+            } catch( ... ) {
+               REPORT_ERROR( "Failed writing the output with an unknown "
+                             "exception" );
+               status = 1;
+            }
+            // Exit without running any of the cleanup of the parent process:
+            SLogWriter::Instance()->Flush();
+            _exit( status );
+         } else {
+            m_logger << DEBUG << "Writing the output in background process "
+                     << writer << SLogger::endmsg;
+         }
+      }
+      if( writer < 0 ) {
+         WriteCycleOutput( outputs, outputFileName,
+                           config.GetStringConfig( &inputData ),
+                           updateOutput );
+      }
+      mergeTimer.Stop();
+      mergeTime += mergeTimer.RealTime();
+      idTimer.Stop();
+
+      // Record that this input data is fully processed:
+      if( checkpoint ) {
+         WriteCheckpoint( checkpointFile, idIndex + 1, 0 );
+      }
+
+      //
+      // Write the metrics of this input data, and of the workers/files that
+      // processed it:
       //
-      TString outputFileName = config.GetOutputDirectory() + cycleName + "." +
-         id->GetType() + "." + id->GetVersion() + config.GetPostFix() + ".root";
-      outputFileName.ReplaceAll( "::", "." );
-      WriteCycleOutput( outputs, outputFileName,
-                        config.GetStringConfig( &inputData ),
-                        updateOutput );
+      if( ( m_metricsFile != "" ) && ( writer < 0 ) ) {
+         WriteMetrics( InputDataRecords( cycleName, *id, outputFileName, stat,
+                                         idTimer.RealTime(), idTimer.CpuTime(),
+                                         mergeTimer.RealTime() ) );
+      }
 
       // This cleanup is giving me endless trouble on the NYU Tier3 with
       // ROOT 5.28c. So, knowing no better solution, I just disabled it
@@ -855,10 +2077,53 @@ void SCycleController::ExecuteNextCycle() {
 
    }
 
+   //
+   // Wait for the output of the last input data to be written:
+   //
+   if( writer > 0 ) {
+      TStopwatch mergeTimer;
+      mergeTimer.Start();
+      if( ! WaitForProcess( writer ) ) {
+         REPORT_ERROR( "The background process writing the output of the "
+                       "last input data failed" );
+      }
+      mergeTimer.Stop();
+      mergeTime += mergeTimer.RealTime();
+   }
+
    //
    // The end cycle function has to be called here by hand:
    //
    cycle->EndCycle();
+   for( size_t i = 0; i < companions.size(); ++i ) {
+      companions[ i ]->EndCycle();
+      delete companionLists[ i ];
+   }
+
+   //
+   // Report which input branches were used by the cycles:
+   //
+   ReportBranchUsage( config, branchUsage );
+   for( size_t i = 0; i < companions.size(); ++i ) {
+      ReportBranchUsage( companionConfigs[ i ], *companionUsages[ i ] );
+      delete companionUsages[ i ];
+   }
+
+   //
+   // Store the events passing the selections of the cycles:
+   //
+   UpdateEventListCache( config, eventLists );
+   for( size_t i = 0; i < companions.size(); ++i ) {
+      UpdateEventListCache( companionConfigs[ i ], *companionEvents[ i ] );
+      delete companionEvents[ i ];
+   }
+   cycle->SetPipelineSink( 0, kFALSE );
+   cycle->ClearSharedScan();
+
+   // The cycle finished, so its checkpoint is not needed anymore:
+   if( checkpoint ) {
+      gSystem->Unlink( checkpointFile );
+   }
 
    // The cycle processing is done at this point:
    timer.Stop();
@@ -875,7 +2140,31 @@ void SCycleController::ExecuteNextCycle() {
             << " s  - " << std::setw( 5 ) << std::setprecision( 0 )
             << ( procev / timer.CpuTime() ) << " Hz" << SLogger::endmsg;
 
-   ++m_curCycle;
+   // Write the summary of the cycle into the metrics file:
+   if( m_metricsFile != "" ) {
+      const Long64_t masterRSS = SMetricsRecord::GetPeakRSS();
+      SMetricsRecord record( "cycle" );
+      record.Add( "cycle", cycleName.Data() );
+      record.Add( "run_mode", ( config.GetRunMode() == SCycleConfig::LOCAL ?
+                                "LOCAL" :
+                                ( config.GetRunMode() == SCycleConfig::PROOF ?
+                                  "PROOF" : "FORK" ) ) );
+      record.Add( "events_processed", procev );
+      record.Add( "events_skipped", skipev );
+      record.Add( "real_time", timer.RealTime() );
+      record.Add( "cpu_time", timer.CpuTime() );
+      record.Add( "worker_real_time", workerReal );
+      record.Add( "worker_cpu_time", workerCpu );
+      record.Add( "bytes_read", bytesRead );
+      record.Add( "bytes_written", bytesWritten );
+      record.Add( "merge_time", mergeTime );
+      record.Add( "peak_rss_kb", ( masterRSS > peakRSS ? masterRSS :
+                                   peakRSS ) );
+      WriteMetrics( std::vector< std::string >( 1, record.GetJSON() ) );
+   }
+
+   // Skip over the cycles that were executed in the same event loop:
+   m_curCycle += 1 + static_cast< UInt_t >( companions.size() );
    return;
 }
 
@@ -957,21 +2246,32 @@ void SCycleController::ShutDownProof() {
  * this output file from the objects transmitted to the client through the
  * network, and from the file created by TProofOutputFile.
  *
+ * When the cycle doesn't merge its output ntuples, the ntuple files of the
+ * workers are kept next to the output file instead, and are listed in an
+ * index file that can be used as an input file of a later cycle.
+ *
  * @param olist The list of objects kept/merged in memory
  * @param filename The name of the output file to create
  * @param config The configuration string to store in the file as metadata
  * @param update Flag deciding if the output file should be updated or
  *               overwritten
+ * @param cycle The cycle that produced the output, if it's not the current
+ *              one
  */
 void SCycleController::WriteCycleOutput( TList* olist,
                                          const TString& filename,
                                          const TString& config,
-                                         Bool_t update ) const {
+                                         Bool_t update,
+                                         const ISCycleBase* cycle ) const {
+
+   // The cycle that produced the output:
+   if( ! cycle ) {
+      cycle = m_analysisCycles.at( m_curCycle );
+   }
 
    // Let the user know what's happening:
-   m_logger << INFO << "Writing output of \""
-            << m_analysisCycles.at( m_curCycle )->GetName() << "\" to: "
-            << filename << SLogger::endmsg;
+   m_logger << INFO << "Writing output of \"" << cycle->GetName()
+            << "\" to: " << filename << SLogger::endmsg;
 
    //
    // Open the output file:
@@ -984,6 +2284,13 @@ void SCycleController::WriteCycleOutput( TList* olist,
    //
    std::vector< TString > filesToMerge;
 
+   //
+   // The ntuple files that are kept separate from the output file, when the
+   // ntuples are not supposed to be merged:
+   //
+   const Bool_t mergeNTuples = cycle->GetConfig().GetMergeNTuples();
+   std::vector< TString > ntupleFiles;
+
    //
    // Merge the memory objects into the output file:
    //
@@ -996,12 +2303,23 @@ void SCycleController::WriteCycleOutput( TList* olist,
          m_logger << DEBUG << "Written object: " << olist->At( i )->GetName()
                   << SLogger::endmsg;
       } else if( dynamic_cast< TProofOutputFile* >( olist->At( i ) ) ) {
+         // In "dataset mode" the files are described by a TFileCollection:
+         if( ! mergeNTuples ) continue;
          TProofOutputFile* pfile =
             dynamic_cast< TProofOutputFile* >( olist->At( i ) );
          filesToMerge.push_back( pfile->GetOutputFileName() );
       } else if ( dynamic_cast< SOutputFile* >( olist->At( i ) ) ) {
          SOutputFile* sfile = dynamic_cast< SOutputFile* >( olist->At( i ) );
          filesToMerge.push_back( sfile->GetFileName() );
+      } else if( dynamic_cast< TFileCollection* >( olist->At( i ) ) ) {
+         // The unmerged ntuple files of the PROOF workers:
+         TFileCollection* coll =
+            dynamic_cast< TFileCollection* >( olist->At( i ) );
+         TIter next( coll->GetList() );
+         TFileInfo* info = 0;
+         while( ( info = dynamic_cast< TFileInfo* >( next() ) ) ) {
+            ntupleFiles.push_back( info->GetCurrentUrl()->GetUrl() );
+         }
       } else {
          /*
          TDirectory* proofdir = outputFile.GetDirectory( "PROOF" );
@@ -1042,7 +2360,32 @@ void SCycleController::WriteCycleOutput( TList* olist,
    //
    // Merge the TTree contents of the temporary files into our output file:
    //
-   if( filesToMerge.size() ) {
+   if( filesToMerge.size() && ( ! mergeNTuples ) ) {
+
+      //
+      // Keep the ntuple files of the workers as they are, just move them next
+      // to the output file:
+      //
+      Int_t index = 0;
+      for( std::vector< TString >::const_iterator mfile = filesToMerge.begin();
+           mfile != filesToMerge.end(); ++mfile ) {
+         // Find the first unused file name:
+         TString ntupleFile = NTupleFileName( filename, index++ );
+         while( update && ( ! gSystem->AccessPathName( ntupleFile ) ) ) {
+            ntupleFile = NTupleFileName( filename, index++ );
+         }
+         // Try to simply rename the file, and if that doesn't work, because
+         // it's on a different file system, copy it:
+         if( gSystem->Rename( *mfile, ntupleFile ) &&
+             gSystem->CopyFile( *mfile, ntupleFile, kTRUE ) ) {
+            REPORT_ERROR( "Failed to move \"" << *mfile << "\" to \""
+                          << ntupleFile << "\"" );
+            continue;
+         }
+         ntupleFiles.push_back( ntupleFile );
+      }
+
+   } else if( filesToMerge.size() ) {
 
       m_logger << DEBUG << "Merging disk-resident TTrees into \""
                << filename << "\"" << SLogger::endmsg;
@@ -1065,6 +2408,9 @@ void SCycleController::WriteCycleOutput( TList* olist,
             REPORT_ERROR( "Failed to execute the file merging" );
          }
       }
+   }
+
+   if( filesToMerge.size() ) {
 
       // Remove the temporary files:
       for( std::vector< TString >::const_iterator mfile = filesToMerge.begin();
@@ -1081,5 +2427,479 @@ void SCycleController::WriteCycleOutput( TList* olist,
       }
    }
 
+   //
+   // Write the index of the unmerged ntuple files. The files next to the
+   // index file are listed with relative paths, so that the files could be
+   // moved together.
+   //
+   if( ntupleFiles.size() ) {
+      const TString indexName = NTupleIndexName( filename );
+      const TString indexDir = gSystem->DirName( indexName );
+      std::ofstream index( indexName.Data(),
+                           ( update ? std::ios::app : std::ios::trunc ) );
+      if( ! index.is_open() ) {
+         REPORT_ERROR( "Couldn't write ntuple index file: " << indexName );
+      } else {
+         for( std::vector< TString >::const_iterator nfile =
+                 ntupleFiles.begin(); nfile != ntupleFiles.end(); ++nfile ) {
+            if( gSystem->DirName( *nfile ) == indexDir ) {
+               index << gSystem->BaseName( *nfile ) << std::endl;
+            } else {
+               index << *nfile << std::endl;
+            }
+         }
+         m_logger << INFO << "Output ntuples written to " << ntupleFiles.size()
+                  << " file(s), listed in: " << indexName << SLogger::endmsg;
+      }
+   }
+
+   return;
+}
+
+/**
+ * The job metrics file is written in the "newline delimited JSON" format, so
+ * each record is written as a separate line. The file is kept closed between
+ * the calls, so that it can be followed while the job is running.
+ *
+ * @param records The records (single line JSON objects) to write
+ * @param truncate If <code>kTRUE</code>, the previous contents of the file are
+ *                 discarded
+ */
+void SCycleController::WriteMetrics( const std::vector< std::string >& records,
+                                     Bool_t truncate ) const {
+
+   std::ofstream file( m_metricsFile.Data(),
+                       truncate ? std::ios::trunc : std::ios::app );
+   if( ! file.is_open() ) {
+      REPORT_ERROR( "Couldn't open job metrics file: " << m_metricsFile );
+      return;
+   }
+
+   std::vector< std::string >::const_iterator itr = records.begin();
+   std::vector< std::string >::const_iterator end = records.end();
+   for( ; itr != end; ++itr ) {
+      file << *itr << "\n";
+   }
+
+   return;
+}
+
+/**
+ * The checkpoint file is a simple text file, holding the index of the input
+ * data being processed, and the number of entries of the input data
+ * already written to the output file.
+ *
+ * @param fileName Name of the checkpoint file
+ * @param inputData The index of the input data being processed
+ * @param entries The number of entries already processed from the input data
+ * @returns <code>kTRUE</code> if a checkpoint was found, <code>kFALSE</code>
+ *          otherwise
+ */
+Bool_t SCycleController::ReadCheckpoint( const TString& fileName,
+                                         Int_t& inputData,
+                                         Long64_t& entries ) const {
+
+   std::ifstream file( fileName.Data() );
+   if( ! file.is_open() ) {
+      return kFALSE;
+   }
+
+   std::string line;
+   while( std::getline( file, line ) ) {
+      if( line.empty() || ( line[ 0 ] == '#' ) ) continue;
+      std::istringstream values( line );
+      if( values >> inputData >> entries ) {
+         return kTRUE;
+      }
+   }
+
+   REPORT_ERROR( "Couldn't interpret checkpoint file: " << fileName );
+   inputData = 0;
+   entries = 0;
+   return kFALSE;
+}
+
+/**
+ * The file is first written under a temporary name, and then renamed. This
+ * way a job killed in the middle of writing the checkpoint doesn't leave a
+ * corrupt checkpoint behind.
+ *
+ * @param fileName Name of the checkpoint file
+ * @param inputData The index of the input data being processed
+ * @param entries The number of entries already processed from the input data
+ */
+void SCycleController::WriteCheckpoint( const TString& fileName,
+                                        Int_t inputData,
+                                        Long64_t entries ) const {
+
+   const TString tmpName = fileName + ".tmp";
+   {
+      std::ofstream file( tmpName.Data(), std::ios::trunc );
+      if( ! file.is_open() ) {
+         REPORT_ERROR( "Couldn't write checkpoint file: " << tmpName );
+         return;
+      }
+      file << "# SFrame checkpoint: <InputData index> <processed entries>\n"
+           << inputData << " " << entries << "\n";
+   }
+   if( gSystem->Rename( tmpName, fileName ) ) {
+      REPORT_ERROR( "Couldn't create checkpoint file: " << fileName );
+   }
+
+   return;
+}
+
+/**
+ * This function implements the FORK running mode. The master side of the
+ * cycle is initialised in the current process, then the requested number of
+ * worker processes are forked from it. The workers share all the loaded
+ * libraries and the configuration of the job with the parent process, so
+ * starting them is practically free.
+ *
+ * The workers request the entries to process in packets from the parent
+ * process through a socket pair, and send back their output objects through
+ * the same socket at the end. The output objects are merged into the output
+ * list of the cycle, just as PROOF would do it.
+ *
+ * @param cycle The cycle to execute
+ * @param chain The chain with all the input files of the input data
+ * @param first The first entry to process
+ * @param nentries The maximal number of entries to process
+ * @param nWorkers The number of worker processes to use. If it's not
+ *                 positive, the number of CPUs of the machine is used.
+ * @returns <code>kTRUE</code> if the processing was successful,
+ *          <code>kFALSE</code> otherwise
+ */
+Bool_t SCycleController::ExecuteForked( ISCycleBase* cycle, TChain& chain,
+                                        Long64_t first, Long64_t nentries,
+                                        Int_t nWorkers ) const {
+
+   // Use as many workers as there are CPUs, if not specified otherwise:
+   if( nWorkers <= 0 ) {
+      SysInfo_t sysInfo;
+      gSystem->GetSysInfo( &sysInfo );
+      nWorkers = ( sysInfo.fCpus > 0 ? sysInfo.fCpus : 1 );
+   }
+
+   // Set up the distribution of the entries between the workers:
+   SPacketizer packetizer( nWorkers );
+   packetizer.Initialize( chain, first, nentries );
+
+   // Run the master-side initialisation of the cycle:
+   cycle->Begin( &chain );
+
+   //
+   // Start the worker processes:
+   //
+   std::vector< pid_t > pids;
+   std::vector< int > sockets;
+   for( Int_t i = 0; i < nWorkers; ++i ) {
+      int fds[ 2 ];
+      if( socketpair( AF_UNIX, SOCK_STREAM, 0, fds ) ) {
+         REPORT_ERROR( "Couldn't create socket for worker #" << i );
+         break;
+      }
+      const pid_t pid = fork();
+      if( pid < 0 ) {
+         REPORT_ERROR( "Couldn't fork worker #" << i );
+         close( fds[ 0 ] );
+         close( fds[ 1 ] );
+         break;
+      }
+      if( pid == 0 ) {
+         // This is the worker process. It only needs its own socket:
+         for( size_t j = 0; j < sockets.size(); ++j ) {
+            close( sockets[ j ] );
+         }
+         close( fds[ 0 ] );
+         // Make sure that the worker always reaches _exit(...), even if it
+         // fails with an unexpected exception:
+         Int_t status = 1;
+         try {
+            status = ExecuteForkWorker( cycle, chain, i, fds[ 1 ] );
+         } catch( ... ) {
+            REPORT_ERROR( "Worker #" << i << " failed with an unknown "
+                          "exception" );
+         }
+         close( fds[ 1 ] );
+         // Exit without running any of the cleanup of the parent process:
+         SLogWriter::Instance()->Flush();
+         _exit( status );
+      }
+      close( fds[ 1 ] );
+      pids.push_back( pid );
+      sockets.push_back( fds[ 0 ] );
+   }
+   if( pids.empty() ) {
+      REPORT_ERROR( "Couldn't start any worker processes" );
+      return kFALSE;
+   }
+   m_logger << INFO << "Started " << pids.size() << " worker processes"
+            << SLogger::endmsg;
+
+   //
+   // Serve the requests of the workers, until all of them are done:
+   //
+   SCycleProgress progress( SFrame::CycleProgressName );
+   SProgressMonitor monitor( cycle->GetConfig().GetProgressInterval() );
+   monitor.Start( packetizer.GetTotalEntries() );
+   const Double_t start = SProgressMonitor::Now();
+   std::vector< Long64_t > events( sockets.size(), 0 );
+   std::vector< Bool_t > finished( sockets.size(), kFALSE );
+   Bool_t success = kTRUE;
+   size_t active = sockets.size();
+   while( active ) {
+
+      // Wait for any of the workers to send something:
+      std::vector< pollfd > fds;
+      std::vector< size_t > workers;
+      for( size_t i = 0; i < sockets.size(); ++i ) {
+         if( sockets[ i ] < 0 ) continue;
+         pollfd fd;
+         fd.fd = sockets[ i ];
+         fd.events = POLLIN;
+         fd.revents = 0;
+         fds.push_back( fd );
+         workers.push_back( i );
+      }
+      if( poll( &fds[ 0 ], fds.size(), -1 ) < 0 ) {
+         if( errno == EINTR ) continue;
+         REPORT_ERROR( "Failed to wait for the worker processes" );
+         success = kFALSE;
+         break;
+      }
+
+      for( size_t i = 0; i < fds.size(); ++i ) {
+
+         if( ! fds[ i ].revents ) continue;
+         const size_t worker = workers[ i ];
+         const int socket = sockets[ worker ];
+
+         if( finished[ worker ] ) {
+            //
+            // Receive the output of a worker that finished processing:
+            //
+            Long64_t size = 0;
+            std::vector< char > data;
+            if( ReadAll( socket, &size, sizeof( size ) ) && ( size > 0 ) ) {
+               data.resize( size );
+            }
+            if( data.size() && ReadAll( socket, &data[ 0 ], size ) ) {
+               TBufferFile buffer( TBuffer::kRead, size, &data[ 0 ], kFALSE );
+               TList* workerOutput =
+                  dynamic_cast< TList* >( buffer.ReadObject( TList::Class() ) );
+               if( workerOutput ) {
+                  MergeForkOutput( cycle->GetOutputList(), workerOutput );
+               } else {
+                  REPORT_ERROR( "Couldn't read the output of worker #"
+                                << worker );
+                  success = kFALSE;
+               }
+            } else {
+               REPORT_ERROR( "Couldn't receive the output of worker #"
+                             << worker );
+               success = kFALSE;
+            }
+            close( socket );
+            sockets[ worker ] = -1;
+            --active;
+            continue;
+         }
+
+         //
+         // Answer the packet request of the worker:
+         //
+         ForkRequest request;
+         if( ! ReadAll( socket, &request, sizeof( request ) ) ) {
+            REPORT_ERROR( "Worker #" << worker << " stopped unexpectedly" );
+            success = kFALSE;
+            close( socket );
+            sockets[ worker ] = -1;
+            --active;
+            continue;
+         }
+         packetizer.Report( worker, request.entries, request.realTime );
+         events[ worker ] += request.entries;
+         const TString workerName =
+            TString::Format( "worker-%i", static_cast< Int_t >( worker ) );
+         progress.Update( workerName.Data(), events[ worker ],
+                          SProgressMonitor::Now() - start );
+         monitor.Update( progress );
+
+         SPacketizer::Packet packet;
+         if( ! packetizer.Next( worker, packet ) ) {
+            packet.first = 0;
+            packet.entries = 0;
+            finished[ worker ] = kTRUE;
+         }
+         if( ! WriteAll( socket, &packet, sizeof( packet ) ) ) {
+            REPORT_ERROR( "Couldn't send packet to worker #" << worker );
+            success = kFALSE;
+            close( socket );
+            sockets[ worker ] = -1;
+            --active;
+         }
+      }
+   }
+   monitor.Update( progress, kTRUE );
+
+   //
+   // Wait for all the workers to exit:
+   //
+   for( size_t i = 0; i < pids.size(); ++i ) {
+      if( sockets[ i ] >= 0 ) {
+         close( sockets[ i ] );
+      }
+      int status = 0;
+      while( ( waitpid( pids[ i ], &status, 0 ) < 0 ) &&
+             ( errno == EINTR ) ) {}
+      if( ( ! WIFEXITED( status ) ) || WEXITSTATUS( status ) ) {
+         REPORT_ERROR( "Worker #" << i << " failed" );
+         success = kFALSE;
+      }
+      REPORT_VERBOSE( "Worker #" << i << " processed " << events[ i ]
+                      << " events in " << packetizer.GetPackets( i )
+                      << " packets, stealing work " << packetizer.GetSteals( i )
+                      << " times" );
+   }
+
+   // Run the master-side finalisation of the cycle on the merged output:
+   if( success ) {
+      cycle->Terminate();
+   }
+
+   return success;
+}
+
+/**
+ * This function is executed in the forked worker processes. It runs the
+ * worker-side functions of the cycle like ROOT would do it in LOCAL mode,
+ * but only for the packets of entries received from the parent process.
+ * The output objects of the cycle are sent back to the parent at the end.
+ *
+ * @param cycle The cycle to execute
+ * @param chain The chain with all the input files of the input data
+ * @param worker The index of this worker
+ * @param socket The socket for communicating with the parent process
+ * @returns The exit status of the worker process
+ */
+Int_t SCycleController::ExecuteForkWorker( ISCycleBase* cycle, TChain& chain,
+                                           Int_t worker, int socket ) const {
+
+   // Create a new chain, so that this process wouldn't share the open input
+   // file of the parent:
+   TChain workerChain( chain.GetName() );
+   workerChain.Add( &chain );
+
+   try {
+
+      cycle->SlaveBegin( &workerChain );
+      cycle->Init( &workerChain );
+      workerChain.SetNotify( cycle );
+
+      // Process the packets until the parent has no more:
+      ForkRequest request;
+      request.entries = 0;
+      request.realTime = 0.0;
+      SPacketizer::Packet packet;
+      while( kTRUE ) {
+         if( ( ! WriteAll( socket, &request, sizeof( request ) ) ) ||
+             ( ! ReadAll( socket, &packet, sizeof( packet ) ) ) ) {
+            REPORT_ERROR( "Worker #" << worker << " lost connection to the "
+                          "parent process" );
+            return 1;
+         }
+         if( packet.entries <= 0 ) break;
+
+         TStopwatch timer;
+         timer.Start();
+         const Long64_t end = packet.first + packet.entries;
+         for( Long64_t entry = packet.first; entry < end; ++entry ) {
+            const Long64_t localEntry = workerChain.LoadTree( entry );
+            if( localEntry < 0 ) {
+               REPORT_ERROR( "Worker #" << worker << " couldn't load entry "
+                             << entry );
+               return 1;
+            }
+            cycle->Process( localEntry );
+         }
+         timer.Stop();
+         request.entries = packet.entries;
+         request.realTime = timer.RealTime();
+      }
+
+      cycle->SlaveTerminate();
+
+   } catch( const SError& error ) {
+      REPORT_ERROR( "Worker #" << worker << " failed with message: "
+                    << error.what() );
+      return 1;
+   } catch( ... ) {
+      REPORT_ERROR( "Worker #" << worker << " failed with an unknown "
+                    "exception" );
+      return 1;
+   }
+
+   // Send the output objects to the parent:
+   TBufferFile buffer( TBuffer::kWrite );
+   buffer.WriteObject( cycle->GetOutputList() );
+   const Long64_t size = buffer.Length();
+   if( ( ! WriteAll( socket, &size, sizeof( size ) ) ) ||
+       ( ! WriteAll( socket, buffer.Buffer(), size ) ) ) {
+      REPORT_ERROR( "Worker #" << worker << " couldn't send its output" );
+      return 1;
+   }
+
+   return 0;
+}
+
+/**
+ * The objects received from a worker are either added to the output list, or
+ * merged into the object of the same name already in the list. The temporary
+ * ntuple files of the workers are all kept, they are merged by
+ * WriteCycleOutput(...) later on.
+ *
+ * @param output The output list of the cycle
+ * @param workerOutput The output list received from a worker. It's deleted
+ *                     by the function.
+ */
+void SCycleController::MergeForkOutput( TList* output,
+                                        TList* workerOutput ) const {
+
+   TIter next( workerOutput );
+   TObject* obj = 0;
+   while( ( obj = next() ) ) {
+
+      // Add the object to the output if there's nothing to merge it with:
+      TObject* existing = 0;
+      if( ! dynamic_cast< SOutputFile* >( obj ) ) {
+         existing = output->FindObject( obj->GetName() );
+      }
+      if( ! existing ) {
+         output->Add( obj );
+         continue;
+      }
+
+      // Merge the object into the existing one:
+      TMethodCall mergeMethod;
+      mergeMethod.InitWithPrototype( existing->IsA(), "Merge",
+                                     "TCollection*" );
+      if( mergeMethod.IsValid() ) {
+         TList list;
+         list.Add( obj );
+         mergeMethod.SetParam( ( Long_t ) &list );
+         mergeMethod.Execute( existing );
+      } else {
+         REPORT_ERROR( "Object \"" << obj->GetName() << "\" of type \""
+                       << obj->ClassName() << "\" can't be merged" );
+      }
+      delete obj;
+   }
+
+   // Delete the received list, without touching its objects:
+   workerOutput->SetOwner( kFALSE );
+   workerOutput->Clear();
+   delete workerOutput;
+
    return;
 }
@@ -0,0 +1,141 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+// ROOT include(s):
+#include <TCollection.h>
+
+// Local include(s):
+#include "../include/SCycleProgress.h"
+
+#ifndef DOXYGEN_IGNORE
+ClassImp( SCycleProgress )
+#endif // DOXYGEN_IGNORE
+
+/**
+ * @param name The name of the object
+ */
+SCycleProgress::SCycleProgress( const char* name )
+   : TNamed( name, "SFrame cycle progress" ),
+     m_workers(), m_events(), m_times() {
+
+}
+
+/**
+ * @param worker Name of the worker
+ * @param events Number of events processed by the worker so far
+ * @param time Time since the worker started processing (in seconds)
+ */
+void SCycleProgress::Update( const std::string& worker, Long64_t events,
+                             Double_t time ) {
+
+   for( size_t i = 0; i < m_workers.size(); ++i ) {
+      if( m_workers[ i ] == worker ) {
+         m_events[ i ] = events;
+         m_times[ i ] = time;
+         return;
+      }
+   }
+
+   m_workers.push_back( worker );
+   m_events.push_back( events );
+   m_times.push_back( time );
+   return;
+}
+
+/**
+ * @returns The number of workers known to the object
+ */
+size_t SCycleProgress::GetNWorkers() const {
+
+   return m_workers.size();
+}
+
+/**
+ * @param i Index of the worker
+ * @returns The name of the worker
+ */
+const std::string& SCycleProgress::GetWorker( size_t i ) const {
+
+   return m_workers.at( i );
+}
+
+/**
+ * @param i Index of the worker
+ * @returns The number of events processed by the worker
+ */
+Long64_t SCycleProgress::GetEvents( size_t i ) const {
+
+   return m_events.at( i );
+}
+
+/**
+ * @param i Index of the worker
+ * @returns The time since the worker started processing (in seconds)
+ */
+Double_t SCycleProgress::GetTime( size_t i ) const {
+
+   return m_times.at( i );
+}
+
+/**
+ * @param i Index of the worker
+ * @returns The processing rate of the worker (in Hz)
+ */
+Double_t SCycleProgress::GetRate( size_t i ) const {
+
+   return ( m_times.at( i ) > 0.0 ? m_events.at( i ) / m_times.at( i ) : 0.0 );
+}
+
+/**
+ * @returns The number of events processed by all the workers
+ */
+Long64_t SCycleProgress::GetTotalEvents() const {
+
+   Long64_t result = 0;
+   for( size_t i = 0; i < m_events.size(); ++i ) {
+      result += m_events[ i ];
+   }
+   return result;
+}
+
+/**
+ * The information of the workers is not added up, but collected. If the
+ * same worker shows up in multiple objects, the latest information is kept.
+ *
+ * @param coll The collection of objects to merge into this one
+ * @returns Zero if some problem happened, something else if everything was okay
+ */
+Int_t SCycleProgress::Merge( TCollection* coll ) {
+
+   //
+   // Return right away if the input is flawed:
+   //
+   if( ! coll ) return 0;
+   if( coll->IsEmpty() ) return 0;
+
+   TIter next( coll );
+   TObject* obj = 0;
+   while( ( obj = next() ) ) {
+
+      // Skip objects of the wrong type:
+      SCycleProgress* pobj = dynamic_cast< SCycleProgress* >( obj );
+      if( ! pobj ) continue;
+
+      // Collect the information of all the workers:
+      for( size_t i = 0; i < pobj->m_workers.size(); ++i ) {
+         Update( pobj->m_workers[ i ], pobj->m_events[ i ],
+                 pobj->m_times[ i ] );
+      }
+   }
+
+   return 1;
+}
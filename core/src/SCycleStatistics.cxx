@@ -30,6 +30,8 @@ SCycleStatistics::SCycleStatistics( const char* name, Long64_t procEvents,
                                     Long64_t skipEvents )
    : TNamed( name, "SFrame cycle statistics" ),
      m_processedEvents( procEvents ), m_skippedEvents( skipEvents ),
+     m_realTime( 0.0 ), m_cpuTime( 0.0 ), m_bytesRead( 0 ),
+     m_bytesWritten( 0 ), m_peakRSS( 0 ), m_records(),
      m_logger( "SCycleStatistics" ) {
 
 }
@@ -68,9 +70,112 @@ void SCycleStatistics::SetSkippedEvents( Long64_t events ) {
    return;
 }
 
+/**
+ * @returns The real time spent in the event loop (in seconds)
+ */
+Double_t SCycleStatistics::GetRealTime() const {
+
+   return m_realTime;
+}
+
+/**
+ * @param time The real time spent in the event loop (in seconds)
+ */
+void SCycleStatistics::SetRealTime( Double_t time ) {
+
+   m_realTime = time;
+   return;
+}
+
+/**
+ * @returns The CPU time spent in the event loop (in seconds)
+ */
+Double_t SCycleStatistics::GetCpuTime() const {
+
+   return m_cpuTime;
+}
+
+/**
+ * @param time The CPU time spent in the event loop (in seconds)
+ */
+void SCycleStatistics::SetCpuTime( Double_t time ) {
+
+   m_cpuTime = time;
+   return;
+}
+
+/**
+ * @returns The number of bytes read from the input files
+ */
+Long64_t SCycleStatistics::GetBytesRead() const {
+
+   return m_bytesRead;
+}
+
+/**
+ * @param bytes The number of bytes read from the input files
+ */
+void SCycleStatistics::SetBytesRead( Long64_t bytes ) {
+
+   m_bytesRead = bytes;
+   return;
+}
+
+/**
+ * @returns The number of bytes written to the output files
+ */
+Long64_t SCycleStatistics::GetBytesWritten() const {
+
+   return m_bytesWritten;
+}
+
+/**
+ * @param bytes The number of bytes written to the output files
+ */
+void SCycleStatistics::SetBytesWritten( Long64_t bytes ) {
+
+   m_bytesWritten = bytes;
+   return;
+}
+
+/**
+ * @returns The largest peak memory usage of the workers (in kB)
+ */
+Long64_t SCycleStatistics::GetPeakRSS() const {
+
+   return m_peakRSS;
+}
+
+/**
+ * @param rss The peak memory usage of the worker (in kB)
+ */
+void SCycleStatistics::SetPeakRSS( Long64_t rss ) {
+
+   m_peakRSS = rss;
+   return;
+}
+
+/**
+ * @returns The metrics records collected on the workers
+ */
+const std::vector< std::string >& SCycleStatistics::GetRecords() const {
+
+   return m_records;
+}
+
+/**
+ * @param record One line of the metrics file in JSON format
+ */
+void SCycleStatistics::AddRecord( const std::string& record ) {
+
+   m_records.push_back( record );
+   return;
+}
+
 /**
  * The merging is done in a *very* simple manner, just adding up the member
- * variables.
+ * variables. Only the peak memory usage is not added up, as the largest value
+ * is the interesting one there.
  *
  * @param coll The collection of objects to merge into this one
  * @returns Zero if some problem happened, something else if everything was okay
@@ -107,6 +212,15 @@ Int_t SCycleStatistics::Merge( TCollection* coll ) {
       //
       m_processedEvents += sobj->m_processedEvents;
       m_skippedEvents   += sobj->m_skippedEvents;
+      m_realTime        += sobj->m_realTime;
+      m_cpuTime         += sobj->m_cpuTime;
+      m_bytesRead       += sobj->m_bytesRead;
+      m_bytesWritten    += sobj->m_bytesWritten;
+      if( sobj->m_peakRSS > m_peakRSS ) {
+         m_peakRSS = sobj->m_peakRSS;
+      }
+      m_records.insert( m_records.end(), sobj->m_records.begin(),
+                        sobj->m_records.end() );
 
       REPORT_VERBOSE( sobj->m_processedEvents
                       << " events processed on one worker" );
@@ -0,0 +1,304 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+// System include(s):
+#include <cstring>
+
+// STL include(s):
+#include <algorithm>
+
+// ROOT include(s):
+#include <TCollection.h>
+#include <TEntryList.h>
+#include <TMD5.h>
+
+// Local include(s):
+#include "../include/SEventList.h"
+#include "../include/SCycleConfig.h"
+
+#ifndef DOXYGEN_IGNORE
+ClassImp( SEventList )
+#endif // DOXYGEN_IGNORE
+
+namespace {
+
+   /// Helper function adding a name to a list of names if it's not there yet
+   void AddName( std::vector< std::string >& names, const std::string& name ) {
+
+      if( std::find( names.begin(), names.end(), name ) == names.end() ) {
+         names.push_back( name );
+      }
+      return;
+   }
+
+} // private namespace
+
+/**
+ * @param name The name of the object
+ */
+SEventList::SEventList( const char* name )
+   : TNamed( name, "SFrame event lists" ), m_selections(), m_fileIds(),
+     m_entries(), m_processed(), m_lists(), m_current( -1 ),
+     m_currentLists(), m_logger( "SEventList" ) {
+
+   m_lists.SetOwner();
+}
+
+/**
+ * The function is called by the framework for each new input file that the
+ * worker opens. The same file may be opened by multiple workers, each of them
+ * processing a different range of its entries.
+ *
+ * @param fileId The unique identifier of the input file
+ * @param entries The number of entries in the event tree of the file
+ */
+void SEventList::BeginFile( const char* fileId, Long64_t entries ) {
+
+   m_current = Index( fileId, entries );
+   m_currentLists.clear();
+   return;
+}
+
+/**
+ * @param selection The name of the selection that the entry passed
+ * @param entry The entry number in the event tree of the current input file
+ */
+void SEventList::AddEntry( const char* selection, Long64_t entry ) {
+
+   if( m_current < 0 ) return;
+
+   // Look up the list of the selection among the ones used for the current
+   // file, without going through all the lists of the object:
+   TEntryList*& list = m_currentLists[ selection ];
+   if( ! list ) {
+      AddName( m_selections, selection );
+      const char* fileId = m_fileIds[ m_current ].c_str();
+      list = FindList( selection, fileId );
+      if( ! list ) {
+         list = new TEntryList( selection, fileId );
+         m_lists.Add( list );
+      }
+   }
+   list->Enter( entry );
+
+   return;
+}
+
+/**
+ * The lists are only given for the input files that were processed
+ * completely when recording them. Since the selections are only known once
+ * an event passed them, a selection that never passed in a job doesn't have
+ * lists at all.
+ *
+ * @param selection The name of the selection
+ * @param fileId The unique identifier of the input file
+ * @returns The entries of the file passing the selection, or a null pointer
+ *          if the events of the file are not known for the selection
+ */
+TEntryList* SEventList::GetList( const char* selection,
+                                 const char* fileId ) const {
+
+   // Check that the file was processed completely:
+   std::vector< std::string >::const_iterator itr =
+      std::find( m_fileIds.begin(), m_fileIds.end(), fileId );
+   if( itr == m_fileIds.end() ) return 0;
+   const size_t index = itr - m_fileIds.begin();
+   if( m_processed[ index ] != m_entries[ index ] ) return 0;
+
+   // Check that the selection was recorded:
+   if( std::find( m_selections.begin(), m_selections.end(), selection ) ==
+       m_selections.end() ) {
+      return 0;
+   }
+
+   return FindList( selection, fileId );
+}
+
+/**
+ * The lists recorded for the files that were only partially processed (by
+ * a job with a maximal number of events, or processing only some shards of
+ * the input data, etc.) are not stored, as they don't describe the whole
+ * file. The lists of the completely processed files replace the previously
+ * stored lists of the same files.
+ *
+ * @param recorded The merged lists recorded during the processing of a cycle
+ */
+void SEventList::Update( const SEventList& recorded ) {
+
+   for( size_t i = 0; i < recorded.m_fileIds.size(); ++i ) {
+
+      // Skip the files that were not processed completely:
+      if( recorded.m_processed[ i ] != recorded.m_entries[ i ] ) {
+         REPORT_VERBOSE( "Not storing the event lists of partially "
+                         "processed file: " << recorded.m_fileIds[ i ] );
+         continue;
+      }
+      const char* fileId = recorded.m_fileIds[ i ].c_str();
+
+      // Remove the previous lists of the file:
+      TList previous;
+      TIter next( &m_lists );
+      TObject* obj = 0;
+      while( ( obj = next() ) ) {
+         if( recorded.m_fileIds[ i ] == obj->GetTitle() ) {
+            previous.Add( obj );
+         }
+      }
+      TIter next_prev( &previous );
+      while( ( obj = next_prev() ) ) {
+         m_lists.Remove( obj );
+         delete obj;
+      }
+
+      // Remember the file as completely processed:
+      const size_t index = Index( recorded.m_fileIds[ i ],
+                                  recorded.m_entries[ i ] );
+      m_entries[ index ] = recorded.m_entries[ i ];
+      m_processed[ index ] = recorded.m_entries[ i ];
+
+      // Store all the recorded selections. Selections that no event of the
+      // file passed get an empty list.
+      std::vector< std::string >::const_iterator sel_itr =
+         recorded.m_selections.begin();
+      std::vector< std::string >::const_iterator sel_end =
+         recorded.m_selections.end();
+      for( ; sel_itr != sel_end; ++sel_itr ) {
+         AddName( m_selections, *sel_itr );
+         const TEntryList* list = recorded.FindList( sel_itr->c_str(),
+                                                     fileId );
+         if( list ) {
+            m_lists.Add( new TEntryList( *list ) );
+         } else {
+            m_lists.Add( new TEntryList( sel_itr->c_str(), fileId ) );
+         }
+      }
+   }
+
+   return;
+}
+
+/**
+ * The stored event lists are only valid for the same cycle, configured in
+ * the same way. So the lists are stored under a name made from the cycle
+ * name, and from all the user properties of the cycle.
+ *
+ * @param config The configuration of the cycle
+ * @returns The name of the stored object belonging to the configuration
+ */
+TString SEventList::CacheKey( const SCycleConfig& config ) {
+
+   TString key( config.GetCycleName() );
+   SCycleConfig::property_type::const_iterator itr =
+      config.GetProperties().begin();
+   SCycleConfig::property_type::const_iterator end =
+      config.GetProperties().end();
+   for( ; itr != end; ++itr ) {
+      key += TString::Format( ";%s=%s", itr->first.c_str(),
+                              itr->second.c_str() );
+   }
+
+   TMD5 md5;
+   md5.Update( reinterpret_cast< const UChar_t* >( key.Data() ),
+               key.Length() );
+   md5.Final();
+
+   return TString( "EventList_" ) + md5.AsString();
+}
+
+/**
+ * The entry lists of the same selections and input files are added up, as
+ * the entries of a file may be processed by multiple workers.
+ *
+ * @param coll The collection of objects to merge into this one
+ * @returns Zero if some problem happened, something else if everything was okay
+ */
+Int_t SEventList::Merge( TCollection* coll ) {
+
+   //
+   // Return right away if the input is flawed:
+   //
+   if( ! coll ) return 0;
+   if( coll->IsEmpty() ) return 0;
+
+   TIter next( coll );
+   TObject* obj = 0;
+   while( ( obj = next() ) ) {
+
+      SEventList* lobj = dynamic_cast< SEventList* >( obj );
+      if( ! lobj ) {
+         REPORT_ERROR( "Trying to merge \"" << obj->ClassName()
+                       << "\" object into \"" << this->ClassName() << "\"" );
+         continue;
+      }
+
+      for( size_t i = 0; i < lobj->m_selections.size(); ++i ) {
+         AddName( m_selections, lobj->m_selections[ i ] );
+      }
+      for( size_t i = 0; i < lobj->m_fileIds.size(); ++i ) {
+         const size_t index = Index( lobj->m_fileIds[ i ],
+                                     lobj->m_entries[ i ] );
+         m_processed[ index ] += lobj->m_processed[ i ];
+      }
+
+      TIter next_list( &lobj->m_lists );
+      TEntryList* list = 0;
+      while( ( list = dynamic_cast< TEntryList* >( next_list() ) ) ) {
+         TEntryList* mine = FindList( list->GetName(), list->GetTitle() );
+         if( mine ) {
+            mine->Add( list );
+         } else {
+            m_lists.Add( new TEntryList( *list ) );
+         }
+      }
+   }
+
+   return 1;
+}
+
+/**
+ * @param fileId The unique identifier of the input file
+ * @param entries The number of entries in the event tree of the file
+ * @returns The index of the file in the member vectors
+ */
+size_t SEventList::Index( const std::string& fileId, Long64_t entries ) {
+
+   std::vector< std::string >::const_iterator itr =
+      std::find( m_fileIds.begin(), m_fileIds.end(), fileId );
+   if( itr != m_fileIds.end() ) {
+      return ( itr - m_fileIds.begin() );
+   }
+
+   m_fileIds.push_back( fileId );
+   m_entries.push_back( entries );
+   m_processed.push_back( 0 );
+   return ( m_fileIds.size() - 1 );
+}
+
+/**
+ * @param selection The name of the selection
+ * @param fileId The unique identifier of the input file
+ * @returns The entry list, or a null pointer if it doesn't exist
+ */
+TEntryList* SEventList::FindList( const char* selection,
+                                  const char* fileId ) const {
+
+   TIter next( &m_lists );
+   TObject* obj = 0;
+   while( ( obj = next() ) ) {
+      if( ( ! strcmp( obj->GetName(), selection ) ) &&
+          ( ! strcmp( obj->GetTitle(), fileId ) ) ) {
+         return dynamic_cast< TEntryList* >( obj );
+      }
+   }
+
+   return 0;
+}
@@ -135,8 +135,13 @@ Bool_t SFile::operator!= ( const SFile& rh ) const {
  */
 STree& STree::operator= ( const STree& parent ) {
 
-   this->treeName = parent.treeName;
-   this->type     = parent.type;
+   this->treeName     = parent.treeName;
+   this->type         = parent.type;
+   this->copyBranches = parent.copyBranches;
+   this->copyFrom     = parent.copyFrom;
+   this->fileName     = parent.fileName;
+   this->indexMajor   = parent.indexMajor;
+   this->indexMinor   = parent.indexMinor;
 
    return *this;
 }
@@ -152,8 +157,13 @@ STree& STree::operator= ( const STree& parent ) {
  */
 Bool_t STree::operator== ( const STree& rh ) const {
 
-   if( ( this->treeName == rh.treeName ) &&
-       ( this->type     == rh.type ) ) {
+   if( ( this->treeName     == rh.treeName ) &&
+       ( this->type         == rh.type ) &&
+       ( this->copyBranches == rh.copyBranches ) &&
+       ( this->copyFrom     == rh.copyFrom ) &&
+       ( this->fileName     == rh.fileName ) &&
+       ( this->indexMajor   == rh.indexMajor ) &&
+       ( this->indexMinor   == rh.indexMinor ) ) {
       return kTRUE;
    } else {
       return kFALSE;
@@ -181,6 +191,7 @@ SInputData::SInputData( const char* name )
    : TNamed( name, "SFrame input data object" ), m_type( "unknown" ),
      m_version( 0 ), m_totalLumiGiven( 0 ), m_totalLumiSum( 0 ),
      m_eventsTotal( 0 ), m_neventsmax( -1 ), m_neventsskip( 0 ),
+     m_shardIndex( 0 ), m_shardCount( 1 ), m_shardSkip( 0 ), m_shardMax( -1 ),
      m_cacheable( kFALSE ), m_skipValid( kFALSE ), m_skipLookup( kFALSE ),
      m_entry( 0 ), m_dset( 0 ), m_logger( "SInputData" ) {
 
@@ -204,6 +215,31 @@ SInputData::~SInputData() {
    REPORT_VERBOSE( "In destructor" );
 }
 
+/**
+ * Big input data can be split into a number of shards, which are processed
+ * by separate jobs. (On a batch system for instance.) The shards are
+ * balanced ranges of the events selected with NEventsSkip and NEventsMax,
+ * calculated from the number of events in the input files when the input is
+ * validated. The event weights are calculated as if the whole input was
+ * processed, so the outputs of the shards can simply be added up.
+ *
+ * @param index The index of the shard to process (from 0 to count - 1)
+ * @param count The number of shards to split the input data into
+ */
+void SInputData::SetShard( Int_t index, Int_t count ) {
+
+   if( ( count < 1 ) || ( index < 0 ) || ( index >= count ) ) {
+      SError error( SError::SkipCycle );
+      error << "Invalid shard specification for input data type \""
+            << GetType() << "\": " << index << "/" << count;
+      throw error;
+   }
+
+   m_shardIndex = index;
+   m_shardCount = count;
+   return;
+}
+
 /**
  * The function adds a new input file to the input data, correctly adding
  * the luminosity of the file to the total luminosity sum of the input
@@ -278,7 +314,8 @@ void SInputData::ValidateInput( const char* pserver ) {
 
    // Check that the configuration makes sense:
    if( GetSkipValid() && ( ( GetNEventsMax() > 0 ) ||
-                           ( GetNEventsSkip() > 0 ) ) ) {
+                           ( GetNEventsSkip() > 0 ) ||
+                           ( GetShardCount() > 1 ) ) ) {
       m_logger << WARNING << "The input file validation can not be skipped "
                << "when running on a subset of events\n"
                << "Turning on the InputData validation for InputData\n"
@@ -306,6 +343,9 @@ void SInputData::ValidateInput( const char* pserver ) {
       ValidateInputDataSets( pserver );
    }
 
+   // Decide which events belong to the processed shard:
+   CalculateShardRange();
+
    return;
 }
 
@@ -404,6 +444,30 @@ Double_t SInputData::GetScaledLumi() const {
    return scaled_lumi;
 }
 
+/**
+ * @returns The number of events to skip at the beginning of the input data,
+ *          taking the processed shard into account
+ */
+Long64_t SInputData::GetShardNEventsSkip() const {
+
+   if( m_shardCount > 1 ) {
+      return m_shardSkip;
+   }
+   return m_neventsskip;
+}
+
+/**
+ * @returns The maximal number of events to process from the input data
+ *          (-1 for all of them), taking the processed shard into account
+ */
+Long64_t SInputData::GetShardNEventsMax() const {
+
+   if( m_shardCount > 1 ) {
+      return m_shardMax;
+   }
+   return m_neventsmax;
+}
+
 /**
  * It is only necessary for some technical affairs.
  */
@@ -420,6 +484,10 @@ SInputData& SInputData::operator= ( const SInputData& parent ) {
    this->m_eventsTotal = parent.m_eventsTotal;
    this->m_neventsmax = parent.m_neventsmax;
    this->m_neventsskip = parent.m_neventsskip;
+   this->m_shardIndex = parent.m_shardIndex;
+   this->m_shardCount = parent.m_shardCount;
+   this->m_shardSkip = parent.m_shardSkip;
+   this->m_shardMax = parent.m_shardMax;
    this->m_cacheable = parent.m_cacheable;
    this->m_skipValid = parent.m_skipValid;
    this->m_entry = parent.m_entry;
@@ -454,6 +522,8 @@ Bool_t SInputData::operator== ( const SInputData& rh ) const {
        ( this->m_eventsTotal == rh.m_eventsTotal ) &&
        ( this->m_neventsmax == rh.m_neventsmax ) &&
        ( this->m_neventsskip == rh.m_neventsskip ) &&
+       ( this->m_shardIndex == rh.m_shardIndex ) &&
+       ( this->m_shardCount == rh.m_shardCount ) &&
        ( this->m_cacheable == rh.m_cacheable ) &&
        ( this->m_skipValid == rh.m_skipValid ) &&
        ( this->m_dset->IsEqual( rh.m_dset ) ) ) {
@@ -496,6 +566,10 @@ void SInputData::Print( const Option_t* ) const {
             << std::endl;
    m_logger << " NEventsMax         : " << GetNEventsMax() << std::endl;
    m_logger << " NEventsSkip        : " << GetNEventsSkip() << std::endl;
+   if( GetShardCount() > 1 ) {
+      m_logger << " Shard              : " << GetShardIndex() << "/"
+               << GetShardCount() << std::endl;
+   }
    m_logger << " Cacheable          : " << ( GetCacheable() ? "Yes" : "No" )
             << std::endl;
    m_logger << " Skip validation    : " << ( GetSkipValid() ? "Yes" : "No" )
@@ -532,6 +606,20 @@ void SInputData::Print( const Option_t* ) const {
                   << "' (name) | '"
                   << STreeTypeDecoder::Instance()->GetName( tree_itr->first )
                   << "' (type)" << std::endl;
+         if( tree->copyBranches != "" ) {
+            m_logger << " Copied branches    : '" << tree->copyBranches
+                     << "' (from: '" << ( tree->copyFrom == "" ? "<default>" :
+                                          tree->copyFrom.Data() )
+                     << "')" << std::endl;
+         }
+         if( tree->indexMajor != "" ) {
+            m_logger << " Aligned by index   : '" << tree->indexMajor
+                     << ( tree->indexMinor == "" ? "" : ", " )
+                     << tree->indexMinor << "' (file: '"
+                     << ( tree->fileName == "" ? "<input>" :
+                          tree->fileName.Data() )
+                     << "')" << std::endl;
+         }
       }
    }
 
@@ -563,6 +651,10 @@ TString SInputData::GetStringConfig() const {
                               m_neventsmax );
    result += TString::Format( "               NEventsSkip=\"%lld\"\n",
                               m_neventsskip );
+   if( m_shardCount > 1 ) {
+      result += TString::Format( "               Shard=\"%i/%i\"\n",
+                                 m_shardIndex, m_shardCount );
+   }
    result += TString::Format( "               Cacheable=\"%s\"\n",
                               ( m_cacheable ? "True" : "False" ) );
    result += TString::Format( "               SkipValid=\"%s\"\n",
@@ -606,9 +698,30 @@ TString SInputData::GetStringConfig() const {
       std::vector< STree >::const_iterator tt_itr = t_itr->second.begin();
       std::vector< STree >::const_iterator tt_end = t_itr->second.end();
       for( ; tt_itr != tt_end; ++tt_itr ) {
-         result += TString::Format( "        <%s Name=\"%s\"/>\n",
+         result += TString::Format( "        <%s Name=\"%s\"",
                                     decoder->GetXMLName( t_itr->first ).Data(),
                                     tt_itr->treeName.Data() );
+         if( tt_itr->copyBranches != "" ) {
+            result += TString::Format( " CopyBranches=\"%s\"",
+                                       tt_itr->copyBranches.Data() );
+         }
+         if( tt_itr->copyFrom != "" ) {
+            result += TString::Format( " CopyFrom=\"%s\"",
+                                       tt_itr->copyFrom.Data() );
+         }
+         if( tt_itr->fileName != "" ) {
+            result += TString::Format( " File=\"%s\"",
+                                       tt_itr->fileName.Data() );
+         }
+         if( tt_itr->indexMajor != "" ) {
+            result += TString::Format( " IndexMajor=\"%s\"",
+                                       tt_itr->indexMajor.Data() );
+         }
+         if( tt_itr->indexMinor != "" ) {
+            result += TString::Format( " IndexMinor=\"%s\"",
+                                       tt_itr->indexMinor.Data() );
+         }
+         result += "/>\n";
       }
    }
 
@@ -742,6 +855,8 @@ void SInputData::ValidateInputFiles() {
 
                // Only check the existence of input trees:
                if( ! ( st_itr->type & STree::INPUT_TREE ) ) continue;
+               // The trees read from their own file are not in the input:
+               if( st_itr->fileName != "" ) continue;
 
                // Try to access the input tree:
                TTree* tree =
@@ -973,6 +1088,8 @@ void SInputData::ValidateInputDataSets( const char* pserver ) {
 
                // Only check the existence of input trees:
                if( ! ( st_itr->type & STree::INPUT_TREE ) ) continue;
+               // The trees read from their own file are not in the input:
+               if( st_itr->fileName != "" ) continue;
 
                // Don't check for trees in sub-directories:
                if( st_itr->treeName.Contains( "/" ) ) continue;
@@ -1070,6 +1187,8 @@ Bool_t SInputData::LoadInfoOnFile( SFile* file, TFileCollection* filecoll ) {
 
          // Only check the existence of input trees:
          if( ! ( st_itr->type & STree::INPUT_TREE ) ) continue;
+         // The trees read from their own file are not in the input:
+         if( st_itr->fileName != "" ) continue;
 
          // Get the tree information:
          TFileInfoMeta* tree_info = fileinfo->GetMetaData( st_itr->treeName );
@@ -1139,6 +1258,116 @@ TFileInfo* SInputData::AccessFileInfo( SFile* file,
    return result;
 }
 
+/**
+ * The events selected by NEventsSkip and NEventsMax are split into shards
+ * of (nearly) equal size. The calculation only uses the number of events in
+ * the input files, which is either read from the files themselves, or from
+ * the InputData cache. So all the jobs processing the different shards of
+ * the same input come to the same conclusion about the boundaries.
+ */
+void SInputData::CalculateShardRange() {
+
+   // Check if the input is sharded at all:
+   if( m_shardCount <= 1 ) return;
+
+   // The range of events to split into shards:
+   const Long64_t first = m_neventsskip;
+   Long64_t last = m_eventsTotal;
+   if( ( m_neventsmax >= 0 ) && ( first + m_neventsmax < last ) ) {
+      last = first + m_neventsmax;
+   }
+   if( last < first ) last = first;
+
+   // Calculate the range of this shard:
+   const Long64_t begin = ShardBoundary( first, last, m_shardIndex );
+   const Long64_t end = ShardBoundary( first, last, m_shardIndex + 1 );
+   m_shardSkip = begin;
+   m_shardMax = end - begin;
+
+   m_logger << INFO << "Input type \"" << GetType() << "\" version \""
+            << GetVersion() << "\" : Processing shard " << m_shardIndex << "/"
+            << m_shardCount << ", events " << begin << " - " << end
+            << SLogger::endmsg;
+
+   return;
+}
+
+/**
+ * The nominal boundary between two shards is moved to the beginning of the
+ * TTree cluster that it falls into. This way no basket has to be read by two
+ * separate jobs. This is only done for input files, for datasets the nominal
+ * boundaries are used.
+ *
+ * @param first The first event of all the shards
+ * @param last The event after the last event of all the shards
+ * @param index The index of the shard (can be equal to the number of shards)
+ * @returns The first event of the specified shard
+ */
+Long64_t SInputData::ShardBoundary( Long64_t first, Long64_t last,
+                                    Int_t index ) const {
+
+   // The first and last boundaries are fixed:
+   if( index <= 0 ) return first;
+   if( index >= m_shardCount ) return last;
+
+   // The nominal boundary:
+   const Long64_t nominal = first + ( last - first ) * index / m_shardCount;
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION( 5, 32, 0 )
+   // Find the name of the main TTree in the files:
+   const char* treeName = 0;
+   std::map< Int_t, std::vector< STree > >::const_iterator trees_itr =
+      m_trees.begin();
+   std::map< Int_t, std::vector< STree > >::const_iterator trees_end =
+      m_trees.end();
+   for( ; ( ! treeName ) && ( trees_itr != trees_end ); ++trees_itr ) {
+      std::vector< STree >::const_iterator st_itr = trees_itr->second.begin();
+      std::vector< STree >::const_iterator st_end = trees_itr->second.end();
+      for( ; st_itr != st_end; ++st_itr ) {
+         if( ( st_itr->type & STree::INPUT_TREE ) &&
+             ( st_itr->type & STree::EVENT_TREE ) ) {
+            treeName = st_itr->treeName.Data();
+            break;
+         }
+      }
+   }
+   if( ! treeName ) return nominal;
+
+   // Find the file holding the nominal boundary:
+   Long64_t offset = 0;
+   std::vector< SFile >::const_iterator file_itr = m_sfileIn.begin();
+   std::vector< SFile >::const_iterator file_end = m_sfileIn.end();
+   for( ; file_itr != file_end; ++file_itr ) {
+      if( nominal < offset + file_itr->events ) break;
+      offset += file_itr->events;
+   }
+   if( ( file_itr == file_end ) || ( nominal == offset ) ) return nominal;
+
+   // Find the beginning of the cluster holding the nominal boundary:
+   TFile* file = TFile::Open( file_itr->file, "READ" );
+   if( ( ! file ) || file->IsZombie() ) {
+      m_logger << WARNING << "Couldn't open file " << file_itr->file
+               << " to align the shard boundary" << SLogger::endmsg;
+      delete file;
+      return nominal;
+   }
+   Long64_t result = nominal;
+   TTree* tree = dynamic_cast< TTree* >( file->Get( treeName ) );
+   if( tree ) {
+      TTree::TClusterIterator cluster =
+         tree->GetClusterIterator( nominal - offset );
+      result = offset + cluster.GetStartEntry();
+   }
+   file->Close();
+   delete file;
+
+   // Don't move the boundary before the first event of the shards:
+   return ( result < first ? first : result );
+#else
+   return nominal;
+#endif // ROOT_VERSION( 5, 32, 0 )
+}
+
 /**
  * This function is used to make a validated dataset object out of the specified
  * input files. This dataset is then used to process the file using PROOF.
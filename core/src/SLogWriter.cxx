@@ -10,17 +10,317 @@
  *
  ***************************************************************************/
 
+// The asynchronous writer needs the C++11 atomics and threads. With older
+// compilers the messages are always written synchronously.
+#if __cplusplus >= 201103L
+#   define SLOGWRITER_ASYNC 1
+#else
+#   define SLOGWRITER_ASYNC 0
+#endif // __cplusplus
+
 // System include(s):
 extern "C" {
 #   include <unistd.h>
+#   include <pthread.h>
+#   include <signal.h>
+#   include <time.h>
 }
+#include <cstdlib>
 
 // STL include(s):
 #include <iostream>
+#if SLOGWRITER_ASYNC
+#   include <atomic>
+#   include <mutex>
+#   include <condition_variable>
+#   include <thread>
+#   include <chrono>
+#endif // SLOGWRITER_ASYNC
 
 // Local include(s):
 #include "../include/SLogWriter.h"
 
+#if SLOGWRITER_ASYNC
+
+/**
+ *   @short Background writer used by SLogWriter
+ *
+ *          The messages are put into a fixed size, lock-free ring buffer
+ *          (following the well known bounded queue design of D. Vyukov) by
+ *          the threads producing them. A single background thread takes them
+ *          out of the queue, formats them, and writes them to the console in
+ *          batches, flushing the output only once per batch.
+ *
+ *          When the queue is full, the producers wait for the background
+ *          thread to make some space. So no message is ever lost.
+ *
+ * @version $Revision$
+ */
+class SLogWriterQueue {
+
+public:
+   /// Constructor starting the background thread
+   SLogWriterQueue( const SLogWriter& writer );
+   /// Destructor stopping the background thread
+   ~SLogWriterQueue();
+
+   /// Put a new message into the queue
+   void Push( SMsgType type, const std::string& line );
+   /// Wait until all the messages queued until now are written
+   void Flush();
+   /// Wait a limited time for the queued messages, from a signal handler
+   void FlushFromSignal();
+
+private:
+   /// One element of the ring buffer
+   struct Slot {
+      std::atomic< size_t > m_sequence; ///< Sequence number of the slot
+      SMsgType    m_type; ///< Type of the message in the slot
+      std::string m_line; ///< Text of the message in the slot
+   }; // struct Slot
+
+   /// Take the next message out of the queue, if there is one
+   bool Pop( SMsgType& type, std::string& line );
+   /// Check whether there is a message waiting in the queue
+   bool HasMessage() const;
+   /// Wake up the background thread
+   void Wake();
+   /// The function executed by the background thread
+   void Run();
+
+   /// Number of slots in the ring buffer (has to be a power of 2)
+   static const size_t QUEUE_SIZE = 4096;
+   /// Maximal number of messages written in one batch
+   static const size_t MAX_BATCH = 256;
+
+   const SLogWriter& m_writer; ///< The object doing the message formatting
+   Slot*  m_slots; ///< The ring buffer
+   std::atomic< size_t > m_enqueuePos; ///< Next position to write to
+   size_t m_dequeuePos; ///< Next position to read from (background thread)
+   std::atomic< size_t > m_written; ///< Number of messages written so far
+   std::atomic< bool > m_stop; ///< Flag for stopping the background thread
+   std::atomic< bool > m_sleeping; ///< Flag showing if the thread is asleep
+   std::mutex m_mutex; ///< Mutex used for waking up the background thread
+   std::condition_variable m_cond; ///< Condition used for the wake-up
+   std::thread m_thread; ///< The background thread
+
+}; // class SLogWriterQueue
+
+/**
+ * @param writer The object that should be used to format the messages
+ */
+SLogWriterQueue::SLogWriterQueue( const SLogWriter& writer )
+   : m_writer( writer ), m_slots( new Slot[ QUEUE_SIZE ] ), m_enqueuePos( 0 ),
+     m_dequeuePos( 0 ), m_written( 0 ), m_stop( false ), m_sleeping( false ),
+     m_mutex(), m_cond(), m_thread() {
+
+   for( size_t i = 0; i < QUEUE_SIZE; ++i ) {
+      m_slots[ i ].m_sequence.store( i, std::memory_order_relaxed );
+   }
+   m_thread = std::thread( &SLogWriterQueue::Run, this );
+}
+
+/**
+ * The destructor writes out all the messages still in the queue, and then
+ * stops the background thread.
+ */
+SLogWriterQueue::~SLogWriterQueue() {
+
+   m_stop.store( true );
+   Wake();
+   if( m_thread.joinable() ) m_thread.join();
+   delete[] m_slots;
+}
+
+/**
+ * @param type The type of the message
+ * @param line The (single line) message text
+ */
+void SLogWriterQueue::Push( SMsgType type, const std::string& line ) {
+
+   // Reserve a slot in the ring buffer:
+   Slot* slot = 0;
+   size_t pos = m_enqueuePos.load( std::memory_order_relaxed );
+   for( ; ; ) {
+      slot = &m_slots[ pos & ( QUEUE_SIZE - 1 ) ];
+      const size_t seq = slot->m_sequence.load( std::memory_order_acquire );
+      const long diff = static_cast< long >( seq ) - static_cast< long >( pos );
+      if( diff == 0 ) {
+         if( m_enqueuePos.compare_exchange_weak( pos, pos + 1,
+                                                 std::memory_order_relaxed ) ) {
+            break;
+         }
+      } else if( diff < 0 ) {
+         // The queue is full, wait for the background thread:
+         Wake();
+         std::this_thread::yield();
+         pos = m_enqueuePos.load( std::memory_order_relaxed );
+      } else {
+         pos = m_enqueuePos.load( std::memory_order_relaxed );
+      }
+   }
+
+   // Fill the slot, and publish it:
+   slot->m_type = type;
+   slot->m_line = line;
+   slot->m_sequence.store( pos + 1, std::memory_order_release );
+
+   // Wake up the background thread if it's sleeping:
+   if( m_sleeping.load() ) Wake();
+
+   return;
+}
+
+/**
+ * The function doesn't return until all the messages that were put into the
+ * queue before the call are written to the console.
+ */
+void SLogWriterQueue::Flush() {
+
+   const size_t target = m_enqueuePos.load();
+   while( m_written.load( std::memory_order_acquire ) < target ) {
+      Wake();
+      std::this_thread::yield();
+   }
+
+   return;
+}
+
+/**
+ * This version of Flush() is called from signal handlers. It only uses
+ * async-signal-safe operations, so it doesn't wake up the background thread,
+ * it just waits for it to finish its periodic wake-up. If the background
+ * thread doesn't manage to write out the messages in about a second (for
+ * instance because it was the thread that crashed), the function gives up.
+ */
+void SLogWriterQueue::FlushFromSignal() {
+
+   const size_t target = m_enqueuePos.load();
+   struct timespec pause;
+   pause.tv_sec = 0;
+   pause.tv_nsec = 10000000;
+   for( int i = 0; ( i < 100 ) &&
+           ( m_written.load( std::memory_order_acquire ) < target ); ++i ) {
+      nanosleep( &pause, 0 );
+   }
+
+   return;
+}
+
+/**
+ * This function is only called by the background thread.
+ *
+ * @param type The type of the message taken out of the queue
+ * @param line The text of the message taken out of the queue
+ * @returns <code>true</code> if a message was taken out of the queue,
+ *          <code>false</code> otherwise
+ */
+bool SLogWriterQueue::Pop( SMsgType& type, std::string& line ) {
+
+   Slot& slot = m_slots[ m_dequeuePos & ( QUEUE_SIZE - 1 ) ];
+   if( slot.m_sequence.load( std::memory_order_acquire ) !=
+       ( m_dequeuePos + 1 ) ) {
+      return false;
+   }
+
+   type = slot.m_type;
+   line.swap( slot.m_line );
+   slot.m_sequence.store( m_dequeuePos + QUEUE_SIZE,
+                          std::memory_order_release );
+   ++m_dequeuePos;
+
+   return true;
+}
+
+/**
+ * @returns <code>true</code> if the next slot of the queue holds a message
+ */
+bool SLogWriterQueue::HasMessage() const {
+
+   const Slot& slot = m_slots[ m_dequeuePos & ( QUEUE_SIZE - 1 ) ];
+   return ( slot.m_sequence.load( std::memory_order_acquire ) ==
+            ( m_dequeuePos + 1 ) );
+}
+
+/**
+ * The producers only need to take the mutex when the background thread is
+ * (about to go) asleep. So the usual case of pushing a message into the queue
+ * doesn't involve any locking.
+ */
+void SLogWriterQueue::Wake() {
+
+   std::lock_guard< std::mutex > lock( m_mutex );
+   m_cond.notify_one();
+   return;
+}
+
+/**
+ * The main loop of the background thread. It collects as many messages as it
+ * can (up to a limit) into a single buffer, and writes them to the console in
+ * one go. When there are no messages to write, it goes to sleep until a
+ * producer wakes it up.
+ */
+void SLogWriterQueue::Run() {
+
+   std::string buffer, line;
+   SMsgType type = INFO;
+
+   for( ; ; ) {
+
+      // Collect the waiting messages:
+      size_t n = 0;
+      while( ( n < MAX_BATCH ) && Pop( type, line ) ) {
+         m_writer.Format( buffer, type, line );
+         ++n;
+      }
+
+      // Write them out in one go:
+      if( n ) {
+         std::cout.write( buffer.data(), buffer.size() );
+         std::cout.flush();
+         buffer.clear();
+         m_written.fetch_add( n, std::memory_order_release );
+         continue;
+      }
+
+      // Stop if requested, and there are no more messages:
+      if( m_stop.load() ) break;
+
+      // Go to sleep until a new message arrives:
+      std::unique_lock< std::mutex > lock( m_mutex );
+      m_sleeping.store( true );
+      if( ( ! HasMessage() ) && ( ! m_stop.load() ) ) {
+         m_cond.wait_for( lock, std::chrono::milliseconds( 100 ) );
+      }
+      m_sleeping.store( false );
+   }
+
+   return;
+}
+
+namespace {
+
+   /// The background writer, created when first needed
+   std::atomic< SLogWriterQueue* > s_queue( 0 );
+   /// Mutex protecting the creation/deletion of the background writer
+   std::mutex s_queueMutex;
+
+} // private namespace
+
+#endif // SLOGWRITER_ASYNC
+
+namespace {
+
+   /// The signals after which the queued messages are written out
+   const int CRASH_SIGNALS[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT,
+                                 SIGTERM, SIGINT };
+   /// The number of signals handled
+   const int N_CRASH_SIGNALS = sizeof( CRASH_SIGNALS ) / sizeof( int );
+   /// The signal handlers that were set up before SLogWriter's
+   struct sigaction s_oldActions[ N_CRASH_SIGNALS ];
+
+} // private namespace
+
 // Initialize the static member(s):
 SLogWriter* SLogWriter::m_instance = 0;
 
@@ -49,6 +349,9 @@ SLogWriter* SLogWriter::Instance() {
  */
 SLogWriter::~SLogWriter() {
 
+   // Write out all the pending messages:
+   StopQueue();
+
    // Reset the instance pointer, so the object would be properly re-created
    // when it's needed:
    m_instance = 0;
@@ -59,23 +362,59 @@ SLogWriter::~SLogWriter() {
  * message to the console. The function assumes that the message has no
  * line breaks and that it has been formatted by SLogger.
  *
+ * In asynchronous mode the message is only put into the queue of the
+ * background writer, except for ERROR (and more serious) messages, which are
+ * written out (together with all the preceding messages) before the function
+ * returns.
+ *
  * @param type The message type
  * @param line A single line of message to be displayed.
  */
 void SLogWriter::Write( SMsgType type, const std::string& line ) const {
 
    if( type < m_minType ) return;
-   std::map< SMsgType, std::string >::const_iterator stype;
-   if( ( stype = m_typeMap.find( type ) ) == m_typeMap.end() ) return;
+   if( ( type < VERBOSE ) || ( type > ALWAYS ) ) return;
+
+#if SLOGWRITER_ASYNC
+   if( m_async ) {
+      SLogWriterQueue* queue = s_queue.load( std::memory_order_acquire );
+      if( ! queue ) {
+         std::lock_guard< std::mutex > lock( s_queueMutex );
+         queue = s_queue.load();
+         if( ! queue ) {
+            queue = new SLogWriterQueue( *this );
+            s_queue.store( queue );
+            InstallSignalHandlers();
+         }
+      }
+      queue->Push( type, line );
+      if( type >= ERROR ) {
+         queue->Flush();
+      }
+      return;
+   }
+#endif // SLOGWRITER_ASYNC
+
+   std::string buffer;
+   Format( buffer, type, line );
+   std::cout.write( buffer.data(), buffer.size() );
+   std::cout.flush();
+
+   return;
+}
+
+/**
+ * This function should be called before doing something that could lose the
+ * messages that are still waiting to be written. (Like calling abort().)
+ */
+void SLogWriter::Flush() const {
 
-   // Print the output in colours only if it's printed to the console. If it's
-   // redirected to a logfile, then produce simple black on while output.
-   if( isatty( STDOUT_FILENO ) ) {
-      std::cout << m_colorMap.find( type )->second << " (" << stype->second
-                << ")  " << line << "\033[0m" << std::endl;
-   } else {
-      std::cout << " (" << stype->second << ")  " << line << std::endl;
+#if SLOGWRITER_ASYNC
+   SLogWriterQueue* queue = s_queue.load( std::memory_order_acquire );
+   if( queue ) {
+      queue->Flush();
    }
+#endif // SLOGWRITER_ASYNC
 
    return;
 }
@@ -95,36 +434,213 @@ void SLogWriter::SetMinType( SMsgType type ) {
 }
 
 /**
- * Not much to say here.
+ * When turning off the asynchronous writing, all the messages still in the
+ * queue are written out before the function returns. When the code is not
+ * compiled as C++11, the messages are always written synchronously.
+ *
+ * @param async <code>true</code> to write the messages from a background
+ *              thread, <code>false</code> to write them directly
+ */
+void SLogWriter::SetAsync( bool async ) {
+
+#if SLOGWRITER_ASYNC
+   if( ! async ) {
+      StopQueue();
+   }
+   m_async = async;
+#else
+   m_async = false;
+#endif // SLOGWRITER_ASYNC
+
+   return;
+}
+
+/**
+ * @returns <code>true</code> if the messages are written asynchronously
+ */
+bool SLogWriter::GetAsync() const {
+
+   return m_async;
+}
+
+/**
+ * Colours are only used if the output is printed to the console. If it's
+ * redirected to a logfile, then simple black on white output is produced.
+ *
+ * @param buffer The buffer to append the formatted message to
+ * @param type The message type
+ * @param line A single line of message to be displayed
+ */
+void SLogWriter::Format( std::string& buffer, SMsgType type,
+                         const std::string& line ) const {
+
+   if( m_isTerminal ) {
+      buffer += m_colors[ type ];
+   }
+   buffer += " (";
+   buffer += m_typeNames[ type ];
+   buffer += ")  ";
+   buffer += line;
+   if( m_isTerminal ) {
+      buffer += "\033[0m";
+   }
+   buffer += '\n';
+
+   return;
+}
+
+/**
+ * Writes out all the messages that are still in the queue, and stops the
+ * background thread. A new thread is started when the next message arrives.
+ */
+void SLogWriter::StopQueue() {
+
+#if SLOGWRITER_ASYNC
+   std::lock_guard< std::mutex > lock( s_queueMutex );
+   SLogWriterQueue* queue = s_queue.exchange( 0 );
+   if( queue ) {
+      delete queue;
+   }
+#endif // SLOGWRITER_ASYNC
+
+   return;
+}
+
+/**
+ * The background thread has to be stopped before the static objects of the
+ * process are destructed. Messages arriving after this point are written out
+ * directly.
+ */
+void SLogWriter::AtExit() {
+
+   if( m_instance ) {
+      m_instance->m_async = false;
+   }
+   StopQueue();
+
+   return;
+}
+
+/**
+ * Makes sure that no message is written twice, by the parent and the child
+ * process, and that the background writer is not being created/deleted
+ * during the fork.
+ */
+void SLogWriter::AtForkPrepare() {
+
+   if( m_instance ) {
+      m_instance->Flush();
+   }
+#if SLOGWRITER_ASYNC
+   s_queueMutex.lock();
+#endif // SLOGWRITER_ASYNC
+
+   return;
+}
+
+/**
+ * Just releases the lock taken in AtForkPrepare().
+ */
+void SLogWriter::AtForkParent() {
+
+#if SLOGWRITER_ASYNC
+   s_queueMutex.unlock();
+#endif // SLOGWRITER_ASYNC
+   return;
+}
+
+/**
+ * The background thread doesn't exist in the child process. So the queue
+ * object of the parent is abandoned without touching it, and a new one is
+ * created when needed.
+ */
+void SLogWriter::AtForkChild() {
+
+#if SLOGWRITER_ASYNC
+   s_queue.store( 0 );
+   s_queueMutex.unlock();
+#endif // SLOGWRITER_ASYNC
+
+   return;
+}
+
+/**
+ * The handlers are only installed once the background writer is started,
+ * so by the time ROOT has already set up its own handlers. Those are called
+ * after the queued messages are written out.
+ */
+void SLogWriter::InstallSignalHandlers() {
+
+   static bool installed = false;
+   if( installed ) return;
+   installed = true;
+
+   struct sigaction action;
+   action.sa_handler = &SLogWriter::AtSignal;
+   sigemptyset( &action.sa_mask );
+   action.sa_flags = 0;
+   for( int i = 0; i < N_CRASH_SIGNALS; ++i ) {
+      sigaction( CRASH_SIGNALS[ i ], &action, &s_oldActions[ i ] );
+   }
+
+   return;
+}
+
+/**
+ * Writes out the messages still waiting in the queue when the process
+ * crashes or is killed, and then hands the signal over to the handler that
+ * was set up before SLogWriter's own one.
  *
- * @see SLogWriter::SetMinType
+ * @param sig The received signal
  */
-SMsgType SLogWriter::GetMinType() const {
+void SLogWriter::AtSignal( int sig ) {
+
+#if SLOGWRITER_ASYNC
+   SLogWriterQueue* queue = s_queue.load( std::memory_order_acquire );
+   if( queue ) {
+      queue->FlushFromSignal();
+   }
+#endif // SLOGWRITER_ASYNC
 
-   return m_minType;
+   // Restore the previous handler, and deliver the signal to it:
+   for( int i = 0; i < N_CRASH_SIGNALS; ++i ) {
+      if( CRASH_SIGNALS[ i ] == sig ) {
+         sigaction( sig, &s_oldActions[ i ], 0 );
+         break;
+      }
+   }
+   raise( sig );
+
+   return;
 }
 
 /**
- * The constructor takes care of filling the two std::map-s that are
- * used for generating the nice, coloured output.
+ * The constructor takes care of filling the two arrays that are
+ * used for generating the nice, coloured output. It also checks (only once)
+ * whether the output is going to a terminal.
  */
 SLogWriter::SLogWriter()
-   : m_minType( INFO ) {
-
-   m_typeMap[ VERBOSE ] = "VERBOSE";
-   m_typeMap[ DEBUG ]   = " DEBUG ";
-   m_typeMap[ INFO ]    = " INFO  ";
-   m_typeMap[ WARNING ] = "WARNING";
-   m_typeMap[ ERROR ]   = " ERROR ";
-   m_typeMap[ FATAL ]   = " FATAL ";
-   m_typeMap[ ALWAYS ]  = "ALWAYS ";
-
-   m_colorMap[ VERBOSE ] = "\033[1;34m";
-   m_colorMap[ DEBUG ]   = "\033[34m";
-   m_colorMap[ INFO ]    = "\033[32m";
-   m_colorMap[ WARNING ] = "\033[35m";
-   m_colorMap[ ERROR ]   = "\033[31m";
-   m_colorMap[ FATAL ]   = "\033[1;31;40m";
-   m_colorMap[ ALWAYS ]  = ""; // Used to be: "\033[30m";
+   : m_minType( INFO ), m_isTerminal( isatty( STDOUT_FILENO ) ),
+     m_async( SLOGWRITER_ASYNC ) {
+
+   m_typeNames[ VERBOSE ] = "VERBOSE";
+   m_typeNames[ DEBUG ]   = " DEBUG ";
+   m_typeNames[ INFO ]    = " INFO  ";
+   m_typeNames[ WARNING ] = "WARNING";
+   m_typeNames[ ERROR ]   = " ERROR ";
+   m_typeNames[ FATAL ]   = " FATAL ";
+   m_typeNames[ ALWAYS ]  = "ALWAYS ";
+
+   m_colors[ VERBOSE ] = "\033[1;34m";
+   m_colors[ DEBUG ]   = "\033[34m";
+   m_colors[ INFO ]    = "\033[32m";
+   m_colors[ WARNING ] = "\033[35m";
+   m_colors[ ERROR ]   = "\033[31m";
+   m_colors[ FATAL ]   = "\033[1;31;40m";
+   m_colors[ ALWAYS ]  = ""; // Used to be: "\033[30m";
 
+   // Make sure that the queued messages are not lost:
+   std::atexit( &SLogWriter::AtExit );
+   pthread_atfork( &SLogWriter::AtForkPrepare, &SLogWriter::AtForkParent,
+                   &SLogWriter::AtForkChild );
 }
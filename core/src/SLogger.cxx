@@ -11,7 +11,6 @@
  ***************************************************************************/
 
 // STL include(s):
-#include <iomanip>
 #include <iostream>
 
 // ROOT include(s):
@@ -135,30 +134,28 @@ void SLogger::Send( const SMsgType type, const std::string& message ) const {
    std::string::size_type previous_pos = 0, current_pos = 0;
 
    //
-   // Make sure the source name is no longer than MAXIMUM_SOURCE_NAME_LENGTH:
+   // Make sure the source name is no longer than MAXIMUM_SOURCE_NAME_LENGTH,
+   // and construct the prefix of all the lines from it:
    //
-   std::string source_name( GetSource() );
-   if( source_name.size() > MAXIMUM_SOURCE_NAME_LENGTH ) {
-      source_name = source_name.substr( 0, MAXIMUM_SOURCE_NAME_LENGTH - 3 );
-      source_name += "...";
+   std::string prefix( GetSource() );
+   if( prefix.size() > MAXIMUM_SOURCE_NAME_LENGTH ) {
+      prefix.resize( MAXIMUM_SOURCE_NAME_LENGTH - 3 );
+      prefix += "...";
+   } else {
+      prefix.append( MAXIMUM_SOURCE_NAME_LENGTH - prefix.size(), ' ' );
    }
+   prefix += " : ";
 
    //
    // Slice the recieved message into lines:
    //
+   std::string line;
    for( ; ; ) {
 
       current_pos = message.find( '\n', previous_pos );
-      std::string line = message.substr( previous_pos, current_pos -
-                                         previous_pos );
-
-      std::ostringstream message_to_send;
-      // I have to call the modifiers like this, otherwise g++ get's confused
-      // with the operators...
-      message_to_send.setf( std::ios::adjustfield, std::ios::left );
-      message_to_send.width( MAXIMUM_SOURCE_NAME_LENGTH );
-      message_to_send << source_name << " : " << line;
-      m_logWriter->Write( type, message_to_send.str() );
+      line = prefix;
+      line.append( message, previous_pos, current_pos - previous_pos );
+      m_logWriter->Write( type, line );
 
       if( current_pos == message.npos ) break;
       previous_pos = current_pos + 1;
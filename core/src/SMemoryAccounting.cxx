@@ -0,0 +1,241 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+// STL include(s):
+#include <algorithm>
+#include <iomanip>
+
+// ROOT include(s):
+#include <TObject.h>
+#include <TClass.h>
+#include <TH1.h>
+#include <TArrayD.h>
+#include <TArrayF.h>
+#include <TArrayI.h>
+#include <TArrayS.h>
+#include <TArrayC.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TObjArray.h>
+#include <TBufferFile.h>
+#include <TSystem.h>
+
+// Local include(s):
+#include "../include/SMemoryAccounting.h"
+
+namespace {
+
+   /// Function used to sort the entries in decreasing size order
+   template< class T >
+   bool BiggerEntry( const T& e1, const T& e2 ) {
+
+      return ( e1.bytes > e2.bytes );
+   }
+
+   /// Size of the elements of the bin array of a histogram
+   Long64_t BinSize( const TH1* hist ) {
+
+      if( dynamic_cast< const TArrayD* >( hist ) ) {
+         return sizeof( Double_t );
+      } else if( dynamic_cast< const TArrayF* >( hist ) ) {
+         return sizeof( Float_t );
+      } else if( dynamic_cast< const TArrayI* >( hist ) ) {
+         return sizeof( Int_t );
+      } else if( dynamic_cast< const TArrayS* >( hist ) ) {
+         return sizeof( Short_t );
+      } else if( dynamic_cast< const TArrayC* >( hist ) ) {
+         return sizeof( Char_t );
+      }
+      return sizeof( Double_t );
+   }
+
+} // private namespace
+
+/**
+ * The constructor just initialises the member variable(s).
+ */
+SMemoryAccounting::SMemoryAccounting()
+   : m_entries(), m_logger( "SMemoryAccounting" ) {
+
+}
+
+/**
+ * @param category The type of the object (e.g. "output", "tree")
+ * @param name The name of the object
+ * @param bytes The estimated size of the object in bytes
+ */
+void SMemoryAccounting::Add( const char* category, const char* name,
+                             Long64_t bytes ) {
+
+   Entry entry;
+   entry.category = category;
+   entry.name = name;
+   entry.bytes = bytes;
+   m_entries.push_back( entry );
+
+   return;
+}
+
+/**
+ * @param category The type of the object
+ * @param name The name of the object
+ * @param obj The object itself
+ */
+void SMemoryAccounting::AddObject( const char* category, const char* name,
+                                   const TObject* obj ) {
+
+   Add( category, name, ObjectSize( obj ) );
+   return;
+}
+
+/**
+ * @param category The type of the tree (e.g. "output tree")
+ * @param tree The tree itself
+ */
+void SMemoryAccounting::AddTree( const char* category, TTree* tree ) {
+
+   if( ! tree ) return;
+   Add( category, tree->GetName(), TreeSize( tree ) );
+   return;
+}
+
+/**
+ * @param category The type of the branch (e.g. "input branch")
+ * @param branch The branch itself
+ */
+void SMemoryAccounting::AddBranch( const char* category, TBranch* branch ) {
+
+   if( ! branch ) return;
+   Add( category, branch->GetName(), BranchSize( branch ) );
+   return;
+}
+
+/**
+ * @returns The number of accounted objects
+ */
+size_t SMemoryAccounting::GetN() const {
+
+   return m_entries.size();
+}
+
+/**
+ * @returns The summed size of all the accounted objects in bytes
+ */
+Long64_t SMemoryAccounting::GetTotal() const {
+
+   Long64_t result = 0;
+   std::vector< Entry >::const_iterator itr = m_entries.begin();
+   std::vector< Entry >::const_iterator end = m_entries.end();
+   for( ; itr != end; ++itr ) {
+      result += itr->bytes;
+   }
+   return result;
+}
+
+/**
+ * @param type The message level to print the report with
+ * @param n The number of biggest consumers to print
+ */
+void SMemoryAccounting::Print( SMsgType type, size_t n ) const {
+
+   // Order the entries by their size:
+   std::vector< Entry > entries( m_entries );
+   std::sort( entries.begin(), entries.end(), BiggerEntry< Entry > );
+
+   m_logger.setf( std::ios::fixed );
+   m_logger << type << "Estimated memory use of " << entries.size()
+            << " objects: " << std::setprecision( 2 )
+            << ( GetTotal() / 1048576.0 ) << " MB (resident: "
+            << ( GetResidentMemory() / 1024.0 ) << " MB)" << SLogger::endmsg;
+   for( size_t i = 0; ( i < n ) && ( i < entries.size() ); ++i ) {
+      m_logger << type << std::setw( 10 ) << std::setprecision( 2 )
+               << ( entries[ i ].bytes / 1048576.0 ) << " MB  "
+               << std::setw( 13 ) << std::left << entries[ i ].category
+               << std::right << " " << entries[ i ].name << SLogger::endmsg;
+   }
+
+   return;
+}
+
+/**
+ * Histograms are the most common output objects, and for them the size of
+ * the bin content and bin error arrays is calculated directly. The size of
+ * other objects is estimated by serialising them into a memory buffer.
+ *
+ * @param obj The object to estimate the size of
+ * @returns The estimated size of the object in bytes
+ */
+Long64_t SMemoryAccounting::ObjectSize( const TObject* obj ) {
+
+   if( ! obj ) return 0;
+
+   Long64_t result = obj->IsA()->Size();
+
+   const TH1* hist = dynamic_cast< const TH1* >( obj );
+   if( hist ) {
+      result += static_cast< Long64_t >( hist->GetNcells() ) * BinSize( hist );
+      result += static_cast< Long64_t >( hist->GetSumw2N() ) *
+         sizeof( Double_t );
+      return result;
+   }
+
+   TBufferFile buffer( TBuffer::kWrite );
+   buffer.WriteObject( obj );
+   result += buffer.Length();
+
+   return result;
+}
+
+/**
+ * @param tree The tree to estimate the buffer sizes of
+ * @returns The summed size of the basket buffers of all the branches
+ */
+Long64_t SMemoryAccounting::TreeSize( TTree* tree ) {
+
+   if( ! tree ) return 0;
+
+   Long64_t result = 0;
+   TObjArray* branches = tree->GetListOfBranches();
+   for( Int_t i = 0; i < branches->GetEntriesFast(); ++i ) {
+      result += BranchSize( dynamic_cast< TBranch* >( branches->At( i ) ) );
+   }
+   return result;
+}
+
+/**
+ * @param branch The branch to estimate the buffer sizes of
+ * @returns The summed size of the basket buffers of the branch and all its
+ *          sub-branches
+ */
+Long64_t SMemoryAccounting::BranchSize( TBranch* branch ) {
+
+   if( ! branch ) return 0;
+
+   Long64_t result = branch->GetBasketSize();
+   TObjArray* branches = branch->GetListOfBranches();
+   for( Int_t i = 0; i < branches->GetEntriesFast(); ++i ) {
+      result += BranchSize( dynamic_cast< TBranch* >( branches->At( i ) ) );
+   }
+   return result;
+}
+
+/**
+ * @returns The current resident memory usage of the process in kB
+ */
+Long64_t SMemoryAccounting::GetResidentMemory() {
+
+   ProcInfo_t procinfo;
+   if( gSystem->GetProcInfo( &procinfo ) ) {
+      return -1;
+   }
+   return procinfo.fMemResident;
+}
@@ -0,0 +1,169 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+// System include(s):
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <cstdio>
+#include <cmath>
+
+// Local include(s):
+#include "../include/SMetricsRecord.h"
+
+/**
+ * Every record starts with its type, and the time (in seconds since the epoch)
+ * when it was created.
+ *
+ * @param type The type of the record (e.g. "cycle", "inputdata", "file")
+ */
+SMetricsRecord::SMetricsRecord( const char* type )
+   : m_json( "{" ) {
+
+   Add( "record", type );
+
+   struct timeval tv;
+   gettimeofday( &tv, 0 );
+   Add( "timestamp", static_cast< Double_t >( tv.tv_sec ) +
+        static_cast< Double_t >( tv.tv_usec ) * 1e-6 );
+}
+
+/**
+ * @param key The name of the property
+ * @param value The value of the property
+ */
+void SMetricsRecord::Add( const char* key, const char* value ) {
+
+   AddKey( key );
+   AddString( value );
+   return;
+}
+
+/**
+ * @param key The name of the property
+ * @param value The value of the property
+ */
+void SMetricsRecord::Add( const char* key, const std::string& value ) {
+
+   Add( key, value.c_str() );
+   return;
+}
+
+/**
+ * @param key The name of the property
+ * @param value The value of the property
+ */
+void SMetricsRecord::Add( const char* key, Long64_t value ) {
+
+   AddKey( key );
+   char buffer[ 32 ];
+   snprintf( buffer, sizeof( buffer ), "%lld",
+             static_cast< long long >( value ) );
+   m_json += buffer;
+   return;
+}
+
+/**
+ * JSON has no representation for infinite and NaN values, so these are
+ * written as <code>null</code>.
+ *
+ * @param key The name of the property
+ * @param value The value of the property
+ */
+void SMetricsRecord::Add( const char* key, Double_t value ) {
+
+   AddKey( key );
+   if( std::isfinite( value ) ) {
+      char buffer[ 32 ];
+      snprintf( buffer, sizeof( buffer ), "%.15g", value );
+      m_json += buffer;
+   } else {
+      m_json += "null";
+   }
+   return;
+}
+
+/**
+ * @returns The record as a JSON object, without a trailing newline
+ */
+std::string SMetricsRecord::GetJSON() const {
+
+   return m_json + "}";
+}
+
+/**
+ * The function uses getrusage(...) to ask the kernel about the maximal
+ * resident set size of the process. Linux reports this in kilobytes, while
+ * MacOS X reports it in bytes.
+ *
+ * @returns The peak resident memory usage of the process in kilobytes
+ */
+Long64_t SMetricsRecord::GetPeakRSS() {
+
+   struct rusage usage;
+   if( getrusage( RUSAGE_SELF, &usage ) ) {
+      return -1;
+   }
+#ifdef __APPLE__
+   return usage.ru_maxrss / 1024;
+#else
+   return usage.ru_maxrss;
+#endif // __APPLE__
+}
+
+/**
+ * @param key The name of the new property
+ */
+void SMetricsRecord::AddKey( const char* key ) {
+
+   if( m_json.size() > 1 ) {
+      m_json += ",";
+   }
+   AddString( key );
+   m_json += ":";
+   return;
+}
+
+/**
+ * @param value The string to be added to the record in quotes
+ */
+void SMetricsRecord::AddString( const char* value ) {
+
+   m_json += "\"";
+   for( const char* c = value; c && *c; ++c ) {
+      switch( *c ) {
+      case '"':
+         m_json += "\\\"";
+         break;
+      case '\\':
+         m_json += "\\\\";
+         break;
+      case '\n':
+         m_json += "\\n";
+         break;
+      case '\t':
+         m_json += "\\t";
+         break;
+      default:
+         if( static_cast< unsigned char >( *c ) < 0x20 ) {
+            char buffer[ 8 ];
+            snprintf( buffer, sizeof( buffer ), "\\u%04x",
+                      static_cast< unsigned int >( *c ) );
+            m_json += buffer;
+         } else {
+            m_json += *c;
+         }
+         break;
+      }
+   }
+   m_json += "\"";
+   return;
+}
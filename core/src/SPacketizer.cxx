@@ -0,0 +1,370 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+// STL include(s):
+#include <algorithm>
+
+// ROOT include(s):
+#include <TChain.h>
+#include <TTree.h>
+
+// Local include(s):
+#include "../include/SPacketizer.h"
+
+namespace {
+
+   /// Number of entries per "cluster" when the cluster sizes are not known
+   static const Long64_t DEFAULT_CLUSTER_SIZE = 1000;
+   /// Number of packets per worker that the remaining entries are split into
+   static const Long64_t PACKETS_PER_WORKER = 4;
+
+} // private namespace
+
+/**
+ * @param nWorkers The number of workers requesting packets
+ * @param packetTime The desired processing time of one packet in seconds
+ */
+SPacketizer::SPacketizer( Int_t nWorkers, Double_t packetTime )
+   : m_nWorkers( nWorkers > 0 ? nWorkers : 1 ), m_packetTime( packetTime ),
+     m_boundaries(), m_units(), m_total( 0 ), m_remaining( 0 ),
+     m_packets( m_nWorkers, 0 ), m_steals( m_nWorkers, 0 ),
+     m_rates( m_nWorkers, 0.0 ), m_logger( "SPacketizer" ) {
+
+}
+
+/**
+ * The function collects the cluster boundaries of all the trees of the chain
+ * that overlap with the requested range of entries, and divides the files
+ * between the workers. The files are given out in decreasing size order, each
+ * to the worker with the least entries assigned so far.
+ *
+ * @param chain The chain to be processed
+ * @param first The first entry to be processed
+ * @param nentries The maximal number of entries to be processed
+ * @returns <code>kTRUE</code> if there are entries to process,
+ *          <code>kFALSE</code> otherwise
+ */
+Bool_t SPacketizer::Initialize( TChain& chain, Long64_t first,
+                                Long64_t nentries ) {
+
+   // Reset the object:
+   m_boundaries.clear();
+   m_units.clear();
+   m_packets.assign( m_nWorkers, 0 );
+   m_steals.assign( m_nWorkers, 0 );
+   m_rates.assign( m_nWorkers, 0.0 );
+
+   // The range of entries to process:
+   const Long64_t total = chain.GetEntries();
+   if( first < 0 ) first = 0;
+   const Long64_t end =
+      ( ( nentries < 0 ) || ( nentries > total - first ) ) ? total :
+      first + nentries;
+
+   //
+   // Collect the cluster boundaries, and the ranges in the files:
+   //
+   const Long64_t* offsets = chain.GetTreeOffset();
+   std::vector< Unit > units;
+   for( Int_t i = 0; i < chain.GetNtrees(); ++i ) {
+
+      // Skip the files outside of the range:
+      const Long64_t fileBegin = std::max( offsets[ i ], first );
+      const Long64_t fileEnd = std::min( offsets[ i + 1 ], end );
+      if( fileBegin >= fileEnd ) continue;
+
+      m_boundaries.push_back( fileBegin );
+      if( chain.LoadTree( offsets[ i ] ) < 0 ) {
+         REPORT_ERROR( "Couldn't load tree #" << i << " of the chain" );
+         return kFALSE;
+      }
+      TTree* tree = chain.GetTree();
+      const Long64_t entries = tree->GetEntries();
+#if ROOT_VERSION_CODE >= ROOT_VERSION( 5, 32, 0 )
+      TTree::TClusterIterator itr = tree->GetClusterIterator( 0 );
+      Long64_t start = 0;
+      while( ( start = itr() ) < entries ) {
+         const Long64_t entry = offsets[ i ] + start;
+         if( ( entry > fileBegin ) && ( entry < fileEnd ) ) {
+            m_boundaries.push_back( entry );
+         }
+      }
+#else
+      for( Long64_t start = DEFAULT_CLUSTER_SIZE; start < entries;
+           start += DEFAULT_CLUSTER_SIZE ) {
+         const Long64_t entry = offsets[ i ] + start;
+         if( ( entry > fileBegin ) && ( entry < fileEnd ) ) {
+            m_boundaries.push_back( entry );
+         }
+      }
+#endif // ROOT_VERSION
+
+      Unit unit;
+      unit.next = fileBegin;
+      unit.end = fileEnd;
+      unit.owner = -1;
+      units.push_back( unit );
+   }
+   if( units.size() ) {
+      m_boundaries.push_back( units.back().end );
+   }
+
+   //
+   // Assign the files to the workers:
+   //
+   std::vector< Long64_t > assigned( m_nWorkers, 0 );
+   std::vector< bool > done( units.size(), false );
+   m_total = 0;
+   for( size_t i = 0; i < units.size(); ++i ) {
+      // Find the largest unassigned file:
+      size_t largest = 0;
+      for( size_t j = 0; j < units.size(); ++j ) {
+         if( done[ j ] ) continue;
+         if( done[ largest ] || ( ( units[ j ].end - units[ j ].next ) >
+                                  ( units[ largest ].end -
+                                    units[ largest ].next ) ) ) {
+            largest = j;
+         }
+      }
+      // Give it to the worker with the fewest entries:
+      const Int_t worker = static_cast< Int_t >(
+         std::min_element( assigned.begin(), assigned.end() ) -
+         assigned.begin() );
+      done[ largest ] = true;
+      units[ largest ].owner = worker;
+      assigned[ worker ] += units[ largest ].end - units[ largest ].next;
+      m_total += units[ largest ].end - units[ largest ].next;
+   }
+   m_units = units;
+   m_remaining = m_total;
+
+   REPORT_VERBOSE( "Distributing " << m_total << " entries in "
+                   << m_boundaries.size() - m_units.size() << " clusters of "
+                   << m_units.size() << " file(s) between " << m_nWorkers
+                   << " workers" );
+
+   return ( m_total > 0 );
+}
+
+/**
+ * The size of the packet is calculated from the measured processing rate of
+ * the worker, and the number of entries still waiting to be processed. The
+ * end of the packet is then moved to the closest cluster boundary.
+ *
+ * @param worker The index of the worker requesting the packet
+ * @param packet The packet that the worker should process
+ * @returns <code>kTRUE</code> if a packet was given to the worker,
+ *          <code>kFALSE</code> if there is nothing left to process
+ */
+Bool_t SPacketizer::Next( Int_t worker, Packet& packet ) {
+
+   // Check the worker index:
+   if( ( worker < 0 ) || ( worker >= m_nWorkers ) ) {
+      REPORT_ERROR( "Invalid worker index: " << worker );
+      return kFALSE;
+   }
+
+   // Select the range to take the packet from:
+   Unit* unit = SelectUnit( worker );
+   if( ! unit ) {
+      return kFALSE;
+   }
+
+   //
+   // Decide about the size of the packet. Until the processing rate of the
+   // worker is known, give it a single cluster:
+   //
+   Long64_t size = 1;
+   if( m_rates[ worker ] > 0.0 ) {
+      size = static_cast< Long64_t >( m_rates[ worker ] * m_packetTime );
+   }
+   const Long64_t limit = m_remaining / ( m_nWorkers * PACKETS_PER_WORKER );
+   if( size > limit ) size = limit;
+   if( size < 1 ) size = 1;
+
+   // Make the packet end on a cluster boundary, containing at least one
+   // cluster:
+   Long64_t end = unit->end;
+   if( unit->next + size < unit->end ) {
+      end = Boundary( unit->next + size, unit->next, unit->end );
+      if( end <= unit->next ) {
+         end = *std::upper_bound( m_boundaries.begin(), m_boundaries.end(),
+                                  unit->next );
+      }
+   }
+
+   // Hand out the packet:
+   packet.first = unit->next;
+   packet.entries = end - unit->next;
+   unit->next = end;
+   m_remaining -= packet.entries;
+   ++m_packets[ worker ];
+
+   return kTRUE;
+}
+
+/**
+ * The processing rate of the worker is calculated as a running average of the
+ * rates measured on its packets.
+ *
+ * @param worker The index of the worker
+ * @param entries The number of entries processed in the last packet
+ * @param realTime The time it took to process the last packet (in seconds)
+ */
+void SPacketizer::Report( Int_t worker, Long64_t entries, Double_t realTime ) {
+
+   if( ( worker < 0 ) || ( worker >= m_nWorkers ) || ( realTime <= 0.0 ) ) {
+      return;
+   }
+
+   const Double_t rate = entries / realTime;
+   if( m_rates[ worker ] > 0.0 ) {
+      m_rates[ worker ] = 0.5 * ( m_rates[ worker ] + rate );
+   } else {
+      m_rates[ worker ] = rate;
+   }
+
+   return;
+}
+
+/**
+ * @returns The number of workers requesting packets
+ */
+Int_t SPacketizer::GetNWorkers() const {
+
+   return m_nWorkers;
+}
+
+/**
+ * @returns The total number of entries to be processed
+ */
+Long64_t SPacketizer::GetTotalEntries() const {
+
+   return m_total;
+}
+
+/**
+ * @returns The number of entries not handed out to any worker yet
+ */
+Long64_t SPacketizer::GetRemainingEntries() const {
+
+   return m_remaining;
+}
+
+/**
+ * @param worker The index of the worker
+ * @returns The number of packets handed out to the worker
+ */
+Int_t SPacketizer::GetPackets( Int_t worker ) const {
+
+   return m_packets.at( worker );
+}
+
+/**
+ * @param worker The index of the worker
+ * @returns The number of times the worker took entries from another worker
+ */
+Int_t SPacketizer::GetSteals( Int_t worker ) const {
+
+   return m_steals.at( worker );
+}
+
+/**
+ * @param worker The index of the worker
+ * @returns The measured processing rate of the worker in Hz
+ */
+Double_t SPacketizer::GetRate( Int_t worker ) const {
+
+   return m_rates.at( worker );
+}
+
+/**
+ * The worker first gets entries from its own files. Once it's done with all of
+ * them, it takes the second half of the largest remaining range of another
+ * worker. If that range is only a single cluster, it takes all of it.
+ *
+ * @param worker The index of the worker
+ * @returns The range to take the next packet from, or a null pointer if
+ *          there's nothing left to process
+ */
+SPacketizer::Unit* SPacketizer::SelectUnit( Int_t worker ) {
+
+   // Look for the worker's own ranges, and the largest range of the others:
+   Unit* largest = 0;
+   for( size_t i = 0; i < m_units.size(); ++i ) {
+      Unit& unit = m_units[ i ];
+      if( unit.next >= unit.end ) continue;
+      if( unit.owner == worker ) {
+         return &unit;
+      }
+      if( ( ! largest ) ||
+          ( ( unit.end - unit.next ) > ( largest->end - largest->next ) ) ) {
+         largest = &unit;
+      }
+   }
+   if( ! largest ) {
+      return 0;
+   }
+
+   // Steal the second half of the largest range:
+   ++m_steals[ worker ];
+   const Long64_t middle = Boundary( ( largest->next + largest->end ) / 2,
+                                     largest->next, largest->end );
+   if( middle <= largest->next ) {
+      largest->owner = worker;
+      return largest;
+   }
+   REPORT_VERBOSE( "Worker " << worker << " takes entries [" << middle
+                   << ", " << largest->end << ") from worker "
+                   << largest->owner );
+   Unit unit;
+   unit.next = middle;
+   unit.end = largest->end;
+   unit.owner = worker;
+   largest->end = middle;
+   m_units.push_back( unit );
+
+   return &m_units.back();
+}
+
+/**
+ * @param entry The entry to find the closest cluster boundary to
+ * @param begin The beginning of the range the boundary has to be in
+ * @param end The end of the range the boundary has to be in
+ * @returns The cluster boundary closest to the entry, strictly inside the
+ *          (begin, end) range, or <code>begin</code> if there's no cluster
+ *          boundary inside the range
+ */
+Long64_t SPacketizer::Boundary( Long64_t entry, Long64_t begin,
+                                Long64_t end ) const {
+
+   // The first boundary after the beginning of the range:
+   std::vector< Long64_t >::const_iterator lower =
+      std::upper_bound( m_boundaries.begin(), m_boundaries.end(), begin );
+   // The first boundary at, or after the end of the range:
+   std::vector< Long64_t >::const_iterator upper =
+      std::lower_bound( lower, m_boundaries.end(), end );
+   if( lower == upper ) {
+      return begin;
+   }
+
+   // Find the boundary closest to the entry:
+   std::vector< Long64_t >::const_iterator itr =
+      std::lower_bound( lower, upper, entry );
+   if( itr == upper ) {
+      return *( upper - 1 );
+   }
+   if( ( itr != lower ) && ( ( entry - *( itr - 1 ) ) < ( *itr - entry ) ) ) {
+      return *( itr - 1 );
+   }
+   return *itr;
+}
@@ -0,0 +1,231 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Core
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+// System include(s):
+#include <sys/time.h>
+
+// STL include(s):
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+
+// ROOT include(s):
+#include <TList.h>
+#include <TProof.h>
+
+// Local include(s):
+#include "../include/SProgressMonitor.h"
+#include "../include/SCycleProgress.h"
+#include "../include/SConstants.h"
+
+#ifndef DOXYGEN_IGNORE
+ClassImp( SProgressMonitor )
+#endif // DOXYGEN_IGNORE
+
+namespace {
+
+   /// Workers slower than this fraction of the median rate are reported
+   static const Double_t STRAGGLER_FRACTION = 0.5;
+
+   /// Format a time interval as HH:MM:SS
+   TString FormatTime( Double_t seconds ) {
+
+      const Long64_t sec = static_cast< Long64_t >( seconds + 0.5 );
+      return TString::Format( "%02lld:%02lld:%02lld", sec / 3600,
+                              ( sec / 60 ) % 60, sec % 60 );
+   }
+
+} // private namespace
+
+/**
+ * @param interval The minimum time between two reports (in seconds)
+ */
+SProgressMonitor::SProgressMonitor( Double_t interval )
+   : m_interval( interval ), m_totalEvents( -1 ), m_startTime( Now() ),
+     m_lastReport( m_startTime ), m_proof( 0 ),
+     m_logger( "SProgressMonitor" ) {
+
+}
+
+/**
+ * The destructor makes sure that PROOF doesn't try to send feedback to the
+ * object after it was deleted.
+ */
+SProgressMonitor::~SProgressMonitor() {
+
+   Disconnect();
+}
+
+/**
+ * @param interval The minimum time between two reports (in seconds). Zero or
+ *                 a negative value turns the reports off.
+ */
+void SProgressMonitor::SetInterval( Double_t interval ) {
+
+   m_interval = interval;
+   return;
+}
+
+/**
+ * @param totalEvents The number of events to process, or a negative number if
+ *                    it is not known
+ */
+void SProgressMonitor::Start( Long64_t totalEvents ) {
+
+   m_totalEvents = totalEvents;
+   m_startTime = Now();
+   m_lastReport = m_startTime;
+   return;
+}
+
+/**
+ * The function asks PROOF to send the SCycleProgress objects of the workers
+ * to the client at the reporting interval, and connects this object to the
+ * signal emitted when they arrive.
+ *
+ * @param proof The PROOF session running the event processing
+ */
+void SProgressMonitor::Connect( TProof* proof ) {
+
+   // Check if the reports are turned off:
+   if( ( m_interval <= 0.0 ) || ( ! proof ) ) {
+      return;
+   }
+
+   Disconnect();
+   m_proof = proof;
+   m_proof->SetParameter( "PROOF_FeedbackPeriod",
+                          ( Long_t ) ( m_interval * 1000.0 ) );
+   m_proof->AddFeedback( SFrame::CycleProgressName );
+   m_proof->Connect( "Feedback(TList*)", "SProgressMonitor", this,
+                     "Feedback(TList*)" );
+
+   return;
+}
+
+/**
+ * The function doesn't do anything if the object was not connected to a
+ * PROOF session.
+ */
+void SProgressMonitor::Disconnect() {
+
+   if( ! m_proof ) {
+      return;
+   }
+
+   m_proof->Disconnect( "Feedback(TList*)", this, "Feedback(TList*)" );
+   m_proof->RemoveFeedback( SFrame::CycleProgressName );
+   m_proof = 0;
+
+   return;
+}
+
+/**
+ * The overall rate is calculated from the number of events processed by all
+ * the workers, and the time since Start() was called. The processing rates of
+ * the individual workers are compared to their median, to find the workers
+ * that slow down the whole job.
+ *
+ * @param progress The progress of the workers
+ * @param force If <code>kTRUE</code>, the report is printed regardless of the
+ *              time passed since the last report
+ */
+void SProgressMonitor::Update( const SCycleProgress& progress, Bool_t force ) {
+
+   // Check if a report is due:
+   const Double_t now = Now();
+   if( ( ! force ) &&
+       ( ( m_interval <= 0.0 ) || ( ( now - m_lastReport ) < m_interval ) ) ) {
+      return;
+   }
+   m_lastReport = now;
+
+   // Calculate the overall processing rate:
+   const Long64_t events = progress.GetTotalEvents();
+   const Double_t elapsed = now - m_startTime;
+   const Double_t rate = ( elapsed > 0.0 ? events / elapsed : 0.0 );
+
+   // Print the overall progress:
+   m_logger.setf( std::ios::fixed );
+   m_logger << INFO << "Processed " << events;
+   if( m_totalEvents > 0 ) {
+      m_logger << " / " << m_totalEvents << " events ("
+               << std::setprecision( 1 )
+               << ( 100.0 * events / m_totalEvents ) << "%)";
+   } else {
+      m_logger << " events";
+   }
+   m_logger << " - " << std::setprecision( 1 ) << rate << " Hz";
+   if( ( m_totalEvents > 0 ) && ( rate > 0.0 ) ) {
+      const Double_t remaining =
+         ( m_totalEvents > events ? m_totalEvents - events : 0 ) / rate;
+      m_logger << " - ETA: " << FormatTime( remaining );
+   }
+   m_logger << " (" << progress.GetNWorkers() << " worker"
+            << ( progress.GetNWorkers() == 1 ? "" : "s" ) << ")"
+            << SLogger::endmsg;
+
+   // Look for stragglers if there are multiple workers:
+   if( progress.GetNWorkers() < 2 ) {
+      return;
+   }
+   std::vector< Double_t > rates;
+   for( size_t i = 0; i < progress.GetNWorkers(); ++i ) {
+      rates.push_back( progress.GetRate( i ) );
+   }
+   std::nth_element( rates.begin(), rates.begin() + rates.size() / 2,
+                     rates.end() );
+   const Double_t median = rates[ rates.size() / 2 ];
+   for( size_t i = 0; i < progress.GetNWorkers(); ++i ) {
+      if( progress.GetRate( i ) < STRAGGLER_FRACTION * median ) {
+         m_logger << WARNING << "  Slow worker: " << progress.GetWorker( i )
+                  << " - " << std::setprecision( 1 ) << progress.GetRate( i )
+                  << " Hz (median: " << median << " Hz, "
+                  << progress.GetEvents( i ) << " events)"
+                  << SLogger::endmsg;
+      }
+   }
+
+   return;
+}
+
+/**
+ * This function is called by PROOF when the feedback objects arrive from the
+ * workers.
+ *
+ * @param objects The list of merged feedback objects
+ */
+void SProgressMonitor::Feedback( TList* objects ) {
+
+   if( ! objects ) {
+      return;
+   }
+   SCycleProgress* progress =
+      dynamic_cast< SCycleProgress* >(
+         objects->FindObject( SFrame::CycleProgressName ) );
+   if( progress ) {
+      Update( *progress );
+   }
+
+   return;
+}
+
+/**
+ * @returns The current time in seconds, with microsecond precision
+ */
+Double_t SProgressMonitor::Now() {
+
+   struct timeval tv;
+   gettimeofday( &tv, 0 );
+   return ( static_cast< Double_t >( tv.tv_sec ) +
+            static_cast< Double_t >( tv.tv_usec ) * 1e-6 );
+}
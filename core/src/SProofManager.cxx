@@ -10,6 +10,10 @@
  *
  ***************************************************************************/
 
+// STL include(s):
+#include <fstream>
+#include <sstream>
+
 // ROOT include(s):
 #include <TProof.h>
 #include <TProofMgr.h>
@@ -18,6 +22,8 @@
 #include <TList.h>
 #include <TObjArray.h>
 #include <TObjString.h>
+#include <TSystem.h>
+#include <TMD5.h>
 
 // Local include(s):
 #include "../include/SProofManager.h"
@@ -25,6 +31,19 @@
 // Initialize the static variable:
 SProofManager* SProofManager::m_instance = 0;
 
+namespace {
+
+   /// Key identifying a package on a given PROOF server in the package cache
+   std::string PackageKey( const TString& url, const TString& package ) {
+
+      // An empty server name means PROOF-Lite as well:
+      const TString server = ( url == "" ? "lite" : url.Data() );
+      return std::string( server.Data() ) + " " +
+         gSystem->BaseName( package );
+   }
+
+} // private namespace
+
 /**
  * The destructor cleans up the open connections by calling the Cleanup()
  * function internally.
@@ -233,6 +252,88 @@ void SProofManager::SetConfigured( const TString& url,
    return;
 }
 
+/**
+ * The connections are kept open, but the packages needed by the next job are
+ * uploaded/enabled on all servers again. (Already enabled packages are not
+ * loaded again by PROOF.)
+ */
+void SProofManager::ResetConfigured() {
+
+   for( ConnMap_t::iterator conn = m_connections.begin();
+        conn != m_connections.end(); ++conn ) {
+      conn->second.second = kFALSE;
+   }
+
+   return;
+}
+
+/**
+ * PROOF servers keep the uploaded and built packages in their sandboxes, even
+ * after the sessions using them are closed. So if a job enabled a package on
+ * a server, and the package file didn't change since then, a new job doesn't
+ * need to upload it again.
+ *
+ * @param url     Name of the PROOF server
+ * @param package Full path name of the PAR package
+ * @returns <code>kTRUE</code> if the same package was already enabled on the
+ *          server, <code>kFALSE</code> otherwise
+ */
+Bool_t SProofManager::IsPackageEnabled( const TString& url,
+                                        const TString& package ) {
+
+   // Read the checksums from the previous jobs:
+   ReadPackageCache();
+
+   // Look for the package:
+   const std::string key = PackageKey( url, package );
+   std::map< std::string, std::string >::const_iterator itr =
+      m_packages.find( key );
+   if( itr == m_packages.end() ) {
+      return kFALSE;
+   }
+
+   // Check if it changed since it was enabled:
+   return ( itr->second == PackageChecksum( package ) );
+}
+
+/**
+ * The checksum of the package is saved into the package cache file right
+ * away, so that the information would be available to the next jobs even if
+ * this job crashes later on.
+ *
+ * @param url     Name of the PROOF server
+ * @param package Full path name of the PAR package
+ */
+void SProofManager::SetPackageEnabled( const TString& url,
+                                       const TString& package ) {
+
+   // Read the checksums from the previous jobs:
+   ReadPackageCache();
+
+   // Update the checksum of the package:
+   const std::string key = PackageKey( url, package );
+   m_packages[ key ] = PackageChecksum( package );
+
+   // Write out the updated cache:
+   const TString fileName = PackageCacheFile();
+   gSystem->mkdir( gSystem->DirName( fileName ), kTRUE );
+   std::ofstream file( fileName.Data(), std::ios::trunc );
+   if( ! file.is_open() ) {
+      m_logger << WARNING << "Couldn't write package cache file: "
+               << fileName << SLogger::endmsg;
+      return;
+   }
+   std::map< std::string, std::string >::const_iterator itr =
+      m_packages.begin();
+   std::map< std::string, std::string >::const_iterator end =
+      m_packages.end();
+   for( ; itr != end; ++itr ) {
+      file << itr->first << " " << itr->second << std::endl;
+   }
+
+   return;
+}
+
 /**
  * This function can be used to clean up the PROOF connections. Even if it's
  * only called at the termination of the sframe_main program, it's still very
@@ -264,8 +365,68 @@ void SProofManager::Cleanup() {
  * anything in addition.
  */
 SProofManager::SProofManager()
-   : m_connections(), m_logger( "SProofManager" ) {
+   : m_connections(), m_packages(), m_packagesRead( kFALSE ),
+     m_logger( "SProofManager" ) {
+
+}
+
+/**
+ * The location of the file can be changed using the SFRAME_PROOF_CACHE
+ * environment variable.
+ *
+ * @returns The name of the file holding the package checksums
+ */
+TString SProofManager::PackageCacheFile() {
+
+   if( gSystem->Getenv( "SFRAME_PROOF_CACHE" ) ) {
+      return gSystem->Getenv( "SFRAME_PROOF_CACHE" );
+   }
+   return TString( gSystem->HomeDirectory() ) + "/.sframe/ProofPackages.txt";
+}
 
+/**
+ * Each line of the file holds the name of a PROOF server, the name of a
+ * package, and the checksum of the package that was enabled on the server
+ * last time.
+ */
+void SProofManager::ReadPackageCache() {
+
+   // Only read the file once:
+   if( m_packagesRead ) return;
+   m_packagesRead = kTRUE;
+
+   // It's not a problem if the file doesn't exist:
+   std::ifstream file( PackageCacheFile().Data() );
+   if( ! file.is_open() ) return;
+
+   std::string line;
+   while( std::getline( file, line ) ) {
+      std::istringstream values( line );
+      std::string server, package, checksum;
+      if( values >> server >> package >> checksum ) {
+         m_packages[ server + " " + package ] = checksum;
+      }
+   }
+   REPORT_VERBOSE( "Read " << m_packages.size() << " package checksum(s) "
+                   << "from: " << PackageCacheFile() );
+
+   return;
+}
+
+/**
+ * @param package Full path name of the PAR package
+ * @returns The MD5 checksum of the package file, or an empty string if the
+ *          file couldn't be read
+ */
+std::string SProofManager::PackageChecksum( const TString& package ) {
+
+   TMD5* md5 = TMD5::FileChecksum( package );
+   if( ! md5 ) {
+      return "";
+   }
+   const std::string result = md5->AsString();
+   delete md5;
+   return result;
 }
 
 /**
@@ -0,0 +1,294 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Plug-ins
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ * Small benchmark comparing the SKinematics functions working on
+ * SParticleCollection objects with the same calculations done one particle
+ * (pair) at a time on std::vector< SParticle > objects. The vectorised
+ * coordinate conversions are also compared to simple loops calling the
+ * standard mathematical functions.
+ *
+ ***************************************************************************/
+
+// System include(s):
+#include <cstdlib>
+#include <cmath>
+
+// STL include(s):
+#include <vector>
+#include <algorithm>
+
+// ROOT include(s):
+#include <TRandom3.h>
+#include <TStopwatch.h>
+#include <Math/VectorUtil.h>
+
+// SFrame include(s):
+#include "core/include/SLogger.h"
+
+// Local include(s):
+#include "../include/SParticle.h"
+#include "../include/SParticleCollection.h"
+#include "../include/SKinematics.h"
+
+// Global logging object
+static SLogger m_logger( "sframe_bench_kinematics" );
+
+namespace {
+
+   /// Function object ordering particles by decreasing p<sub>T</sub>
+   class GreaterPt {
+   public:
+      bool operator()( const SParticle& p1, const SParticle& p2 ) const {
+         return ( p1.Pt() > p2.Pt() );
+      }
+   }; // class GreaterPt
+
+   /// Print the result of one measurement
+   void Report( const char* name, TStopwatch& vecTimer,
+                TStopwatch& collTimer, Double_t vecSum, Double_t collSum,
+                Int_t nEvents,
+                const char* vecName = "std::vector< SParticle >",
+                const char* collName = "SParticleCollection" ) {
+
+      const Double_t vecTime = vecTimer.CpuTime() * 1e9 / nEvents;
+      const Double_t collTime = collTimer.CpuTime() * 1e9 / nEvents;
+      m_logger << INFO << name << ": " << vecName << ": " << vecTime
+               << " ns/event, " << collName << ": " << collTime
+               << " ns/event, speed-up: "
+               << ( collTime > 0.0 ? vecTime / collTime : 0.0 )
+               << SLogger::endmsg;
+      if( std::abs( vecSum - collSum ) > 1e-6 * std::abs( vecSum ) ) {
+         m_logger << WARNING << name << ": The two calculations disagree: "
+                  << vecSum << " vs. " << collSum << SLogger::endmsg;
+      }
+
+      return;
+   }
+
+} // private namespace
+
+int main( int argc, char** argv ) {
+
+   // The number of events and particles per event to use:
+   const Int_t nEvents = ( argc > 1 ? std::atoi( argv[ 1 ] ) : 100000 );
+   const Int_t nParticles = ( argc > 2 ? std::atoi( argv[ 2 ] ) : 8 );
+   if( ( nEvents < 1 ) || ( nParticles < 2 ) ) {
+      m_logger << INFO << "Usage: " << argv[ 0 ] << " [events] [particles]"
+               << SLogger::endmsg;
+      return 1;
+   }
+   m_logger << INFO << "Using " << nEvents << " events with " << nParticles
+            << " particles each" << SLogger::endmsg;
+
+   // Generate the same particles in both formats:
+   TRandom3 rand( 4357 );
+   std::vector< std::vector< SParticle > > vecEvents( nEvents );
+   std::vector< SParticleCollection > collEvents( nEvents );
+   for( Int_t i = 0; i < nEvents; ++i ) {
+      for( Int_t j = 0; j < nParticles; ++j ) {
+         const Double_t pt = rand.Exp( 30.0 ) + 10.0;
+         const Double_t eta = rand.Uniform( -2.5, 2.5 );
+         const Double_t phi = rand.Uniform( -TMath::Pi(), TMath::Pi() );
+         const Double_t e = pt * std::cosh( eta ) + rand.Uniform( 0., 5. );
+         vecEvents[ i ].push_back( SParticle( pt, eta, phi, e ) );
+         collEvents[ i ].push_back( pt, eta, phi, e );
+      }
+   }
+
+   TStopwatch vecTimer, collTimer;
+   Double_t vecSum = 0.0, collSum = 0.0;
+
+   //
+   // Delta R between all the particle pairs:
+   //
+   vecTimer.Start();
+   for( Int_t i = 0; i < nEvents; ++i ) {
+      const std::vector< SParticle >& p = vecEvents[ i ];
+      for( size_t a = 0; a < p.size(); ++a ) {
+         for( size_t b = 0; b < p.size(); ++b ) {
+            vecSum += ROOT::Math::VectorUtil::DeltaR( p[ a ], p[ b ] );
+         }
+      }
+   }
+   vecTimer.Stop();
+   std::vector< Double_t > matrix;
+   collTimer.Start();
+   for( Int_t i = 0; i < nEvents; ++i ) {
+      SKinematics::DeltaRMatrix( collEvents[ i ], collEvents[ i ], matrix );
+      for( size_t a = 0; a < matrix.size(); ++a ) {
+         collSum += matrix[ a ];
+      }
+   }
+   collTimer.Stop();
+   Report( "DeltaRMatrix", vecTimer, collTimer, vecSum, collSum, nEvents );
+
+   //
+   // Best invariant mass pair:
+   //
+   vecSum = 0.0; collSum = 0.0;
+   vecTimer.Start();
+   for( Int_t i = 0; i < nEvents; ++i ) {
+      const std::vector< SParticle >& p = vecEvents[ i ];
+      Double_t bestMass = 0.0, bestDiff = -1.0;
+      for( size_t a = 0; a < p.size() - 1; ++a ) {
+         for( size_t b = a + 1; b < p.size(); ++b ) {
+            const Double_t mass = ( p[ a ] + p[ b ] ).M();
+            const Double_t diff = std::abs( mass - 91.1876 );
+            if( ( bestDiff < 0.0 ) || ( diff < bestDiff ) ) {
+               bestDiff = diff;
+               bestMass = mass;
+            }
+         }
+      }
+      vecSum += bestMass;
+   }
+   vecTimer.Stop();
+   collTimer.Start();
+   for( Int_t i = 0; i < nEvents; ++i ) {
+      collSum += SKinematics::BestPairMass( collEvents[ i ], 91.1876 );
+   }
+   collTimer.Stop();
+   Report( "BestPairMass", vecTimer, collTimer, vecSum, collSum, nEvents );
+
+   //
+   // Sorting by transverse momentum:
+   //
+   vecSum = 0.0; collSum = 0.0;
+   vecTimer.Start();
+   for( Int_t i = 0; i < nEvents; ++i ) {
+      std::vector< SParticle > p( vecEvents[ i ] );
+      std::stable_sort( p.begin(), p.end(), GreaterPt() );
+      vecSum += p.front().Pt();
+   }
+   vecTimer.Stop();
+   collTimer.Start();
+   for( Int_t i = 0; i < nEvents; ++i ) {
+      SParticleCollection p( collEvents[ i ] );
+      SKinematics::SortByPt( p );
+      collSum += p.Pt( 0 );
+   }
+   collTimer.Stop();
+   Report( "SortByPt", vecTimer, collTimer, vecSum, collSum, nEvents );
+
+   //
+   // Cartesian coordinates of all the particles:
+   //
+   vecSum = 0.0; collSum = 0.0;
+   vecTimer.Start();
+   for( Int_t i = 0; i < nEvents; ++i ) {
+      const std::vector< SParticle >& p = vecEvents[ i ];
+      for( size_t a = 0; a < p.size(); ++a ) {
+         vecSum += p[ a ].Px() + p[ a ].Py() + p[ a ].Pz();
+      }
+   }
+   vecTimer.Stop();
+   std::vector< Double_t > px( nParticles ), py( nParticles ),
+      pz( nParticles );
+   collTimer.Start();
+   for( Int_t i = 0; i < nEvents; ++i ) {
+      const SParticleCollection& p = collEvents[ i ];
+      SKinematics::ToCartesian( p.size(), &( p.GetPt()[ 0 ] ),
+                                &( p.GetEta()[ 0 ] ), &( p.GetPhi()[ 0 ] ),
+                                &px[ 0 ], &py[ 0 ], &pz[ 0 ] );
+      for( size_t a = 0; a < p.size(); ++a ) {
+         collSum += px[ a ] + py[ a ] + pz[ a ];
+      }
+   }
+   collTimer.Stop();
+   Report( "ToCartesian", vecTimer, collTimer, vecSum, collSum, nEvents );
+
+   //
+   // The coordinate conversions on the particles of all events at once,
+   // compared to scalar loops calling the standard mathematical functions.
+   // These measure how much the vectorisation of the SKinematics loops
+   // gains. The loops are repeated a few times, so that the timer has enough
+   // time to measure.
+   //
+   const Int_t nRepeat = 10;
+   const size_t nAll = collEvents.size() * nParticles, last = nAll - 1;
+   std::vector< Double_t > pt, eta, phi, e;
+   pt.reserve( nAll ); eta.reserve( nAll ); phi.reserve( nAll );
+   e.reserve( nAll );
+   for( Int_t i = 0; i < nEvents; ++i ) {
+      const SParticleCollection& p = collEvents[ i ];
+      pt.insert( pt.end(), p.GetPt().begin(), p.GetPt().end() );
+      eta.insert( eta.end(), p.GetEta().begin(), p.GetEta().end() );
+      phi.insert( phi.end(), p.GetPhi().begin(), p.GetPhi().end() );
+      e.insert( e.end(), p.GetE().begin(), p.GetE().end() );
+   }
+   std::vector< Double_t > out1( nAll ), out2( nAll ), out3( nAll );
+
+   vecSum = 0.0; collSum = 0.0;
+   vecTimer.Start();
+   for( Int_t r = 0; r < nRepeat; ++r ) {
+      for( size_t a = 0; a < nAll; ++a ) {
+         out1[ a ] = pt[ a ] * std::cos( phi[ a ] );
+         out2[ a ] = pt[ a ] * std::sin( phi[ a ] );
+         out3[ a ] = pt[ a ] * std::sinh( eta[ a ] );
+      }
+      vecSum += out1[ last ] + out2[ last ] + out3[ last ];
+   }
+   vecTimer.Stop();
+   collTimer.Start();
+   for( Int_t r = 0; r < nRepeat; ++r ) {
+      SKinematics::ToCartesian( nAll, &pt[ 0 ], &eta[ 0 ], &phi[ 0 ],
+                                &out1[ 0 ], &out2[ 0 ], &out3[ 0 ] );
+      collSum += out1[ last ] + out2[ last ] + out3[ last ];
+   }
+   collTimer.Stop();
+   Report( "ToCartesian", vecTimer, collTimer, vecSum, collSum,
+           nEvents * nRepeat, "scalar loop", "SKinematics" );
+
+   // Keep the cartesian coordinates for the inverse conversion:
+   px = out1; py = out2; pz = out3;
+
+   vecSum = 0.0; collSum = 0.0;
+   vecTimer.Start();
+   for( Int_t r = 0; r < nRepeat; ++r ) {
+      for( size_t a = 0; a < nAll; ++a ) {
+         out1[ a ] = std::sqrt( px[ a ] * px[ a ] + py[ a ] * py[ a ] );
+         out2[ a ] = ( out1[ a ] > 0.0 ?
+                       TMath::ASinH( pz[ a ] / out1[ a ] ) : 0.0 );
+         out3[ a ] = std::atan2( py[ a ], px[ a ] );
+      }
+      vecSum += out1[ last ] + out2[ last ] + out3[ last ];
+   }
+   vecTimer.Stop();
+   collTimer.Start();
+   for( Int_t r = 0; r < nRepeat; ++r ) {
+      SKinematics::ToPtEtaPhi( nAll, &px[ 0 ], &py[ 0 ], &pz[ 0 ],
+                               &out1[ 0 ], &out2[ 0 ], &out3[ 0 ] );
+      collSum += out1[ last ] + out2[ last ] + out3[ last ];
+   }
+   collTimer.Stop();
+   Report( "ToPtEtaPhi", vecTimer, collTimer, vecSum, collSum,
+           nEvents * nRepeat, "scalar loop", "SKinematics" );
+
+   vecSum = 0.0; collSum = 0.0;
+   vecTimer.Start();
+   for( Int_t r = 0; r < nRepeat; ++r ) {
+      for( size_t a = 0; a < nAll; ++a ) {
+         out1[ a ] = e[ a ] / std::cosh( eta[ a ] );
+      }
+      vecSum += out1[ last ];
+   }
+   vecTimer.Stop();
+   collTimer.Start();
+   for( Int_t r = 0; r < nRepeat; ++r ) {
+      SKinematics::ToEt( nAll, &eta[ 0 ], &e[ 0 ], &out1[ 0 ] );
+      collSum += out1[ last ];
+   }
+   collTimer.Stop();
+   Report( "ToEt", vecTimer, collTimer, vecSum, collSum,
+           nEvents * nRepeat, "scalar loop", "SKinematics" );
+
+   // Return gracefully:
+   return 0;
+}
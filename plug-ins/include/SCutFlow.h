@@ -0,0 +1,162 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Plug-ins
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_PLUGINS_SCutFlow_H
+#define SFRAME_PLUGINS_SCutFlow_H
+
+// STL include(s):
+#include <vector>
+#include <string>
+
+// ROOT include(s):
+#include <TNamed.h>
+#include <TString.h>
+
+// Forward declaration(s):
+class TCollection;
+class TH1;
+
+/**
+ *   @short Cutflow bookkeeping object
+ *
+ *          Most analysis cycles need to keep track of how many events pass
+ *          each step of their event selection. This class can be used to do
+ *          this bookkeeping in a standard way. It keeps track of the raw and
+ *          weighted number of events passing each cut, and optionally of the
+ *          CPU time spent in evaluating each cut.
+ *
+ *          The object should be booked in <code>BeginInputData(...)</code>
+ *          like any other output object, and the cuts should be registered
+ *          right after that:
+ *
+ *          <code>
+ *            In BeginInputData:
+ *              m_cutFlow = Book( SCutFlow( "cutflow", "Cutflow", kTRUE ) );
+ *              m_allCut = m_cutFlow->Register( "all" );
+ *              m_elCut  = m_cutFlow->Register( "electron" );
+ *
+ *            In ExecuteEvent:
+ *              m_cutFlow->BeginEvent();
+ *              m_cutFlow->Pass( m_allCut, weight );
+ *              if( ! m_cutFlow->Apply( m_elCut, m_El_N > 0, weight ) ) {
+ *                 throw SError( SError::SkipEvent );
+ *              }
+ *          </code>
+ *
+ *          The CPU time attributed to a cut is the time spent between the
+ *          previous call to BeginEvent(), Apply(...) or Pass(...), and the
+ *          call to Apply(...) or Pass(...) for the given cut. So the code
+ *          evaluating a cut should be placed right before the call to Apply.
+ *
+ *          When written to the output file, the object is written as a
+ *          histogram of the raw (NAME_raw) and weighted (NAME_weighted) pass
+ *          counts, a histogram of the CPU times (NAME_cpu) if timing was
+ *          requested, and a printable table (NAME_table).
+ *
+ * @version $Revision$
+ */
+class SCutFlow : public TNamed {
+
+public:
+   /// Default constructor
+   SCutFlow( const char* name = 0, const char* title = 0,
+             Bool_t timing = kFALSE );
+   /// Copy constructor
+   SCutFlow( const SCutFlow& parent );
+   /// Destructor
+   ~SCutFlow();
+
+   /// Register a new cut, and get its index
+   Int_t Register( const std::string& cut );
+   /// Find the index of a cut
+   Int_t FindCut( const std::string& cut ) const;
+   /// Get the number of registered cuts
+   Int_t GetNCuts() const;
+   /// Get the name of a cut
+   const std::string& GetCutName( Int_t cut ) const;
+
+   /// Signal the start of a new event (for the timing)
+   void BeginEvent();
+   /// Record the result of a cut
+   Bool_t Apply( Int_t cut, Bool_t passed, Double_t weight = 1.0 );
+   /// Record that an event passed a cut
+   void Pass( Int_t cut, Double_t weight = 1.0 );
+
+   /// Get the raw number of events passing a cut
+   Long64_t GetRawCount( Int_t cut ) const;
+   /// Get the weighted number of events passing a cut
+   Double_t GetWeightedCount( Int_t cut ) const;
+   /// Get the uncertainty of the weighted number of events passing a cut
+   Double_t GetWeightedError( Int_t cut ) const;
+   /// Get the CPU time spent on evaluating a cut (in seconds)
+   Double_t GetCpuTime( Int_t cut ) const;
+
+   /// Check whether the CPU time measurement is turned on
+   Bool_t GetTiming() const;
+   /// Turn the CPU time measurement on or off
+   void SetTiming( Bool_t timing );
+
+   /// Get the cutflow in a printable table
+   TString GetTable() const;
+   /// Print the cutflow table
+   virtual void Print( Option_t* option = "" ) const;
+
+   /// Merge a collection of SCutFlow objects
+   virtual Int_t Merge( TCollection* coll );
+   /// Write the cutflow as histograms and a table (const version)
+   virtual Int_t Write( const char* name = 0, Int_t option = 0,
+                        Int_t bufsize = 0 ) const;
+   /// Write the cutflow as histograms and a table (non-const version)
+   virtual Int_t Write( const char* name = 0, Int_t option = 0,
+                        Int_t bufsize = 0 );
+
+private:
+   /// The assignment operator is not implemented
+   SCutFlow& operator=( const SCutFlow& );
+
+   /// Add the contents of another cutflow to this one
+   void Add( const SCutFlow& other );
+   /// Add the contents of previously written histograms to this cutflow
+   void Add( const TH1* raw, const TH1* weighted, const TH1* cpu );
+   /// Create a histogram out of one of the arrays
+   TH1* MakeHist( const TString& name, const Double_t* values,
+                  const Double_t* errors2 ) const;
+   /// Check the validity of a cut index
+   void CheckCut( Int_t cut ) const;
+   /// Get the current CPU time
+   static Double_t CpuTime();
+
+   /// Names of the cuts
+   std::vector< std::string > m_cuts;
+   /// Number of registered cuts
+   Int_t m_nCuts;
+   /// Raw number of events passing the cuts
+   Double_t* m_raw; //[m_nCuts]
+   /// Weighted number of events passing the cuts
+   Double_t* m_weighted; //[m_nCuts]
+   /// Sum of the squares of the weights of the events passing the cuts
+   Double_t* m_weighted2; //[m_nCuts]
+   /// CPU time spent on evaluating the cuts
+   Double_t* m_cpuTime; //[m_nCuts]
+   /// Flag for turning on the CPU time measurement
+   Bool_t m_timing;
+   /// CPU time at the last checkpoint
+   Double_t m_lastTime; //!
+
+#ifndef DOXYGEN_IGNORE
+   ClassDef( SCutFlow, 1 )
+#endif // DOXYGEN_IGNORE
+
+}; // class SCutFlow
+
+#endif // SFRAME_PLUGINS_SCutFlow_H
@@ -22,6 +22,7 @@
 // The plug-in classes:
 #pragma link C++ class SParticle+;
 #pragma link C++ class vector<SParticle>+;
+#pragma link C++ class SParticleCollection+;
 
 #pragma link C++ class ProofSummedVar<Short_t>+;
 #pragma link C++ class ProofSummedVar<UShort_t>+;
@@ -56,8 +57,20 @@
 #pragma link C++ class ProofSummedVar<map<string,float> >+;
 #pragma link C++ class ProofSummedVar<map<string,double> >+;
 
+#pragma link C++ class ProofSummedArray<Int_t>+;
+#pragma link C++ class ProofSummedArray<UInt_t>+;
+#pragma link C++ class ProofSummedArray<Long64_t>+;
+#pragma link C++ class ProofSummedArray<ULong64_t>+;
+#pragma link C++ class ProofSummedArray<Float_t>+;
+#pragma link C++ class ProofSummedArray<Double_t>+;
+
+#pragma link C++ class SCutFlow+;
+
 #pragma link C++ class SH1F+;
 #pragma link C++ class SH1D+;
 #pragma link C++ class SH1I+;
 
+#pragma link C++ class SHistBankF+;
+#pragma link C++ class SHistBankD+;
+
 #endif // __CINT__
@@ -0,0 +1,173 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Plug-ins
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_PLUGINS_SHistBank_H
+#define SFRAME_PLUGINS_SHistBank_H
+
+// STL include(s):
+#include <vector>
+#include <string>
+
+// ROOT include(s):
+#include <TNamed.h>
+
+// SFrame include(s):
+#include "core/include/SError.h"
+
+// Forward declaration(s):
+class TCollection;
+class TDirectory;
+class TH1;
+
+/**
+ *  @short Bank of 1-dimensional histograms for systematic variations
+ *
+ *         Analyses very often need to book the same histogram for many
+ *         different systematic variations. Doing this with one TH1 (or SH1)
+ *         object per variation means that the cycle has to book, look up,
+ *         merge and write out each of these objects separately.
+ *
+ *         This class stores the histograms belonging to a whole "variation
+ *         axis" in a single contiguous array, where the variation index is
+ *         the fast changing index. So filling all the variations for an event
+ *         only touches a small, contiguous region of memory. The object is
+ *         booked with a single SCycleBaseHist::Book call, and is merged as a
+ *         single object on PROOF.
+ *
+ *         When written to the output file, the bank is unpacked into one TH1
+ *         histogram per variation. The histograms are put into
+ *         sub-directories named after the variations, under the directory
+ *         that the bank was booked in. So the output file looks exactly the
+ *         same as if the histograms would've been booked one by one.
+ *
+ *         Example:
+ *
+ *         <code>
+ *           std::vector< std::string > vars;
+ *           vars.push_back( "nominal" ); vars.push_back( "JES_up" );
+ *           SHistBankD* bank =
+ *              Book( SHistBankD( "pt", "p_{T}", 100, 0.0, 100.0, vars ) );
+ *           ...
+ *           bank->Fill( pt, weights );
+ *         </code>
+ *
+ * @version $Revision$
+ */
+template< typename Type >
+class SHistBank : public TNamed {
+
+public:
+   /// Default constructor
+   SHistBank();
+   /// Regular constructor with all parameters
+   SHistBank( const char* name, const char* title, Int_t bins,
+              Double_t low, Double_t high,
+              const std::vector< std::string >& variations,
+              Bool_t computeErrors = kTRUE );
+   /// Destructor
+   virtual ~SHistBank();
+
+   /// Fill all the variations at the same position, with different weights
+   void Fill( Double_t pos, const Type* weights );
+   /// Fill all the variations at the same position, with different weights
+   void Fill( Double_t pos, const std::vector< Type >& weights );
+   /// Fill all the variations at different positions, with different weights
+   void Fill( const Double_t* pos, const Type* weights );
+   /// Fill a single variation of the bank
+   void Fill( Int_t var, Double_t pos, Type weight = 1 );
+
+   /// Get the number of variations in the bank
+   Int_t GetNVariations() const;
+   /// Get the name of one of the variations
+   const std::string& GetVariationName( Int_t var ) const;
+   /// Find the index of a variation with a given name
+   Int_t FindVariation( const std::string& name ) const;
+
+   /// Get the number of bins of the histograms
+   Int_t GetNBins() const;
+   /// Find the bin belonging to a specific position on the axis
+   Int_t FindBin( Double_t pos ) const;
+
+   /// Get the content of a specific bin of a variation
+   Type GetBinContent( Int_t var, Int_t bin ) const;
+   /// Get the error of a specific bin of a variation
+   Type GetBinError( Int_t var, Int_t bin ) const;
+
+   /// Get the total number of entries in the bank
+   Int_t GetEntries() const;
+
+   /// Function creating a TH1 histogram for one of the variations
+   TH1* ToHist( Int_t var ) const;
+
+   /// Merge a collection of SHistBank objects
+   virtual Int_t Merge( TCollection* coll );
+   /// Write the bank as TH1 objects (const version)
+   virtual Int_t Write( const char* name = 0, Int_t option = 0,
+                        Int_t bufsize = 0 ) const;
+   /// Write the bank as TH1 objects (non-const version)
+   virtual Int_t Write( const char* name = 0, Int_t option = 0,
+                        Int_t bufsize = 0 );
+
+private:
+   /// Function checking the validity of a variation index
+   void CheckVariation( Int_t var ) const;
+   /// Function accessing/creating the directory of a variation
+   TDirectory* MakeDirectory( TDirectory* parent,
+                              const std::string& name ) const;
+
+   /// Names of the variations
+   std::vector< std::string > m_variations;
+   /// Number of variations in the bank
+   const Int_t m_nVar;
+   /// Size of the internal arrays (needed for dictionary generation)
+   const Int_t m_arraySize;
+   /// Array holding the bin contents ( [bin * m_nVar + var] )
+   Type* m_content; //[m_arraySize]
+   /// Array holding the square of the bin errors ( [bin * m_nVar + var] )
+   Type* m_errors; //[m_arraySize]
+   /// Number of entries in the bank
+   Int_t m_entries;
+   /// Number of bins of the histograms
+   const Int_t    m_bins;
+   /// The low end of the histogram axis
+   const Double_t m_low;
+   /// The high end of the histogram axis
+   const Double_t m_high;
+   /// Whether statistical errors should be calculated
+   const Bool_t m_computeErrors;
+
+#ifndef DOXYGEN_IGNORE
+   ClassDef( SHistBank, 1 )
+#endif // DOXYGEN_IGNORE
+
+}; // class SHistBank
+
+//
+// Include the template implementation:
+//
+#ifndef __CINT__
+#include "SHistBank.icc"
+#endif // __CINT__
+
+//
+// Define the supported template specialisations:
+//
+typedef SHistBank< Float_t >  SHistBankF;
+typedef SHistBank< Double_t > SHistBankD;
+
+#ifndef DOXYGEN_IGNORE
+ClassImp( SHistBankF )
+ClassImp( SHistBankD )
+#endif // DOXYGEN_IGNORE
+
+#endif // SFRAME_PLUGINS_SHistBank_H
@@ -0,0 +1,109 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Plug-ins
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_PLUGINS_SKinematics_H
+#define SFRAME_PLUGINS_SKinematics_H
+
+// System include(s):
+#include <cstddef>
+
+// STL include(s):
+#include <vector>
+
+// ROOT include(s):
+#include <Rtypes.h>
+
+// Forward declaration(s):
+class SParticleCollection;
+
+/**
+ *   @short Kinematic calculations over whole particle collections
+ *
+ *          Calculating angular distances, invariant masses, etc. one particle
+ *          pair at a time through the GenVector interface of SParticle is
+ *          quite slow. The functions in this namespace do the same
+ *          calculations over the contiguous arrays of SParticleCollection,
+ *          or over plain arrays of coordinates.
+ *
+ *          The speed-up comes from reading the coordinates from contiguous
+ *          arrays, and from avoiding the temporary LorentzVector objects.
+ *          The loops of the coordinate conversion functions are also
+ *          vectorised by the compiler. They don't call libm and don't
+ *          branch, but use inlined polynomial approximations that agree
+ *          with the libm results within a few ULPs. Results that would
+ *          overflow (|&eta;| > 708) are not infinite, but saturate. The gain
+ *          can be measured with the sframe_bench_kinematics program
+ *          (<code>make bench</code> in the plug-ins directory).
+ *
+ *          Most calculations need the cartesian coordinates of the particles.
+ *          Those are calculated once per collection in ToCartesian(...), and
+ *          not once per particle pair.
+ *
+ * @version $Revision$
+ */
+namespace SKinematics {
+
+   /// Convert (p<sub>T</sub>, &eta;, &phi;) coordinates to cartesian ones
+   void ToCartesian( size_t n, const Double_t* pt, const Double_t* eta,
+                     const Double_t* phi, Double_t* px, Double_t* py,
+                     Double_t* pz );
+   /// Convert cartesian coordinates to (p<sub>T</sub>, &eta;, &phi;) ones
+   void ToPtEtaPhi( size_t n, const Double_t* px, const Double_t* py,
+                    const Double_t* pz, Double_t* pt, Double_t* eta,
+                    Double_t* phi );
+   /// Calculate the transverse energies of the particles
+   void ToEt( size_t n, const Double_t* eta, const Double_t* e,
+              Double_t* et );
+
+   /// Calculate the difference of two azimuthal angles in [-&pi;, &pi;]
+   Double_t DeltaPhi( Double_t phi1, Double_t phi2 );
+   /// Calculate the angular distance of two particles
+   Double_t DeltaR( Double_t eta1, Double_t phi1,
+                    Double_t eta2, Double_t phi2 );
+
+   /// Calculate the &Delta;R distances between all particles of two collections
+   void DeltaRMatrix( const SParticleCollection& coll1,
+                      const SParticleCollection& coll2,
+                      std::vector< Double_t >& result );
+
+   /// Flag the particles that overlap with a reference collection
+   size_t FindOverlaps( const SParticleCollection& coll,
+                        const SParticleCollection& ref, Double_t dR,
+                        std::vector< Bool_t >& overlaps );
+   /// Remove the particles that overlap with a reference collection
+   size_t RemoveOverlaps( SParticleCollection& coll,
+                          const SParticleCollection& ref, Double_t dR );
+
+   /// Calculate the invariant mass of two particles of a collection
+   Double_t PairMass( const SParticleCollection& coll, size_t i, size_t j );
+   /// Find the particle pair with an invariant mass closest to a target value
+   Double_t BestPairMass( const SParticleCollection& coll, Double_t target,
+                          size_t* i = 0, size_t* j = 0 );
+
+   /// Get the indices of the particles in decreasing p<sub>T</sub> order
+   void PtOrder( const SParticleCollection& coll,
+                 std::vector< size_t >& order );
+   /// Get the indices of the particles in increasing |&eta;| order
+   void AbsEtaOrder( const SParticleCollection& coll,
+                     std::vector< size_t >& order );
+   /// Re-order the particles of a collection
+   void Reorder( SParticleCollection& coll,
+                 const std::vector< size_t >& order );
+   /// Sort the particles of a collection in decreasing p<sub>T</sub> order
+   void SortByPt( SParticleCollection& coll );
+   /// Sort the particles of a collection in increasing |&eta;| order
+   void SortByAbsEta( SParticleCollection& coll );
+
+} // namespace SKinematics
+
+#endif // SFRAME_PLUGINS_SKinematics_H
@@ -0,0 +1,194 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Plug-ins
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_PLUGINS_SParticleCollection_H
+#define SFRAME_PLUGINS_SParticleCollection_H
+
+// STL include(s):
+#include <vector>
+
+// ROOT include(s):
+#include <Rtypes.h>
+
+// Local include(s):
+#include "SParticle.h"
+
+/**
+ *   @short Proxy giving access to one particle of an SParticleCollection
+ *
+ *          The objects of this class behave much like SParticle objects, but
+ *          they don't hold any data themselves. They just forward the calls
+ *          to the arrays of the collection that they point into.
+ *
+ *          The template parameter is either SParticleCollection, or
+ *          const SParticleCollection. The setter functions can only be
+ *          used in the first case.
+ *
+ * @version $Revision$
+ */
+template< class CollType >
+class SParticleProxy {
+
+public:
+   /// Constructor with the collection and the index of the particle
+   SParticleProxy( CollType& coll, size_t index );
+
+   /// Transverse momentum of the particle
+   Double_t Pt() const;
+   /// Pseudo-rapidity of the particle
+   Double_t Eta() const;
+   /// Azimuthal angle of the particle
+   Double_t Phi() const;
+   /// Energy of the particle
+   Double_t E() const;
+
+   /// X component of the momentum of the particle
+   Double_t Px() const;
+   /// Y component of the momentum of the particle
+   Double_t Py() const;
+   /// Z component of the momentum of the particle
+   Double_t Pz() const;
+   /// Magnitude of the momentum of the particle
+   Double_t P() const;
+   /// Invariant mass of the particle
+   Double_t M() const;
+   /// Transverse energy of the particle
+   Double_t Et() const;
+
+   /// Set the transverse momentum of the particle
+   void SetPt( Double_t pt );
+   /// Set the pseudo-rapidity of the particle
+   void SetEta( Double_t eta );
+   /// Set the azimuthal angle of the particle
+   void SetPhi( Double_t phi );
+   /// Set the energy of the particle
+   void SetE( Double_t e );
+
+   /// Create a standalone SParticle object from the proxy
+   SParticle ToParticle() const;
+
+   /// Get the index of the particle in the collection
+   size_t GetIndex() const;
+
+private:
+   CollType* m_coll; ///< The collection that the proxy points into
+   size_t m_index; ///< Index of the particle in the collection
+
+}; // class SParticleProxy
+
+/**
+ *   @short Structure-of-arrays collection of particles
+ *
+ *          std::vector< SParticle > is a convenient way of storing particles
+ *          in the output ntuple, but it's neither very fast, nor very
+ *          compact. Each element is streamed as a separate object, which also
+ *          carries the TObject data members.
+ *
+ *          This class stores the four-momentum components of the particles
+ *          in separate, contiguous arrays instead. When given to
+ *          SCycleBaseNTuple::DeclareVariable(...), ROOT splits the object
+ *          into one flat branch per component (NAME.m_pt, NAME.m_eta, ...),
+ *          and it can be read back with SCycleBaseNTuple::ConnectVariable(...)
+ *          using an SParticleCollection pointer. The individual branches can
+ *          also be used directly in TTree::Draw(...).
+ *
+ *          The particles can be accessed through proxy objects that provide
+ *          the same accessor functions as SParticle:
+ *
+ *          <code>
+ *            for( size_t i = 0; i < m_El->size(); ++i ) {
+ *               hist->Fill( ( *m_El )[ i ].Pt() );
+ *            }
+ *          </code>
+ *
+ *          Code that needs to be fast should access the arrays directly
+ *          through the GetPt(), GetEta(), etc. functions instead.
+ *
+ * @version $Revision$
+ */
+class SParticleCollection {
+
+public:
+   /// Type of the proxy object pointing to a particle
+   typedef SParticleProxy< SParticleCollection > Proxy;
+   /// Type of the constant proxy object pointing to a particle
+   typedef SParticleProxy< const SParticleCollection > ConstProxy;
+
+   /// Default constructor
+   SParticleCollection();
+
+   /// Get the number of particles in the collection
+   size_t size() const;
+   /// Check whether the collection is empty
+   bool empty() const;
+   /// Remove all particles from the collection
+   void clear();
+   /// Reserve memory for a given number of particles
+   void reserve( size_t n );
+
+   /// Add a new particle to the collection
+   void push_back( Double_t pt, Double_t eta, Double_t phi, Double_t e );
+   /// Add a new particle to the collection
+   void push_back( const SParticle& p );
+
+   /// Access a particle of the collection
+   Proxy operator[]( size_t i );
+   /// Access a particle of the constant collection
+   ConstProxy operator[]( size_t i ) const;
+
+   /// Get the transverse momentum of a particle
+   Double_t Pt( size_t i ) const { return m_pt[ i ]; }
+   /// Get the pseudo-rapidity of a particle
+   Double_t Eta( size_t i ) const { return m_eta[ i ]; }
+   /// Get the azimuthal angle of a particle
+   Double_t Phi( size_t i ) const { return m_phi[ i ]; }
+   /// Get the energy of a particle
+   Double_t E( size_t i ) const { return m_e[ i ]; }
+
+   /// Set the transverse momentum of a particle
+   void SetPt( size_t i, Double_t pt ) { m_pt[ i ] = pt; }
+   /// Set the pseudo-rapidity of a particle
+   void SetEta( size_t i, Double_t eta ) { m_eta[ i ] = eta; }
+   /// Set the azimuthal angle of a particle
+   void SetPhi( size_t i, Double_t phi ) { m_phi[ i ] = phi; }
+   /// Set the energy of a particle
+   void SetE( size_t i, Double_t e ) { m_e[ i ] = e; }
+
+   /// Get the array of transverse momenta
+   const std::vector< Double32_t >& GetPt() const;
+   /// Get the array of pseudo-rapidities
+   const std::vector< Double32_t >& GetEta() const;
+   /// Get the array of azimuthal angles
+   const std::vector< Double32_t >& GetPhi() const;
+   /// Get the array of energies
+   const std::vector< Double32_t >& GetE() const;
+
+   /// Create a standalone SParticle object from one of the particles
+   SParticle GetParticle( size_t i ) const;
+
+private:
+   std::vector< Double32_t > m_pt; ///< Transverse momenta
+   std::vector< Double32_t > m_eta; ///< Pseudo-rapidities
+   std::vector< Double32_t > m_phi; ///< Azimuthal angles
+   std::vector< Double32_t > m_e; ///< Energies
+
+}; // class SParticleCollection
+
+//
+// Include template implementation:
+//
+#ifndef __CINT__
+#include "SParticleCollection.icc"
+#endif // __CINT__
+
+#endif // SFRAME_PLUGINS_SParticleCollection_H
@@ -0,0 +1,161 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Plug-ins
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_PLUGINS_SSummedArray_H
+#define SFRAME_PLUGINS_SSummedArray_H
+
+// STL include(s):
+#include <vector>
+#include <string>
+
+// ROOT include(s):
+#include <TNamed.h>
+#include <TString.h>
+
+// SFrame include(s):
+#include "core/include/SError.h"
+
+// Forward declaration(s):
+class TCollection;
+class ISCycleBaseHist;
+
+/**
+ *   @short Class used in the SSummedArray implementation
+ *
+ *          This is the object that is actually put into the output list of
+ *          the cycle, and merged by PROOF. It stores its elements in a single
+ *          array that is streamed as a basic type array, so it's much more
+ *          compact than a ProofSummedVar holding an STL container. The
+ *          elements may optionally be labeled. Labeled arrays are merged
+ *          based on their labels, unlabeled ones element-by-element.
+ *
+ *          Users should not need to use this class directly.
+ *
+ * @version $Revision$
+ */
+template< class Type >
+class ProofSummedArray : public TNamed {
+
+public:
+   /// Default constructor
+   ProofSummedArray( const char* name = 0, const char* title = 0 );
+   /// Destructor
+   ~ProofSummedArray();
+
+   /// Change the size of the array, keeping its existing contents
+   void Resize( Int_t size );
+   /// Get the size of the array
+   Int_t GetSize() const;
+
+   /// Get a pointer to the first element of the array
+   Type* GetArray();
+   /// Get a constant pointer to the first element of the array
+   const Type* GetArray() const;
+
+   /// Add a new labeled element to the end of the array
+   Int_t AddLabel( const std::string& label );
+   /// Find the index of a labeled element
+   Int_t FindLabel( const std::string& label ) const;
+   /// Get all the labels of the array
+   const std::vector< std::string >& GetLabels() const;
+
+   /// Function merging the results from the worker nodes
+   virtual Int_t Merge( TCollection* coll );
+
+private:
+   /// Size of the array
+   Int_t m_size;
+   /// The array holding the summed values
+   Type* m_array; //[m_size]
+   /// Labels of the array elements (optional)
+   std::vector< std::string > m_labels;
+
+#ifndef DOXYGEN_IGNORE
+   ClassDef( ProofSummedArray, 1 )
+#endif // DOXYGEN_IGNORE
+
+}; // class ProofSummedArray
+
+/**
+ *   @short Fixed size array of counters to be used on PROOF
+ *
+ *          This class is meant to replace SSummedVar< std::vector< T > > for
+ *          the cases when the user wants to count a number of things at the
+ *          same time. The array is allocated in a single block of memory,
+ *          which is merged element-by-element when collecting the results
+ *          from the worker nodes.
+ *
+ *          Just like SSummedVar, the object is declared as a member of the
+ *          cycle, and has to be hidden from the dictionary generation:
+ *
+ *          <code>
+ *            SSummedArray< Int_t > m_counters; //!
+ *            ...
+ *            m_counters( "counters", 10, this )
+ *            ...
+ *            ++m_counters[ 3 ];
+ *          </code>
+ *
+ *          The output list of the cycle is only searched for the underlying
+ *          object once per InputData. After that each access just uses a
+ *          cached pointer.
+ *
+ * @version $Revision$
+ */
+template< class Type >
+class SSummedArray {
+
+public:
+   /// Declaration of the used type
+   typedef Type ValueType;
+
+   /// Constructor
+   SSummedArray( const char* name, Int_t size, ISCycleBaseHist* parent );
+
+   /// Operator accessing one element of the array
+   Type& operator[]( Int_t index );
+   /// Constant operator accessing one element of the array
+   const Type& operator[]( Int_t index ) const;
+
+   /// Get the size of the array
+   Int_t GetSize() const;
+
+   /// Get a pointer to the first element of the array
+   Type* GetArray();
+   /// Get a constant pointer to the first element of the array
+   const Type* GetArray() const;
+
+protected:
+   /// Function for accessing the internal object
+   ProofSummedArray< Type >* GetObject() const;
+
+   TString          m_objName; ///< Name of the object
+   ISCycleBaseHist* m_parent; ///< Pointer to the parent cycle
+   Int_t            m_size; ///< Size of the array
+   /// Labels to initialise the new internal objects with
+   std::vector< std::string > m_labels;
+
+private:
+   mutable ProofSummedArray< Type >* m_object; ///< Cached pointer
+   mutable ULong_t m_generation; ///< Output list generation of cached pointer
+
+}; // class SSummedArray
+
+//
+// Include template implementation:
+//
+#ifndef __CINT__
+#include "SSummedArray.icc"
+#endif // __CINT__
+
+#endif // SFRAME_PLUGINS_SSummedArray_H
@@ -0,0 +1,79 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Plug-ins
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_PLUGINS_SSummedCounters_H
+#define SFRAME_PLUGINS_SSummedCounters_H
+
+// STL include(s):
+#include <vector>
+#include <string>
+
+// Local include(s):
+#include "SSummedArray.h"
+
+/**
+ *   @short Named counters to be used on PROOF
+ *
+ *          This class can be used for keeping track of a set of named
+ *          counters, for instance for creating a cutflow. The counters are
+ *          registered by name, in which case the user receives an index
+ *          that can be used in the event loop to access the counter without
+ *          any lookup:
+ *
+ *          <code>
+ *            SSummedCounters< Int_t > m_cutflow; //!
+ *            Int_t m_allIndex; //!
+ *            ...
+ *            m_cutflow( "cutflow", this )
+ *            ...
+ *            In BeginInputData:
+ *              m_allIndex = m_cutflow.Register( "all" );
+ *            In ExecuteEvent:
+ *              ++m_cutflow[ m_allIndex ];
+ *          </code>
+ *
+ *          The counters are merged based on their names, so different
+ *          worker nodes can register them in a different order as well.
+ *
+ * @version $Revision$
+ */
+template< class Type >
+class SSummedCounters : public SSummedArray< Type > {
+
+public:
+   /// Constructor
+   SSummedCounters( const char* name, ISCycleBaseHist* parent );
+
+   /// Register a new counter, and get its index
+   Int_t Register( const std::string& key );
+
+   /// Operators accessing the counters by index
+   using SSummedArray< Type >::operator[];
+   /// Operator accessing a counter by name (slow)
+   Type& operator[]( const std::string& key );
+   /// Constant operator accessing a counter by name (slow)
+   const Type& operator[]( const std::string& key ) const;
+
+   /// Get the names of all the counters
+   const std::vector< std::string >& GetKeys() const;
+
+}; // class SSummedCounters
+
+//
+// Include template implementation:
+//
+#ifndef __CINT__
+#include "SSummedCounters.icc"
+#endif // __CINT__
+
+#endif // SFRAME_PLUGINS_SSummedCounters_H
@@ -0,0 +1,73 @@
+// Dear emacs, this is -*- c++ -*-
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Plug-ins
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+#ifndef SFRAME_PLUGINS_SSummedHist_H
+#define SFRAME_PLUGINS_SSummedHist_H
+
+// Local include(s):
+#include "SSummedArray.h"
+
+// Forward declaration(s):
+class TH1;
+
+/**
+ *   @short Histogram of counts to be used on PROOF
+ *
+ *          A very simple histogram with evenly sized bins, which keeps only
+ *          the summed bin contents. (No uncertainties, no statistics.) It's
+ *          meant for things like multiplicity distributions that the cycle
+ *          wants to look at in <code>EndMasterInputData(...)</code>. The bin
+ *          numbering follows the ROOT convention, with bin 0 being the
+ *          underflow, and bin GetNBins()+1 being the overflow bin.
+ *
+ *          If the histogram should end up in the output file, it can be
+ *          converted into a TH1 using the ToHist() function.
+ *
+ * @version $Revision$
+ */
+template< class Type >
+class SSummedHist : public SSummedArray< Type > {
+
+public:
+   /// Constructor
+   SSummedHist( const char* name, Int_t bins, Double_t low, Double_t high,
+                ISCycleBaseHist* parent );
+
+   /// Increase the contents of the bin at a specific position
+   void Fill( Double_t pos, Type weight = 1 );
+
+   /// Get the number of bins
+   Int_t GetNBins() const;
+   /// Find the bin belonging to a specific position on the axis
+   Int_t FindBin( Double_t pos ) const;
+   /// Get the content of a specific bin
+   Type GetBinContent( Int_t bin ) const;
+
+   /// Function creating a TH1 histogram with the contents of the object
+   TH1* ToHist() const;
+
+private:
+   Int_t    m_bins; ///< Number of bins of the histogram
+   Double_t m_low; ///< The low end of the histogram axis
+   Double_t m_high; ///< The high end of the histogram axis
+
+}; // class SSummedHist
+
+//
+// Include template implementation:
+//
+#ifndef __CINT__
+#include "SSummedHist.icc"
+#endif // __CINT__
+
+#endif // SFRAME_PLUGINS_SSummedHist_H
@@ -117,6 +117,7 @@ private:
    TString                         m_objName; ///< Name of the object
    ISCycleBaseHist*                m_parent; ///< Pointer to the parent cycle
    mutable ProofSummedVar< Type >* m_object; ///< Cached pointer
+   mutable ULong_t m_generation; ///< Output list generation of cached pointer
 
 }; // class SSummedVar
 
@@ -0,0 +1,568 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Plug-ins
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+// System include(s):
+#include <time.h>
+#include <cstring>
+#include <ctime>
+
+// ROOT include(s):
+#include <TCollection.h>
+#include <TDirectory.h>
+#include <TH1.h>
+#include <TAxis.h>
+#include <TMath.h>
+#include <TObjString.h>
+
+// SFrame include(s):
+#include "core/include/SError.h"
+#include "core/include/SLogger.h"
+
+// Local include(s):
+#include "../include/SCutFlow.h"
+
+#ifndef DOXYGEN_IGNORE
+ClassImp( SCutFlow )
+#endif // DOXYGEN_IGNORE
+
+namespace {
+
+   /**
+    * Helper function used to extend the arrays of the cutflow object when
+    * a new cut is registered.
+    *
+    * @param array The array to be resized
+    * @param oldSize The current size of the array
+    * @param newSize The requested size of the array
+    */
+   void ResizeArray( Double_t*& array, Int_t oldSize, Int_t newSize ) {
+
+      Double_t* result = new Double_t[ newSize ];
+      memset( result, 0, newSize * sizeof( Double_t ) );
+      if( array ) {
+         memcpy( result, array,
+                 ( oldSize < newSize ? oldSize : newSize ) *
+                 sizeof( Double_t ) );
+         delete[] array;
+      }
+      array = result;
+
+      return;
+   }
+
+} // private namespace
+
+/**
+ * The default constructor is needed for the dictionary generation, but this
+ * is also the constructor that users should use when booking the object.
+ *
+ * @param name The name of the cutflow object
+ * @param title The title of the cutflow object
+ * @param timing Flag for turning on the CPU time measurement
+ */
+SCutFlow::SCutFlow( const char* name, const char* title, Bool_t timing )
+   : TNamed( name, title ), m_cuts(), m_nCuts( 0 ), m_raw( 0 ),
+     m_weighted( 0 ), m_weighted2( 0 ), m_cpuTime( 0 ), m_timing( timing ),
+     m_lastTime( 0.0 ) {
+
+}
+
+/**
+ * The copy constructor creates a deep copy of the parent object.
+ *
+ * @param parent The object to be copied
+ */
+SCutFlow::SCutFlow( const SCutFlow& parent )
+   : TNamed( parent ), m_cuts( parent.m_cuts ), m_nCuts( parent.m_nCuts ),
+     m_raw( 0 ), m_weighted( 0 ), m_weighted2( 0 ), m_cpuTime( 0 ),
+     m_timing( parent.m_timing ), m_lastTime( 0.0 ) {
+
+   if( m_nCuts ) {
+      ResizeArray( m_raw, 0, m_nCuts );
+      ResizeArray( m_weighted, 0, m_nCuts );
+      ResizeArray( m_weighted2, 0, m_nCuts );
+      ResizeArray( m_cpuTime, 0, m_nCuts );
+      Add( parent );
+   }
+}
+
+/**
+ * The destructor has to delete all the internal buffers that were created on
+ * the heap.
+ */
+SCutFlow::~SCutFlow() {
+
+   delete[] m_raw;
+   delete[] m_weighted;
+   delete[] m_weighted2;
+   delete[] m_cpuTime;
+}
+
+/**
+ * This function should be called in <code>BeginInputData(...)</code> for all
+ * the cuts, in the order in which they are applied. Registering the same cut
+ * multiple times is not a problem, the function just returns the index of
+ * the already existing cut in that case.
+ *
+ * @param cut The name of the cut
+ * @returns The index of the cut, to be used in the event loop
+ */
+Int_t SCutFlow::Register( const std::string& cut ) {
+
+   // Check if the cut is known already:
+   const Int_t index = FindCut( cut );
+   if( index >= 0 ) return index;
+
+   // Extend the arrays:
+   ResizeArray( m_raw, m_nCuts, m_nCuts + 1 );
+   ResizeArray( m_weighted, m_nCuts, m_nCuts + 1 );
+   ResizeArray( m_weighted2, m_nCuts, m_nCuts + 1 );
+   ResizeArray( m_cpuTime, m_nCuts, m_nCuts + 1 );
+   m_cuts.push_back( cut );
+
+   return m_nCuts++;
+}
+
+/**
+ * @param cut The name of the cut
+ * @returns The index of the cut, or -1 if it's not registered
+ */
+Int_t SCutFlow::FindCut( const std::string& cut ) const {
+
+   for( Int_t i = 0; i < m_nCuts; ++i ) {
+      if( m_cuts[ i ] == cut ) return i;
+   }
+
+   return -1;
+}
+
+/**
+ * @returns The number of registered cuts
+ */
+Int_t SCutFlow::GetNCuts() const {
+
+   return m_nCuts;
+}
+
+/**
+ * @param cut The index of the cut
+ * @returns The name of the cut
+ */
+const std::string& SCutFlow::GetCutName( Int_t cut ) const {
+
+   CheckCut( cut );
+   return m_cuts[ cut ];
+}
+
+/**
+ * This function only needs to be called when the CPU time measurement is
+ * turned on. It marks the beginning of the event selection, so that the time
+ * spent until the first cut can be attributed to the first cut.
+ */
+void SCutFlow::BeginEvent() {
+
+   if( m_timing ) m_lastTime = CpuTime();
+   return;
+}
+
+/**
+ * This is the main function of the class. It records whether an event passed
+ * a given cut. It returns the result of the cut, so it can be used directly
+ * in an if statement.
+ *
+ * @warning It's not checked if the specified cut index is in the correct
+ *          range!
+ *
+ * @param cut The index of the cut
+ * @param passed The result of the cut
+ * @param weight The weight of the event
+ * @returns The result of the cut
+ */
+Bool_t SCutFlow::Apply( Int_t cut, Bool_t passed, Double_t weight ) {
+
+   // Attribute the time spent since the last checkpoint to this cut:
+   if( m_timing ) {
+      const Double_t now = CpuTime();
+      m_cpuTime[ cut ] += now - m_lastTime;
+      m_lastTime = now;
+   }
+
+   // Count the event if it passed the cut:
+   if( passed ) {
+      m_raw[ cut ] += 1.0;
+      m_weighted[ cut ] += weight;
+      m_weighted2[ cut ] += weight * weight;
+   }
+
+   return passed;
+}
+
+/**
+ * Shorthand for Apply( cut, kTRUE, weight ).
+ *
+ * @param cut The index of the cut
+ * @param weight The weight of the event
+ */
+void SCutFlow::Pass( Int_t cut, Double_t weight ) {
+
+   Apply( cut, kTRUE, weight );
+   return;
+}
+
+/**
+ * @param cut The index of the cut
+ * @returns The raw number of events passing the cut
+ */
+Long64_t SCutFlow::GetRawCount( Int_t cut ) const {
+
+   CheckCut( cut );
+   return static_cast< Long64_t >( m_raw[ cut ] );
+}
+
+/**
+ * @param cut The index of the cut
+ * @returns The weighted number of events passing the cut
+ */
+Double_t SCutFlow::GetWeightedCount( Int_t cut ) const {
+
+   CheckCut( cut );
+   return m_weighted[ cut ];
+}
+
+/**
+ * @param cut The index of the cut
+ * @returns The statistical uncertainty of the weighted number of events
+ *          passing the cut
+ */
+Double_t SCutFlow::GetWeightedError( Int_t cut ) const {
+
+   CheckCut( cut );
+   return TMath::Sqrt( m_weighted2[ cut ] );
+}
+
+/**
+ * @param cut The index of the cut
+ * @returns The CPU time (in seconds) spent on evaluating the cut
+ */
+Double_t SCutFlow::GetCpuTime( Int_t cut ) const {
+
+   CheckCut( cut );
+   return m_cpuTime[ cut ];
+}
+
+/**
+ * @returns <code>kTRUE</code> if the CPU time measurement is turned on,
+ *          <code>kFALSE</code> otherwise
+ */
+Bool_t SCutFlow::GetTiming() const {
+
+   return m_timing;
+}
+
+/**
+ * @param timing Flag for turning on the CPU time measurement
+ */
+void SCutFlow::SetTiming( Bool_t timing ) {
+
+   m_timing = timing;
+   return;
+}
+
+/**
+ * The table shows for each cut the raw and weighted number of events passing
+ * it, the efficiency of the cut with respect to the previous one, the
+ * cumulative efficiency with respect to the first cut, and (if the timing
+ * was turned on) the CPU time spent on the cut.
+ *
+ * @returns The cutflow formatted into a table
+ */
+TString SCutFlow::GetTable() const {
+
+   // Calculate the total CPU time spent on the cuts:
+   Double_t totalTime = 0.0;
+   for( Int_t i = 0; i < m_nCuts; ++i ) {
+      totalTime += m_cpuTime[ i ];
+   }
+
+   // Print the header of the table:
+   TString result;
+   result += TString::Format( "%-25s %12s %14s %12s %9s %9s", "Cut",
+                              "Raw", "Weighted", "Error", "Eff.[%]",
+                              "Cum.[%]" );
+   if( m_timing ) {
+      result += TString::Format( " %11s %7s", "CPU [s]", "CPU [%]" );
+   }
+   result += "\n";
+
+   // Print the cuts:
+   for( Int_t i = 0; i < m_nCuts; ++i ) {
+      const Double_t eff =
+         ( ( i && m_weighted[ i - 1 ] ) ?
+           100.0 * m_weighted[ i ] / m_weighted[ i - 1 ] : 100.0 );
+      const Double_t cumEff =
+         ( m_weighted[ 0 ] ? 100.0 * m_weighted[ i ] / m_weighted[ 0 ] :
+           100.0 );
+      result += TString::Format( "%-25s %12.0f %14.4g %12.4g %9.3f %9.3f",
+                                 m_cuts[ i ].c_str(), m_raw[ i ],
+                                 m_weighted[ i ],
+                                 TMath::Sqrt( m_weighted2[ i ] ), eff,
+                                 cumEff );
+      if( m_timing ) {
+         result += TString::Format( " %11.4g %7.2f", m_cpuTime[ i ],
+                                    ( totalTime ?
+                                      100.0 * m_cpuTime[ i ] / totalTime :
+                                      0.0 ) );
+      }
+      result += "\n";
+   }
+
+   return result;
+}
+
+/**
+ * The cutflow table is printed using the SFrame logging system.
+ */
+void SCutFlow::Print( Option_t* ) const {
+
+   SLogger m_logger( this );
+   m_logger << INFO << "Cutflow \"" << GetName() << "\":\n" << GetTable()
+            << SLogger::endmsg;
+
+   return;
+}
+
+/**
+ * This function takes care of merging the cutflow objects created on the
+ * PROOF worker nodes. When the cuts were registered in the same order on all
+ * the nodes (the usual case), the merging is done using simple loops over the
+ * arrays. Otherwise the cuts are matched by name.
+ *
+ * @param coll A collection of objects to merge into this one
+ * @returns A positive number if successful, 0 if unsuccessful with the merging
+ */
+Int_t SCutFlow::Merge( TCollection* coll ) {
+
+   // The name of the variable is like this on purpose:
+   SLogger m_logger( this );
+
+   //
+   // Return right away if the input is flawed:
+   //
+   if( ! coll ) return 0;
+   if( coll->IsEmpty() ) return 0;
+
+   //
+   // Merge all the compatible objects from the collection:
+   //
+   TIter next( coll );
+   TObject* obj = 0;
+   while( ( obj = next() ) ) {
+
+      const SCutFlow* cutflow = dynamic_cast< const SCutFlow* >( obj );
+      if( ! cutflow ) {
+         REPORT_ERROR( "Trying to merge \"" << obj->ClassName()
+                       << "\" object into \"" << this->ClassName() << "\"" );
+         continue;
+      }
+
+      Add( *cutflow );
+   }
+
+   return 1;
+}
+
+/**
+ * The default TObject::Write(...) function is overwritten here in order to
+ * write the cutflow into the output file in a format that doesn't need the
+ * SFrame libraries to be read back. If the objects written by a previous
+ * InputData are found in the current directory, the contents of this
+ * object are added to them.
+ *
+ * @param name The prefix of the names of the written objects
+ * @param option Option deciding how to handle multiple objects with the same
+ *               name
+ * @param bufsize Size of the buffer used in writing to the file
+ * @returns The number of bytes written, or 0 if there was an error
+ */
+Int_t SCutFlow::Write( const char* name, Int_t option, Int_t bufsize ) const {
+
+   // The names of the written objects:
+   const TString prefix = ( name ? name : GetName() );
+   const TString rawName = prefix + "_raw";
+   const TString weightedName = prefix + "_weighted";
+   const TString cpuName = prefix + "_cpu";
+   const TString tableName = prefix + "_table";
+
+   //
+   // Add the contents of the objects that may already be in the output:
+   //
+   SCutFlow cutflow( *this );
+   TH1* origRaw = dynamic_cast< TH1* >( gDirectory->Get( rawName ) );
+   TH1* origWeighted = dynamic_cast< TH1* >( gDirectory->Get( weightedName ) );
+   TH1* origCpu = dynamic_cast< TH1* >( gDirectory->Get( cpuName ) );
+   if( origRaw && origWeighted ) {
+      cutflow.Add( origRaw, origWeighted, origCpu );
+      option = TObject::kOverwrite;
+   }
+   if( origRaw ) delete origRaw;
+   if( origWeighted ) delete origWeighted;
+   if( origCpu ) delete origCpu;
+
+   //
+   // Write out the histograms:
+   //
+   Int_t result = 0;
+   TH1* hist = cutflow.MakeHist( rawName, cutflow.m_raw, 0 );
+   result += hist->Write( 0, option, bufsize );
+   delete hist;
+   hist = cutflow.MakeHist( weightedName, cutflow.m_weighted,
+                            cutflow.m_weighted2 );
+   result += hist->Write( 0, option, bufsize );
+   delete hist;
+   if( cutflow.m_timing ) {
+      hist = cutflow.MakeHist( cpuName, cutflow.m_cpuTime, 0 );
+      result += hist->Write( 0, option, bufsize );
+      delete hist;
+   }
+
+   //
+   // Write out the table:
+   //
+   TObjString table( cutflow.GetTable() );
+   result += table.Write( tableName, option, bufsize );
+
+   return result;
+}
+
+/**
+ * Override for the non-const version of the TObject::Write(...) function.
+ *
+ * @see The constant version of this function
+ */
+Int_t SCutFlow::Write( const char* name, Int_t option, Int_t bufsize ) {
+
+   // Let the constant version of the function do the heavy lifting:
+   return const_cast< const SCutFlow* >( this )->Write( name, option,
+                                                        bufsize );
+}
+
+/**
+ * @param other The cutflow whose contents should be added to this one
+ */
+void SCutFlow::Add( const SCutFlow& other ) {
+
+   //
+   // The simple case, when the cuts are in the same order:
+   //
+   if( m_cuts == other.m_cuts ) {
+      for( Int_t i = 0; i < m_nCuts; ++i ) {
+         m_raw[ i ] += other.m_raw[ i ];
+         m_weighted[ i ] += other.m_weighted[ i ];
+         m_weighted2[ i ] += other.m_weighted2[ i ];
+         m_cpuTime[ i ] += other.m_cpuTime[ i ];
+      }
+      return;
+   }
+
+   //
+   // Match the cuts by name:
+   //
+   for( Int_t i = 0; i < other.m_nCuts; ++i ) {
+      const Int_t index = Register( other.m_cuts[ i ] );
+      m_raw[ index ] += other.m_raw[ i ];
+      m_weighted[ index ] += other.m_weighted[ i ];
+      m_weighted2[ index ] += other.m_weighted2[ i ];
+      m_cpuTime[ index ] += other.m_cpuTime[ i ];
+   }
+
+   return;
+}
+
+/**
+ * This function is used when the output file already holds a cutflow with
+ * the same name. (Because multiple InputData blocks with the same type and
+ * version are processed.)
+ *
+ * @param raw Histogram with the raw pass counts
+ * @param weighted Histogram with the weighted pass counts
+ * @param cpu Histogram with the CPU times (can be a null pointer)
+ */
+void SCutFlow::Add( const TH1* raw, const TH1* weighted, const TH1* cpu ) {
+
+   for( Int_t bin = 1; bin <= raw->GetNbinsX(); ++bin ) {
+      const Int_t index =
+         Register( raw->GetXaxis()->GetBinLabel( bin ) );
+      m_raw[ index ] += raw->GetBinContent( bin );
+      m_weighted[ index ] += weighted->GetBinContent( bin );
+      m_weighted2[ index ] += weighted->GetBinError( bin ) *
+         weighted->GetBinError( bin );
+      if( cpu ) m_cpuTime[ index ] += cpu->GetBinContent( bin );
+   }
+
+   return;
+}
+
+/**
+ * @param name The name of the histogram
+ * @param values The bin contents of the histogram
+ * @param errors2 The squares of the bin uncertainties (can be a null pointer)
+ * @returns A histogram that the caller has to delete
+ */
+TH1* SCutFlow::MakeHist( const TString& name, const Double_t* values,
+                         const Double_t* errors2 ) const {
+
+   TH1* hist = new TH1D( name, GetTitle(), ( m_nCuts ? m_nCuts : 1 ), 0.0,
+                         ( m_nCuts ? m_nCuts : 1 ) );
+   hist->SetDirectory( 0 );
+   if( errors2 ) hist->Sumw2();
+   for( Int_t i = 0; i < m_nCuts; ++i ) {
+      hist->GetXaxis()->SetBinLabel( i + 1, m_cuts[ i ].c_str() );
+      hist->SetBinContent( i + 1, values[ i ] );
+      if( errors2 ) hist->SetBinError( i + 1, TMath::Sqrt( errors2[ i ] ) );
+   }
+   hist->SetEntries( m_nCuts ? m_raw[ 0 ] : 0.0 );
+
+   return hist;
+}
+
+/**
+ * @param cut The index of the cut
+ */
+void SCutFlow::CheckCut( Int_t cut ) const {
+
+   if( ( cut < 0 ) || ( cut >= m_nCuts ) ) {
+      SError error( SError::StopExecution );
+      error << "Cut index " << cut << " is out of range for cutflow: "
+            << GetName();
+      throw error;
+   }
+
+   return;
+}
+
+/**
+ * The function uses the CPU time of the current thread if the system
+ * provides it, and the CPU time of the process otherwise.
+ *
+ * @returns The CPU time used so far in seconds
+ */
+Double_t SCutFlow::CpuTime() {
+
+#ifdef CLOCK_THREAD_CPUTIME_ID
+   struct timespec ts;
+   clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts );
+   return ( static_cast< Double_t >( ts.tv_sec ) +
+            1e-9 * static_cast< Double_t >( ts.tv_nsec ) );
+#else
+   return ( static_cast< Double_t >( std::clock() ) / CLOCKS_PER_SEC );
+#endif // CLOCK_THREAD_CPUTIME_ID
+}
@@ -0,0 +1,711 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Plug-ins
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+// System include(s):
+#include <cmath>
+#include <cstring>
+
+// STL include(s):
+#include <algorithm>
+
+// ROOT include(s):
+#include <TMath.h>
+
+// SFrame include(s):
+#include "core/include/SError.h"
+
+// Local include(s):
+#include "../include/SKinematics.h"
+#include "../include/SParticleCollection.h"
+#include "../include/FPCompare.h"
+
+// Tell the compiler that the arrays given to the conversion functions don't
+// overlap, so it doesn't have to check for it before vectorising the loops:
+#if defined( __GNUC__ )
+#   define SKINEMATICS_RESTRICT __restrict__
+#else
+#   define SKINEMATICS_RESTRICT
+#endif // __GNUC__
+
+namespace {
+
+   /// Bring an angle difference into the [-pi, pi] range without branching
+   inline Double_t WrapPhi( Double_t dphi ) {
+
+      return dphi - TMath::TwoPi() *
+         std::floor( ( dphi + TMath::Pi() ) / TMath::TwoPi() );
+   }
+
+   //
+   // The functions below are used in the loops of ToCartesian(...),
+   // ToPtEtaPhi(...) and ToEt(...). The calls to libm in those loops would
+   // prevent the compiler from vectorising them, so the needed functions
+   // are implemented here without function calls and without branches,
+   // using the polynomial approximations of the Cephes library. Their
+   // results agree with the libm ones within a few ULPs. (The compiler flags
+   // needed for the vectorisation are set in the plug-ins Makefile.)
+   //
+   // The rounding to integers relies on adding and subtracting ROUND_MAGIC,
+   // so this file must not be compiled with -ffast-math.
+   //
+
+   /// Adding this to a double rounds it to an integer in the low mantissa bits
+   static const Double_t ROUND_MAGIC = 6755399441055744.0; // 1.5 * 2^52
+
+   /// Reinterpret the bits of a double as an integer
+   inline ULong64_t AsBits( Double_t x ) {
+
+      ULong64_t result;
+      std::memcpy( &result, &x, sizeof( result ) );
+      return result;
+   }
+
+   /// Reinterpret the bits of an integer as a double
+   inline Double_t AsDouble( ULong64_t bits ) {
+
+      Double_t result;
+      std::memcpy( &result, &bits, sizeof( result ) );
+      return result;
+   }
+
+   /// Largest argument for which Exp(...) is calculated, as 2^1022 still fits
+   static const Double_t EXP_LIMIT = 708.0;
+
+   /// Calculate e^x, saturating outside of [-EXP_LIMIT, EXP_LIMIT]
+   inline Double_t Exp( Double_t x ) {
+
+      x = ( x > EXP_LIMIT ? EXP_LIMIT : x );
+      x = ( x < -EXP_LIMIT ? -EXP_LIMIT : x );
+
+      // x = n * ln(2) + r, with |r| <= ln(2) / 2:
+      const Double_t shifted = x * 1.4426950408889634074 + ROUND_MAGIC;
+      const Double_t n = shifted - ROUND_MAGIC;
+      const Double_t r = ( x - n * 6.93145751953125e-1 ) -
+         n * 1.42860682030941723212e-6;
+
+      // e^r from a Pade approximation:
+      const Double_t rr = r * r;
+      const Double_t p = r * ( ( 1.26177193074810590878e-4 * rr +
+                                 3.02994407707441961300e-2 ) * rr +
+                               9.99999999999999999910e-1 );
+      const Double_t q = ( ( 3.00198505138664455042e-6 * rr +
+                             2.52448340349684104192e-3 ) * rr +
+                           2.27265548208155028766e-1 ) * rr +
+         2.00000000000000000009e0;
+      const Double_t er = 1.0 + 2.0 * p / ( q - p );
+
+      // 2^n, built from the integer found in the low bits of "shifted":
+      const ULong64_t exponent = AsBits( shifted ) - AsBits( ROUND_MAGIC );
+      return er * AsDouble( ( exponent + 1023 ) << 52 );
+   }
+
+   /// Calculate sinh(x)
+   inline Double_t SinH( Double_t x ) {
+
+      // Rational approximation for |x| <= 1, where the exponential formula
+      // would lose precision:
+      const Double_t xx = x * x;
+      const Double_t p = ( ( -7.89474443963537015605e-1 * xx -
+                             1.63725857525983828727e2 ) * xx -
+                           1.15614435765005216044e4 ) * xx -
+         3.51754964808151394800e5;
+      const Double_t q = ( ( xx - 2.77711081420602794433e2 ) * xx +
+                           3.61578279834431989373e4 ) * xx -
+         2.11052978884890840399e6;
+      const Double_t small = x + x * xx * p / q;
+
+      const Double_t ex = Exp( x );
+      const Double_t large = 0.5 * ( ex - 1.0 / ex );
+
+      return ( std::fabs( x ) <= 1.0 ? small : large );
+   }
+
+   /// Calculate cosh(x)
+   inline Double_t CosH( Double_t x ) {
+
+      const Double_t ex = Exp( x );
+      return 0.5 * ( ex + 1.0 / ex );
+   }
+
+   /// Calculate the natural logarithm of a (normal, positive) number
+   inline Double_t Log( Double_t x ) {
+
+      // x = m * 2^e, with sqrt(1/2) <= m < sqrt(2):
+      const ULong64_t bits = AsBits( x );
+      Double_t m = AsDouble( ( bits & 0x000fffffffffffffULL ) |
+                             0x3fe0000000000000ULL );
+      // Turn the biased exponent into a double without an int->double
+      // conversion, which many SIMD instruction sets don't have:
+      Double_t e = AsDouble( ( bits >> 52 ) | 0x4330000000000000ULL ) -
+         ( 4503599627370496.0 + 1022.0 );
+      const bool low = ( m < 0.70710678118654752440 );
+      m = ( low ? m + m : m );
+      e = ( low ? e - 1.0 : e );
+
+      // log(m) = 2 * atanh( (m - 1) / (m + 1) ), from a rational
+      // approximation:
+      const Double_t s = 2.0 * ( m - 1.0 ) / ( m + 1.0 );
+      const Double_t ss = s * s;
+      const Double_t p = ( -7.89580278884799154124e-1 * ss +
+                           1.63866645699558079767e1 ) * ss -
+         6.41409952958715622951e1;
+      const Double_t q = ( ( ss - 3.56722798256324312549e1 ) * ss +
+                           3.12093766372244180303e2 ) * ss -
+         7.69691943550460008604e2;
+      const Double_t logm = s + s * ss * p / q;
+
+      return ( logm - e * 2.121944400546905827679e-4 ) + e * 0.693359375;
+   }
+
+   /// Calculate asinh(x)
+   inline Double_t ASinH( Double_t x ) {
+
+      const Double_t ax = std::fabs( x );
+
+      // Rational approximation for |x| < 0.5:
+      const Double_t xx = x * x;
+      const Double_t p = ( ( ( -4.33231683752342103572e-3 * xx -
+                               5.91750212056387121207e-1 ) * xx -
+                             4.37390226194356683570e0 ) * xx -
+                           9.09030533308377316566e0 ) * xx -
+         5.56682227230859640450e0;
+      const Double_t q = ( ( ( xx + 1.28757002067426453537e1 ) * xx +
+                             4.86042483805291788324e1 ) * xx +
+                           6.95722521337257608734e1 ) * xx +
+         3.34009336338516356383e1;
+      const Double_t small = x + x * xx * p / q;
+
+      // log( |x| + sqrt( x^2 + 1 ) ), or log( 2 |x| ) when x^2 would
+      // overflow:
+      const bool huge = ( ax > 1e8 );
+      const Double_t arg = ( huge ? ax : ax + std::sqrt( xx + 1.0 ) );
+      Double_t large = Log( arg ) + ( huge ? 0.69314718055994530942 : 0.0 );
+      large = ( x < 0.0 ? -large : large );
+
+      return ( ax < 0.5 ? small : large );
+   }
+
+   /// Calculate sin(x) and cos(x) together
+   inline void SinCos( Double_t x, Double_t& s, Double_t& c ) {
+
+      // x = n * pi/2 + r, with |r| <= pi/4:
+      const Double_t shifted = x * 0.63661977236758134308 + ROUND_MAGIC;
+      const Double_t n = shifted - ROUND_MAGIC;
+      const ULong64_t quadrant = AsBits( shifted ) - AsBits( ROUND_MAGIC );
+      const Double_t r = ( ( x - n * 1.57079625129699707031e0 ) -
+                           n * 7.54978941586159635336e-8 ) -
+         n * 5.39030285815811905290e-15;
+
+      // sin(r) and cos(r) from polynomial approximations:
+      const Double_t rr = r * r;
+      const Double_t sinr = r + r * rr *
+         ( ( ( ( ( 1.58962301576546568060e-10 * rr -
+                   2.50507477628578072866e-8 ) * rr +
+                 2.75573136213857245213e-6 ) * rr -
+               1.98412698295895385996e-4 ) * rr +
+             8.33333333332211858878e-3 ) * rr -
+           1.66666666666666307295e-1 );
+      const Double_t cosr = 1.0 - 0.5 * rr + rr * rr *
+         ( ( ( ( ( -1.13585365213876817300e-11 * rr +
+                   2.08757008419747316778e-9 ) * rr -
+                 2.75573141792967388112e-7 ) * rr +
+               2.48015872888517045348e-5 ) * rr -
+             1.38888888888730564116e-3 ) * rr +
+           4.16666666666665929218e-2 );
+
+      // Select the right values for the quadrant. This is done with integer
+      // bit masks, as the vectoriser can't turn a condition computed from
+      // an integer into a selection between two doubles.
+      const ULong64_t swap = -( quadrant & 1 );
+      const Double_t sv = AsDouble( ( AsBits( cosr ) & swap ) |
+                                    ( AsBits( sinr ) & ~swap ) );
+      const Double_t cv = AsDouble( ( AsBits( sinr ) & swap ) |
+                                    ( AsBits( cosr ) & ~swap ) );
+      s = AsDouble( AsBits( sv ) ^ ( ( quadrant & 2 ) << 62 ) );
+      c = AsDouble( AsBits( cv ) ^ ( ( ( quadrant + 1 ) & 2 ) << 62 ) );
+
+      return;
+   }
+
+   /// Calculate atan2(y, x)
+   inline Double_t ATan2( Double_t y, Double_t x ) {
+
+      // Reduce the calculation to atan(t), with 0 <= t <= 1:
+      const Double_t ax = std::fabs( x ), ay = std::fabs( y );
+      const bool swap = ( ay > ax );
+      const Double_t num = ( swap ? ax : ay );
+      const Double_t den = ( swap ? ay : ax );
+      const Double_t t = num / ( den > 0.0 ? den : 1.0 );
+
+      // Reduce the argument further around 1, where the polynomial would be
+      // less precise:
+      const bool upper = ( t > 0.66 );
+      const Double_t w = ( upper ? ( t - 1.0 ) / ( t + 1.0 ) : t );
+      const Double_t offset = ( upper ? 7.85398163397448309616e-1 +
+                                3.061616997868382943065e-17 : 0.0 );
+
+      // atan(w) from a rational approximation:
+      const Double_t ww = w * w;
+      const Double_t p = ( ( ( -8.750608600031904122785e-1 * ww -
+                               1.615753718733365076637e1 ) * ww -
+                             7.500855792314704667340e1 ) * ww -
+                           1.228866684490136173410e2 ) * ww -
+         6.485021904942025371773e1;
+      const Double_t q = ( ( ( ( ww + 2.485846490142306297962e1 ) * ww +
+                               1.650270098316988542046e2 ) * ww +
+                             4.328810604912902668951e2 ) * ww +
+                           4.853903996359136964868e2 ) * ww +
+         1.945506571482613964425e2;
+      Double_t result = offset + ( w + w * ww * p / q );
+
+      // Move the result into the right octant. The signs are taken from the
+      // sign bits, so that negative zeros are treated the same way as by
+      // std::atan2:
+      result = ( swap ? TMath::PiOver2() - result : result );
+      const ULong64_t negx = -( AsBits( x ) >> 63 );
+      result = AsDouble( ( AsBits( TMath::Pi() - result ) & negx ) |
+                         ( AsBits( result ) & ~negx ) );
+      return AsDouble( AsBits( result ) |
+                       ( AsBits( y ) & 0x8000000000000000ULL ) );
+   }
+
+   /// Largest pseudo-rapidity value returned, same as in GenVector
+   static const Double_t ETA_MAX = 22756.0;
+
+   /// Calculate the pseudo-rapidity the same way as ROOT::Math::Impl::Eta
+   inline Double_t EtaFromRhoZ( Double_t rho, Double_t z ) {
+
+      // Both cases are evaluated, and the right one is selected at the end:
+      const bool positive = ( rho > 0.0 );
+      const Double_t eta = ASinH( z / ( positive ? rho : 1.0 ) );
+      const Double_t edge = ( z == 0.0 ? 0.0 :
+                              ( z > 0.0 ? z + ETA_MAX : z - ETA_MAX ) );
+      return ( positive ? eta : edge );
+   }
+
+   /// Function object ordering indices by decreasing values
+   class GreaterValue {
+   public:
+      GreaterValue( const std::vector< Double_t >& values )
+         : m_values( values ) {}
+      bool operator()( size_t i, size_t j ) const {
+         return CxxUtils::fpcompare::greater( m_values[ i ], m_values[ j ] );
+      }
+   private:
+      const std::vector< Double_t >& m_values;
+   }; // class GreaterValue
+
+   /// Function object ordering indices by increasing values
+   class LessValue {
+   public:
+      LessValue( const std::vector< Double_t >& values )
+         : m_values( values ) {}
+      bool operator()( size_t i, size_t j ) const {
+         return CxxUtils::fpcompare::less( m_values[ i ], m_values[ j ] );
+      }
+   private:
+      const std::vector< Double_t >& m_values;
+   }; // class LessValue
+
+   /// Fill an index vector with 0, 1, ..., n-1
+   void Iota( std::vector< size_t >& order, size_t n ) {
+
+      order.resize( n );
+      for( size_t i = 0; i < n; ++i ) {
+         order[ i ] = i;
+      }
+
+      return;
+   }
+
+} // private namespace
+
+namespace SKinematics {
+
+   /**
+    * The output arrays have to be allocated by the caller, and have to be
+    * able to hold (at least) <code>n</code> elements. They must not overlap
+    * with the input arrays.
+    *
+    * @param n   The number of particles
+    * @param pt  Input array of transverse momenta
+    * @param eta Input array of pseudo-rapidities
+    * @param phi Input array of azimuthal angles
+    * @param px  Output array of the X components of the momenta
+    * @param py  Output array of the Y components of the momenta
+    * @param pz  Output array of the Z components of the momenta
+    */
+   void ToCartesian( size_t n, const Double_t* SKINEMATICS_RESTRICT pt,
+                     const Double_t* SKINEMATICS_RESTRICT eta,
+                     const Double_t* SKINEMATICS_RESTRICT phi,
+                     Double_t* SKINEMATICS_RESTRICT px,
+                     Double_t* SKINEMATICS_RESTRICT py,
+                     Double_t* SKINEMATICS_RESTRICT pz ) {
+
+      for( size_t i = 0; i < n; ++i ) {
+         Double_t sinphi, cosphi;
+         SinCos( phi[ i ], sinphi, cosphi );
+         px[ i ] = pt[ i ] * cosphi;
+         py[ i ] = pt[ i ] * sinphi;
+         pz[ i ] = pt[ i ] * SinH( eta[ i ] );
+      }
+
+      return;
+   }
+
+   /**
+    * The output arrays have to be allocated by the caller, and have to be
+    * able to hold (at least) <code>n</code> elements. They must not overlap
+    * with the input arrays. Particles with zero transverse momentum get the
+    * same, large pseudo-rapidity values that SParticle
+    * (ROOT::Math::PtEtaPhiE4D) would give them.
+    *
+    * @param n   The number of particles
+    * @param px  Input array of the X components of the momenta
+    * @param py  Input array of the Y components of the momenta
+    * @param pz  Input array of the Z components of the momenta
+    * @param pt  Output array of transverse momenta
+    * @param eta Output array of pseudo-rapidities
+    * @param phi Output array of azimuthal angles
+    */
+   void ToPtEtaPhi( size_t n, const Double_t* SKINEMATICS_RESTRICT px,
+                    const Double_t* SKINEMATICS_RESTRICT py,
+                    const Double_t* SKINEMATICS_RESTRICT pz,
+                    Double_t* SKINEMATICS_RESTRICT pt,
+                    Double_t* SKINEMATICS_RESTRICT eta,
+                    Double_t* SKINEMATICS_RESTRICT phi ) {
+
+      for( size_t i = 0; i < n; ++i ) {
+         const Double_t rho = std::sqrt( px[ i ] * px[ i ] +
+                                         py[ i ] * py[ i ] );
+         pt[ i ]  = rho;
+         eta[ i ] = EtaFromRhoZ( rho, pz[ i ] );
+         phi[ i ] = ATan2( py[ i ], px[ i ] );
+      }
+
+      return;
+   }
+
+   /**
+    * The output array must not overlap with the input arrays.
+    *
+    * @param n   The number of particles
+    * @param eta Input array of pseudo-rapidities
+    * @param e   Input array of energies
+    * @param et  Output array of transverse energies
+    */
+   void ToEt( size_t n, const Double_t* SKINEMATICS_RESTRICT eta,
+              const Double_t* SKINEMATICS_RESTRICT e,
+              Double_t* SKINEMATICS_RESTRICT et ) {
+
+      for( size_t i = 0; i < n; ++i ) {
+         et[ i ] = e[ i ] / CosH( eta[ i ] );
+      }
+
+      return;
+   }
+
+   /**
+    * @param phi1 Azimuthal angle of the first particle
+    * @param phi2 Azimuthal angle of the second particle
+    * @returns The difference of the angles, in the [-&pi;, &pi;] range
+    */
+   Double_t DeltaPhi( Double_t phi1, Double_t phi2 ) {
+
+      return WrapPhi( phi1 - phi2 );
+   }
+
+   /**
+    * @param eta1 Pseudo-rapidity of the first particle
+    * @param phi1 Azimuthal angle of the first particle
+    * @param eta2 Pseudo-rapidity of the second particle
+    * @param phi2 Azimuthal angle of the second particle
+    * @returns The &Delta;R distance of the two particles
+    */
+   Double_t DeltaR( Double_t eta1, Double_t phi1,
+                    Double_t eta2, Double_t phi2 ) {
+
+      const Double_t deta = eta1 - eta2;
+      const Double_t dphi = WrapPhi( phi1 - phi2 );
+      return std::sqrt( deta * deta + dphi * dphi );
+   }
+
+   /**
+    * The result is stored in a row-major matrix, the distance between
+    * particle <code>i</code> of the first collection and particle
+    * <code>j</code> of the second collection being stored at index
+    * <code>i * coll2.size() + j</code>.
+    *
+    * @param coll1 The first particle collection
+    * @param coll2 The second particle collection
+    * @param result The vector that the distances are written into
+    */
+   void DeltaRMatrix( const SParticleCollection& coll1,
+                      const SParticleCollection& coll2,
+                      std::vector< Double_t >& result ) {
+
+      const size_t n1 = coll1.size();
+      const size_t n2 = coll2.size();
+      result.resize( n1 * n2 );
+      if( ! ( n1 && n2 ) ) return;
+
+      const Double_t* eta2 = &( coll2.GetEta()[ 0 ] );
+      const Double_t* phi2 = &( coll2.GetPhi()[ 0 ] );
+
+      for( size_t i = 0; i < n1; ++i ) {
+         const Double_t eta1 = coll1.Eta( i );
+         const Double_t phi1 = coll1.Phi( i );
+         Double_t* row = &( result[ i * n2 ] );
+         for( size_t j = 0; j < n2; ++j ) {
+            const Double_t deta = eta1 - eta2[ j ];
+            const Double_t dphi = WrapPhi( phi1 - phi2[ j ] );
+            row[ j ] = std::sqrt( deta * deta + dphi * dphi );
+         }
+      }
+
+      return;
+   }
+
+   /**
+    * A particle is flagged as overlapping if it is closer than the specified
+    * &Delta;R distance to any of the particles in the reference collection.
+    * The typical use case is flagging the jets that overlap with electrons.
+    *
+    * @param coll The collection to check
+    * @param ref The reference collection
+    * @param dR The &Delta;R distance below which particles overlap
+    * @param overlaps Flags for each particle of <code>coll</code>
+    * @returns The number of overlapping particles found
+    */
+   size_t FindOverlaps( const SParticleCollection& coll,
+                        const SParticleCollection& ref, Double_t dR,
+                        std::vector< Bool_t >& overlaps ) {
+
+      const size_t n = coll.size();
+      const size_t nref = ref.size();
+      overlaps.assign( n, kFALSE );
+      if( ! ( n && nref ) ) return 0;
+
+      const Double_t* eta2 = &( ref.GetEta()[ 0 ] );
+      const Double_t* phi2 = &( ref.GetPhi()[ 0 ] );
+      const Double_t dR2 = dR * dR;
+
+      size_t result = 0;
+      for( size_t i = 0; i < n; ++i ) {
+         const Double_t eta1 = coll.Eta( i );
+         const Double_t phi1 = coll.Phi( i );
+         // Count the close-by reference particles without branching:
+         size_t close = 0;
+         for( size_t j = 0; j < nref; ++j ) {
+            const Double_t deta = eta1 - eta2[ j ];
+            const Double_t dphi = WrapPhi( phi1 - phi2[ j ] );
+            close += ( ( deta * deta + dphi * dphi ) < dR2 );
+         }
+         if( close ) {
+            overlaps[ i ] = kTRUE;
+            ++result;
+         }
+      }
+
+      return result;
+   }
+
+   /**
+    * @param coll The collection to remove the overlapping particles from
+    * @param ref The reference collection
+    * @param dR The &Delta;R distance below which particles overlap
+    * @returns The number of particles removed from the collection
+    */
+   size_t RemoveOverlaps( SParticleCollection& coll,
+                          const SParticleCollection& ref, Double_t dR ) {
+
+      std::vector< Bool_t > overlaps;
+      const size_t result = FindOverlaps( coll, ref, dR, overlaps );
+      if( ! result ) return 0;
+
+      std::vector< size_t > keep;
+      keep.reserve( coll.size() - result );
+      for( size_t i = 0; i < coll.size(); ++i ) {
+         if( ! overlaps[ i ] ) keep.push_back( i );
+      }
+      Reorder( coll, keep );
+
+      return result;
+   }
+
+   /**
+    * The function follows the convention of ROOT::Math::PtEtaPhiE4D, and
+    * returns a negative number for space-like four-vectors.
+    *
+    * @warning It's not checked if the specified indices are in the correct
+    *          range!
+    *
+    * @param coll The particle collection
+    * @param i Index of the first particle
+    * @param j Index of the second particle
+    * @returns The invariant mass of the two particles
+    */
+   Double_t PairMass( const SParticleCollection& coll, size_t i, size_t j ) {
+
+      const Double_t pti = coll.Pt( i ), ptj = coll.Pt( j );
+      const Double_t px = pti * std::cos( coll.Phi( i ) ) +
+         ptj * std::cos( coll.Phi( j ) );
+      const Double_t py = pti * std::sin( coll.Phi( i ) ) +
+         ptj * std::sin( coll.Phi( j ) );
+      const Double_t pz = pti * std::sinh( coll.Eta( i ) ) +
+         ptj * std::sinh( coll.Eta( j ) );
+      const Double_t e = coll.E( i ) + coll.E( j );
+
+      const Double_t mm = e * e - px * px - py * py - pz * pz;
+      return ( mm >= 0.0 ? std::sqrt( mm ) : -std::sqrt( -mm ) );
+   }
+
+   /**
+    * This is the typical calculation needed to select Z boson candidates
+    * for instance. The cartesian coordinates of the particles are calculated
+    * once, and then all the possible pairs are checked.
+    *
+    * @param coll The particle collection
+    * @param target The invariant mass that the pair should be closest to
+    * @param i If not null, set to the index of the first particle of the pair
+    * @param j If not null, set to the index of the second particle of the pair
+    * @returns The invariant mass of the best pair, or -1 if the collection
+    *          holds less than two particles
+    */
+   Double_t BestPairMass( const SParticleCollection& coll, Double_t target,
+                          size_t* i, size_t* j ) {
+
+      const size_t n = coll.size();
+      if( n < 2 ) return -1.0;
+
+      std::vector< Double_t > px( n ), py( n ), pz( n );
+      ToCartesian( n, &( coll.GetPt()[ 0 ] ), &( coll.GetEta()[ 0 ] ),
+                   &( coll.GetPhi()[ 0 ] ), &px[ 0 ], &py[ 0 ], &pz[ 0 ] );
+      const Double_t* e = &( coll.GetE()[ 0 ] );
+
+      Double_t bestMass = 0.0, bestDiff = -1.0;
+      size_t bestI = 0, bestJ = 1;
+      for( size_t a = 0; a < n - 1; ++a ) {
+         for( size_t b = a + 1; b < n; ++b ) {
+            const Double_t sx = px[ a ] + px[ b ];
+            const Double_t sy = py[ a ] + py[ b ];
+            const Double_t sz = pz[ a ] + pz[ b ];
+            const Double_t se = e[ a ] + e[ b ];
+            const Double_t mm = se * se - sx * sx - sy * sy - sz * sz;
+            const Double_t mass = ( mm >= 0.0 ? std::sqrt( mm ) :
+                                    -std::sqrt( -mm ) );
+            const Double_t diff = std::fabs( mass - target );
+            if( ( bestDiff < 0.0 ) || ( diff < bestDiff ) ) {
+               bestDiff = diff;
+               bestMass = mass;
+               bestI = a;
+               bestJ = b;
+            }
+         }
+      }
+
+      if( i ) *i = bestI;
+      if( j ) *j = bestJ;
+      return bestMass;
+   }
+
+   /**
+    * The comparison is done using the CxxUtils::fpcompare functions, so the
+    * sorting is stable on all platforms.
+    *
+    * @param coll The particle collection
+    * @param order The indices of the particles in decreasing p<sub>T</sub>
+    *              order
+    */
+   void PtOrder( const SParticleCollection& coll,
+                 std::vector< size_t >& order ) {
+
+      Iota( order, coll.size() );
+      std::stable_sort( order.begin(), order.end(),
+                        GreaterValue( coll.GetPt() ) );
+
+      return;
+   }
+
+   /**
+    * @param coll The particle collection
+    * @param order The indices of the particles in increasing |&eta;| order
+    */
+   void AbsEtaOrder( const SParticleCollection& coll,
+                     std::vector< size_t >& order ) {
+
+      const size_t n = coll.size();
+      std::vector< Double_t > abseta( n );
+      for( size_t i = 0; i < n; ++i ) {
+         abseta[ i ] = std::fabs( coll.Eta( i ) );
+      }
+
+      Iota( order, n );
+      std::stable_sort( order.begin(), order.end(), LessValue( abseta ) );
+
+      return;
+   }
+
+   /**
+    * The function can also be used to select a subset of the particles, as
+    * the order doesn't have to include all the indices of the collection.
+    *
+    * @param coll The particle collection to re-order
+    * @param order The indices of the particles in the new order
+    */
+   void Reorder( SParticleCollection& coll,
+                 const std::vector< size_t >& order ) {
+
+      SParticleCollection result;
+      result.reserve( order.size() );
+      std::vector< size_t >::const_iterator itr = order.begin();
+      std::vector< size_t >::const_iterator end = order.end();
+      for( ; itr != end; ++itr ) {
+         if( *itr >= coll.size() ) {
+            SError error( SError::SkipEvent );
+            error << "Index " << *itr << " is out of range for a collection "
+                  << "of " << coll.size() << " particles";
+            throw error;
+         }
+         result.push_back( coll.Pt( *itr ), coll.Eta( *itr ),
+                           coll.Phi( *itr ), coll.E( *itr ) );
+      }
+      coll = result;
+
+      return;
+   }
+
+   /**
+    * @param coll The particle collection to sort
+    */
+   void SortByPt( SParticleCollection& coll ) {
+
+      std::vector< size_t > order;
+      PtOrder( coll, order );
+      Reorder( coll, order );
+
+      return;
+   }
+
+   /**
+    * @param coll The particle collection to sort
+    */
+   void SortByAbsEta( SParticleCollection& coll ) {
+
+      std::vector< size_t > order;
+      AbsEtaOrder( coll, order );
+      Reorder( coll, order );
+
+      return;
+   }
+
+} // namespace SKinematics
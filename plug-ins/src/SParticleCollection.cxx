@@ -0,0 +1,157 @@
+// $Id$
+/***************************************************************************
+ * @Project: SFrame - ROOT-based analysis framework for ATLAS
+ * @Package: Plug-ins
+ *
+ * @author Stefan Ask       <Stefan.Ask@cern.ch>           - Manchester
+ * @author David Berge      <David.Berge@cern.ch>          - CERN
+ * @author Johannes Haller  <Johannes.Haller@cern.ch>      - Hamburg
+ * @author A. Krasznahorkay <Attila.Krasznahorkay@cern.ch> - NYU/Debrecen
+ *
+ ***************************************************************************/
+
+// Local include(s):
+#include "../include/SParticleCollection.h"
+
+/**
+ * The default constructor creates an empty collection. Default constructors
+ * are needed to be able to read/write objects with ROOT.
+ */
+SParticleCollection::SParticleCollection()
+   : m_pt(), m_eta(), m_phi(), m_e() {
+
+}
+
+/**
+ * @returns The number of particles in the collection
+ */
+size_t SParticleCollection::size() const {
+
+   return m_pt.size();
+}
+
+/**
+ * @returns <code>true</code> if there are no particles in the collection,
+ *          <code>false</code> otherwise
+ */
+bool SParticleCollection::empty() const {
+
+   return m_pt.empty();
+}
+
+/**
+ * Just like with std::vector< SParticle >, the user has to clear the
+ * collection by hand at the beginning of each event.
+ */
+void SParticleCollection::clear() {
+
+   m_pt.clear();
+   m_eta.clear();
+   m_phi.clear();
+   m_e.clear();
+
+   return;
+}
+
+/**
+ * @param n The number of particles to reserve memory for
+ */
+void SParticleCollection::reserve( size_t n ) {
+
+   m_pt.reserve( n );
+   m_eta.reserve( n );
+   m_phi.reserve( n );
+   m_e.reserve( n );
+
+   return;
+}
+
+/**
+ * @param pt  p<sub>T</sub> of the particle
+ * @param eta pseudo-rapidity of the particle
+ * @param phi azimuthal angle of the particle
+ * @param e   energy of the particle
+ */
+void SParticleCollection::push_back( Double_t pt, Double_t eta, Double_t phi,
+                                     Double_t e ) {
+
+   m_pt.push_back( pt );
+   m_eta.push_back( eta );
+   m_phi.push_back( phi );
+   m_e.push_back( e );
+
+   return;
+}
+
+/**
+ * @param p The particle to add to the collection
+ */
+void SParticleCollection::push_back( const SParticle& p ) {
+
+   push_back( p.Pt(), p.Eta(), p.Phi(), p.E() );
+   return;
+}
+
+/**
+ * @warning It's not checked if the specified index is in the correct range!
+ *
+ * @param i The index of the particle
+ * @returns A proxy pointing to the requested particle
+ */
+SParticleCollection::Proxy SParticleCollection::operator[]( size_t i ) {
+
+   return Proxy( *this, i );
+}
+
+/**
+ * @warning It's not checked if the specified index is in the correct range!
+ *
+ * @param i The index of the particle
+ * @returns A constant proxy pointing to the requested particle
+ */
+SParticleCollection::ConstProxy
+SParticleCollection::operator[]( size_t i ) const {
+
+   return ConstProxy( *this, i );
+}
+
+/**
+ * @returns The transverse momenta of all the particles
+ */
+const std::vector< Double32_t >& SParticleCollection::GetPt() const {
+
+   return m_pt;
+}
+
+/**
+ * @returns The pseudo-rapidities of all the particles
+ */
+const std::vector< Double32_t >& SParticleCollection::GetEta() const {
+
+   return m_eta;
+}
+
+/**
+ * @returns The azimuthal angles of all the particles
+ */
+const std::vector< Double32_t >& SParticleCollection::GetPhi() const {
+
+   return m_phi;
+}
+
+/**
+ * @returns The energies of all the particles
+ */
+const std::vector< Double32_t >& SParticleCollection::GetE() const {
+
+   return m_e;
+}
+
+/**
+ * @param i The index of the particle
+ * @returns A standalone copy of the requested particle
+ */
+SParticle SParticleCollection::GetParticle( size_t i ) const {
+
+   return SParticle( m_pt[ i ], m_eta[ i ], m_phi[ i ], m_e[ i ] );
+}
@@ -20,8 +20,10 @@
 
 // Local include(s):
 #include "core/include/SCycleBase.h"
-#include "plug-ins/include/SParticle.h"
+#include "plug-ins/include/SParticleCollection.h"
 #include "plug-ins/include/SSummedVar.h"
+#include "plug-ins/include/SSummedArray.h"
+#include "plug-ins/include/SCutFlow.h"
 
 /**
  * Example cycle reading a SusyView ntuple and writing out an
@@ -79,9 +81,9 @@ private:
    //
    // The output variables
    //
-   int                      m_o_example_variable;
-   std::vector< double >    m_o_El_p_T;
-   std::vector< SParticle > m_o_El;
+   int                   m_o_example_variable;
+   std::vector< double > m_o_El_p_T;
+   SParticleCollection   m_o_El;
 
    //
    // Metadata tree with separate entries for each electron:
@@ -97,7 +99,14 @@ private:
    //
    SSummedVar< Int_t > m_allEvents; //!
    SSummedVar< Int_t > m_passedEvents; //!
-   SSummedVar< std::vector< Int_t > > m_test; //!
+   SSummedArray< Int_t > m_test; //!
+
+   //
+   // The cutflow of the cycle:
+   //
+   SCutFlow* m_cutFlow; //!
+   Int_t m_allCut; //!
+   Int_t m_electronCut; //!
 
    ClassDef( FirstCycle , 0 );
 
@@ -20,7 +20,7 @@
 
 // Local include(s):
 #include "core/include/SCycleBase.h"
-#include "plug-ins/include/SParticle.h"
+#include "plug-ins/include/SParticleCollection.h"
 
 /**
  * Example cycle reading the ntuple created by FirstCycle and producing
@@ -49,7 +49,7 @@ private:
    //
    int                       m_example_variable;
    std::vector< double >*    m_El_p_T;
-   std::vector< SParticle >* m_El;
+   SParticleCollection*      m_El;
 
    ClassDef( SecondCycle , 0 );
 
@@ -22,7 +22,8 @@ ClassImp( FirstCycle );
 FirstCycle::FirstCycle()
    : m_El_p_T( 0 ), m_El_eta( 0 ), m_El_phi( 0 ), m_El_E( 0 ),
      m_allEvents( "allEvents", this ), m_passedEvents( "passedEvents", this ),
-     m_test( "test", this ) {
+     m_test( "test", 2, this ), m_cutFlow( 0 ), m_allCut( 0 ),
+     m_electronCut( 0 ) {
 
    // To have the correct name in the log:
    SetLogName( this->GetName() );
@@ -143,8 +144,12 @@ void FirstCycle::BeginInputData( const SInputData& ) {
    Book( TH1F( "El_p_T_hist", "Electron p_{T}, merged 'in memory'", 100, 0.0,
                150000.0 ) );
 
-   // Reserve two entries in the vector:
-   m_test->resize( 2, 0 );
+   //
+   // Declare the cutflow, with CPU time measurement turned on:
+   //
+   m_cutFlow = Book( SCutFlow( "cutflow", "Event selection", kTRUE ) );
+   m_allCut      = m_cutFlow->Register( "all" );
+   m_electronCut = m_cutFlow->Register( "electron" );
 
    return;
 }
@@ -169,10 +174,10 @@ void FirstCycle::BeginMasterInputData( const SInputData& ) {
 void FirstCycle::EndMasterInputData( const SInputData& ) {
 
    m_logger << INFO << "Number of all processed events: "
-            << *m_allEvents << " " << ( m_test->size() > 0 ? ( *m_test )[ 0 ] : 0 )
+            << *m_allEvents << " " << m_test[ 0 ]
             << SLogger::endmsg;
    m_logger << INFO << "Number of events passing selection: "
-            << *m_passedEvents << " " << ( m_test->size() > 1 ? ( *m_test )[ 1 ] : 0 )
+            << *m_passedEvents << " " << m_test[ 1 ]
             << SLogger::endmsg;
 
    return;
@@ -188,6 +193,9 @@ void FirstCycle::ExecuteEvent( const SInputData&, Double_t weight ) {
    m_o_El_p_T.clear();
    m_o_El.clear();
 
+   // Start the cutflow bookkeeping of the event:
+   m_cutFlow->BeginEvent();
+
    // Fill the most simple output variable:
    m_o_example_variable = 1;
 
@@ -201,11 +209,9 @@ void FirstCycle::ExecuteEvent( const SInputData&, Double_t weight ) {
       Hist( "El_p_T_hist" )->Fill( ( *m_El_p_T )[ i ], weight );
       Hist( "El_p_T_hist_file" )->Fill( ( *m_El_p_T )[ i ], weight );
 
-      // Fill a vector of objects:
-      m_o_El.push_back( SParticle( ( * m_El_p_T )[ i ],
-                                   ( * m_El_eta )[ i ],
-                                   ( * m_El_phi )[ i ],
-                                   ( * m_El_E )[ i ] ) );
+      // Fill a collection of particles:
+      m_o_El.push_back( ( * m_El_p_T )[ i ], ( * m_El_eta )[ i ],
+                        ( * m_El_phi )[ i ], ( * m_El_E )[ i ] );
 
       // Fill the metadata tree. The user has to call TTree::Fill() by hand.
       m_meta_El_p_T = ( * m_El_p_T )[ i ];
@@ -224,16 +230,19 @@ void FirstCycle::ExecuteEvent( const SInputData&, Double_t weight ) {
 
    // Count the total number of processed events:
    ++m_allEvents;
-   ( *m_test )[ 0 ]++;
+   ++m_test[ 0 ];
+   m_cutFlow->Pass( m_allCut, weight );
 
    // Perform event selection. If you don't want to write out
    // an event, you have to throw an exception anywhere in the ExecuteEvent
    // method (or in a method called by ExecuteEvent) like this:
-   if( ! m_El_N ) throw SError( SError::SkipEvent );
+   if( ! m_cutFlow->Apply( m_electronCut, m_El_N > 0, weight ) ) {
+      throw SError( SError::SkipEvent );
+   }
 
    // Count the number of events that passed the selection:
    ++m_passedEvents;
-   ( *m_test )[ 1 ]++;
+   ++m_test[ 1 ];
 
    // Fill validation histograms.
    // For adding more ValHistsTypes, edit the header File for this Cycle.
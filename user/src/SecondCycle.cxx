@@ -91,15 +91,16 @@ void SecondCycle::ExecuteEvent( const SInputData&,
             0, kTRUE )->Fill( *it, weight );
    }
 
-   // Loop over the electron objects:
-   for( std::vector< SParticle >::const_iterator el = m_El->begin();
-        el != m_El->end(); ++el ) {
-      Book( TH1F( "El_p_T", "Electron p_{T}", 100, 0.0, 150000.0 ),
-            "obj_test" )->Fill( el->Pt(), weight );
-      Book( TH1F( "El_eta", "Electron #eta", 100, -3.5, 3.5 ),
-            "obj_test" )->Fill( el->Eta(), weight );
-      Book( TH1F( "El_phi", "Electron #phi", 100, -3.141592, 3.141592 ),
-            "obj_test" )->Fill( el->Phi(), weight );
+   // Loop over the electron objects. BOOK_CACHED only constructs the
+   // temporary histograms the first time that it's called.
+   for( size_t i = 0; i < m_El->size(); ++i ) {
+      SParticleCollection::Proxy el = ( *m_El )[ i ];
+      BOOK_CACHED( TH1F( "El_p_T", "Electron p_{T}", 100, 0.0, 150000.0 ),
+                   "obj_test" )->Fill( el.Pt(), weight );
+      BOOK_CACHED( TH1F( "El_eta", "Electron #eta", 100, -3.5, 3.5 ),
+                   "obj_test" )->Fill( el.Eta(), weight );
+      BOOK_CACHED( TH1F( "El_phi", "Electron #phi", 100, -3.141592, 3.141592 ),
+                   "obj_test" )->Fill( el.Phi(), weight );
    }
 
    return;